@@ -23,13 +23,19 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <algorithm>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include <denali/contour_tree.h>
 #include <denali/fileio.h>
+#include <denali/folded.h>
+#include <denali/graph_algorithms.h>
+#include <denali/simplify.h>
 
 // the following two functions are pasted from a stack overflow post
 // see: http://stackoverflow.com/questions/865668/parse-command-line-arguments
@@ -49,11 +55,245 @@ bool cmdOptionExists(char** begin, char** end, const std::string& option)
     return std::find(begin, end, option) != end;
 }
 
+typedef denali::ScalarSimplicialComplex Complex;
+typedef denali::ConnectedComponents<Complex> Components;
+
+
+// orders components by decreasing size
+struct ComponentSizeGreater
+{
+    const Components& components;
+
+    ComponentSizeGreater(const Components& components)
+        : components(components) {}
+
+    bool operator()(denali::Identifier x, denali::Identifier y) const
+    {
+        return components.getComponentSize(x) > components.getComponentSize(y);
+    }
+};
+
+
+// prints the number and sizes of the components, largest first
+void reportComponents(const Components& components, std::ostream& os)
+{
+    const size_t max_listed = 10;
+
+    std::vector<denali::Identifier> order(components.numberOfComponents());
+    for (size_t i=0; i<order.size(); ++i)
+    {
+        order[i] = i;
+    }
+
+    std::stable_sort(order.begin(), order.end(),
+            ComponentSizeGreater(components));
+
+    os << "The input graph has " << components.numberOfComponents()
+       << " connected components:" << std::endl;
+
+    for (size_t i=0; i<order.size() && i<max_listed; ++i)
+    {
+        os << "\tcomponent " << order[i] << ": "
+           << components.getComponentSize(order[i]) << " vertices" << std::endl;
+    }
+
+    if (order.size() > max_listed)
+    {
+        os << "\t... and " << order.size() - max_listed
+           << " more, each with at most "
+           << components.getComponentSize(order[max_listed])
+           << " vertices" << std::endl;
+    }
+}
+
+
+// computes the contour tree of a single component of the complex. the vertex
+// ids of the resulting tree are the ids of the vertices in the full complex
+denali::ContourTree computeComponentTree(
+        const Complex& plex,
+        const std::vector<denali::Identifier>& vertices,
+        const std::vector<denali::Identifier>& local_index)
+{
+    typedef denali::UndirectedScalarMemberIDGraph Graph;
+    typedef denali::UndirectedNeighborIterator<Complex> NeighborIterator;
+
+    // copy the component into a complex of its own, with ids 0, ..., k-1
+    Complex subplex;
+    for (size_t i=0; i<vertices.size(); ++i)
+    {
+        subplex.addNode(plex.getValue(plex.getNode(vertices[i])));
+    }
+
+    for (size_t i=0; i<vertices.size(); ++i)
+    {
+        for (NeighborIterator it(plex, plex.getNode(vertices[i]));
+                !it.done(); ++it)
+        {
+            denali::Identifier neighbor = plex.getID(it.neighbor());
+            if (vertices[i] < neighbor)
+            {
+                subplex.addEdge(subplex.getNode(i),
+                                subplex.getNode(local_index[neighbor]));
+            }
+        }
+    }
+
+    denali::CarrsAlgorithm carrs_algorithm;
+    denali::ContourTree local_tree =
+        denali::ContourTree::compute(subplex, carrs_algorithm);
+
+    // translate the tree back to the ids of the full complex
+    boost::shared_ptr<Graph> graph(new Graph);
+
+    for (denali::NodeIterator<denali::ContourTree> it(local_tree);
+            !it.done(); ++it)
+    {
+        graph->addNode(vertices[local_tree.getID(it.node())],
+                       local_tree.getValue(it.node()));
+    }
+
+    for (denali::EdgeIterator<denali::ContourTree> it(local_tree);
+            !it.done(); ++it)
+    {
+        Graph::Edge edge = graph->addEdge(
+                graph->getNode(vertices[local_tree.getID(local_tree.u(it.edge()))]),
+                graph->getNode(vertices[local_tree.getID(local_tree.v(it.edge()))]));
+
+        const denali::ContourTree::Members& members =
+                local_tree.getEdgeMembers(it.edge());
+
+        for (denali::ContourTree::Members::const_iterator m_it = members.begin();
+                m_it != members.end(); ++m_it)
+        {
+            graph->insertEdgeMember(edge,
+                    Graph::Member(vertices[m_it->getID()], m_it->getValue()));
+        }
+    }
+
+    return denali::ContourTree::fromPrecomputed(graph);
+}
+
+
+// computes and writes one contour tree per component, in parallel. the tree
+// of component k is written to <tree file>.k
+void writeComponentTrees(
+        const Complex& plex,
+        const Components& components,
+        const std::string& tree_file)
+{
+    size_t n_components = components.numberOfComponents();
+
+    // group the vertices by component
+    std::vector< std::vector<denali::Identifier> > vertices(n_components);
+    std::vector<denali::Identifier> local_index(plex.numberOfNodes());
+
+    for (size_t i=0; i<plex.numberOfNodes(); ++i)
+    {
+        std::vector<denali::Identifier>& component =
+                vertices[components.getComponent(plex.getNode(i))];
+        local_index[i] = component.size();
+        component.push_back(i);
+    }
+
+    // exceptions cannot leave a parallel region, so the first is kept and
+    // rethrown once all of the components have been processed
+    std::string error;
+
+    #pragma omp parallel for schedule(dynamic)
+    for (long k=0; k<(long) n_components; ++k)
+    {
+        try {
+            denali::ContourTree tree =
+                computeComponentTree(plex, vertices[k], local_index);
+
+            std::stringstream filename;
+            filename << tree_file << "." << k;
+            denali::writeContourTreeFile(filename.str().c_str(), tree);
+        }
+        catch (std::exception& e) {
+            #pragma omp critical (ctree_component_error)
+            if (error.empty()) {
+                error = e.what();
+            }
+        }
+    }
+
+    if (!error.empty())
+    {
+        throw std::runtime_error(error);
+    }
+}
+
+
+// parses a comma-separated list of nonnegative persistence thresholds
+void parseThresholds(
+        const std::string& list,
+        std::vector<std::string>& names,
+        std::vector<double>& thresholds)
+{
+    std::stringstream stream(list);
+    std::string name;
+
+    while (std::getline(stream, name, ','))
+    {
+        char* end;
+        double threshold = strtod(name.c_str(), &end);
+
+        if (name.empty() || *end != 0 || threshold < 0)
+        {
+            throw std::runtime_error(
+                "Could not interpret '" + name + "' as a persistence "
+                "threshold. Thresholds must be nonnegative numbers.");
+        }
+
+        names.push_back(name);
+        thresholds.push_back(threshold);
+    }
+
+    if (thresholds.empty()) {
+        throw std::runtime_error("No persistence thresholds were given.");
+    }
+}
+
+
+// writes the tree simplified at each threshold to <tree file>.<threshold>
+struct SimplifiedTreeWriter
+{
+    const std::string& tree_file;
+    const std::vector<std::string>& names;
+
+    SimplifiedTreeWriter(
+            const std::string& tree_file,
+            const std::vector<std::string>& names)
+        : tree_file(tree_file), names(names) {}
+
+    template <typename FoldedTree>
+    void operator()(const FoldedTree& tree, size_t i, double)
+    {
+        std::string filename = tree_file + "." + names[i];
+        denali::writeContourTreeFile(filename.c_str(), tree);
+    }
+};
+
+
+void writeSimplifiedTrees(
+        const denali::ContourTree& contour_tree,
+        const std::string& tree_file,
+        const std::vector<std::string>& names,
+        const std::vector<double>& thresholds)
+{
+    denali::FoldedContourTree<denali::ContourTree> folded_tree(contour_tree);
+    SimplifiedTreeWriter writer(tree_file, names);
+    denali::simplifyAtEachThreshold(folded_tree, thresholds, writer);
+}
+
+
 int main(int argc, char ** argv) try
 {
     std::string usage =
         "usage: ctree <vertex value file> <edge file> <tree file>\n"
         "             [--join <filename>] [--split <filename>]\n"
+        "             [--per-component] [--simplify <t1,t2,...>]\n"
         "\n"
         "Given the 1-skeleton of a simplicial complex in the form of a list of\n"
         "vertex values and a list of edges, prints the edges of the contour\n"
@@ -79,7 +319,24 @@ int main(int argc, char ** argv) try
         "\tAlso output the join tree to the specified file.\n"
         "\n"
         "--split <filename>\n"
-        "\tAlso output the split tree to the specified file.\n";
+        "\tAlso output the split tree to the specified file.\n"
+        "\n"
+        "--per-component\n"
+        "\tIf the input graph is not connected, compute a separate contour\n"
+        "\ttree for each connected component, in parallel. The tree of the\n"
+        "\tk-th component is written to <tree file>.k, where components are\n"
+        "\tnumbered in order of their smallest vertex index. Vertex indices\n"
+        "\tin the output refer to the full input. A connected input has one\n"
+        "\ttree, which is written to <tree file> as usual. Cannot be combined\n"
+        "\twith --join, --split or --simplify.\n"
+        "\n"
+        "--simplify <t1,t2,...>\n"
+        "\tAlso write the tree simplified by persistence at each of the\n"
+        "\tcomma-separated thresholds. The tree simplified at threshold t is\n"
+        "\twritten to <tree file>.t, with t as given on the command line.\n"
+        "\tThe simplification is computed once for all of the thresholds.\n"
+        "\tVertices folded into the nodes of a simplified tree are not\n"
+        "\twritten, as the tree file format only has edge members.\n";
 
     if (cmdOptionExists(argv, argv + argc, "-h") ||
             cmdOptionExists(argv, argv + argc, "--help")) {
@@ -95,19 +352,49 @@ int main(int argc, char ** argv) try
 
     char* join_file = getCmdOption(argv, argv + argc, "--join");
     char* split_file = getCmdOption(argv, argv + argc, "--split");
+    bool per_component = cmdOptionExists(argv, argv + argc, "--per-component");
+    char* simplify_list = getCmdOption(argv, argv + argc, "--simplify");
+
+    if (per_component && (join_file || split_file || simplify_list)) {
+        std::cerr << "--per-component cannot be combined with --join, --split "
+                  << "or --simplify." << std::endl;
+        return 1;
+    }
 
     try {
+        // check the thresholds before doing any work
+        std::vector<std::string> threshold_names;
+        std::vector<double> thresholds;
+        if (simplify_list)
+        {
+            parseThresholds(simplify_list, threshold_names, thresholds);
+        }
+
         // create a simplicial complex
         denali::ScalarSimplicialComplex plex;
 
-        // read the vertices and edges into it
+        // read the vertices and edges into it. the connected components are
+        // found while the edges are read
+        denali::ConcurrentDisjointSets sets;
         denali::readSimplicialVertexFile(argv[1], plex);
-        denali::readSimplicialEdgeFile(argv[2], plex);
+        denali::readSimplicialEdgeFile(argv[2], plex, sets);
+
+        Components components(plex, sets);
+
+        // a connected input has a single tree, written as usual
+        if (per_component && !components.isConnected())
+        {
+            writeComponentTrees(plex, components, argv[3]);
+            return 0;
+        }
 
         // check that the input graph is connected
-        if (!denali::isConnected(plex))
+        if (!components.isConnected())
         {
             std::cerr << "Error: The input graph is not connected." << std::endl;
+            reportComponents(components, std::cerr);
+            std::cerr << "Use --per-component to compute a contour tree for "
+                      << "each component." << std::endl;
             return 1;
         }
 
@@ -138,6 +425,12 @@ int main(int argc, char ** argv) try
 
         // write it to disk
         denali::writeContourTreeFile(argv[3], contour_tree);
+
+        if (simplify_list)
+        {
+            writeSimplifiedTrees(contour_tree, argv[3], threshold_names,
+                                 thresholds);
+        }
     }
     catch (std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
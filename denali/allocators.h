@@ -0,0 +1,283 @@
+// Copyright (c) 2014, Justin Eldridge, Mikhail Belkin, and Yusu Wang
+// at The Ohio State University. All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef DENALI_ALLOCATORS_H
+#define DENALI_ALLOCATORS_H
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#if __cplusplus >= 201103L
+#include <type_traits>
+#endif
+
+/// \file
+/// \brief Allocators for graph storage.
+
+namespace denali {
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// MonotonicArena
+//
+////////////////////////////////////////////////////////////////////////////////
+
+/// \brief A region of memory which is only ever released as a whole.
+/// \ingroup allocators
+/*!
+ *  Allocations are carved sequentially out of large blocks. Individual
+ *  deallocations are ignored, and every block is freed when the arena is
+ *  destroyed. This suits structures which are built once and then only
+ *  read, such as a freshly computed contour tree: construction performs no
+ *  per-object heap allocations, and teardown frees a handful of blocks.
+ *
+ *  Memory released by a container, for instance when a vector grows, is not
+ *  reused until the arena is destroyed.
+ */
+class MonotonicArena : private boost::noncopyable
+{
+    std::vector<char*> _blocks;
+    char* _position;
+    size_t _remaining;
+    size_t _next_block_size;
+    size_t _bytes_allocated;
+    size_t _bytes_reserved;
+
+    // every allocation is aligned to this boundary
+    static const size_t ALIGNMENT = 2 * sizeof(void*);
+
+public:
+    /// \brief Creates an empty arena.
+    /*!
+     *  \param  block_size  The size of the first block. Each subsequent block
+     *                      is twice as large as the last.
+     */
+    explicit MonotonicArena(size_t block_size = 64 * 1024)
+        : _position(0), _remaining(0), _next_block_size(block_size),
+          _bytes_allocated(0), _bytes_reserved(0) {}
+
+    ~MonotonicArena()
+    {
+        for (size_t i = 0; i < _blocks.size(); ++i)
+        {
+            ::operator delete(_blocks[i]);
+        }
+    }
+
+    /// \brief Allocates the given number of bytes.
+    void* allocate(size_t bytes)
+    {
+        bytes = (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+        if (bytes > _remaining)
+        {
+            addBlock(bytes);
+        }
+
+        void* memory = _position;
+        _position += bytes;
+        _remaining -= bytes;
+        _bytes_allocated += bytes;
+        return memory;
+    }
+
+    /// \brief The number of bytes handed out by the arena.
+    size_t bytesAllocated() const
+    {
+        return _bytes_allocated;
+    }
+
+    /// \brief The number of bytes obtained from the system.
+    size_t bytesReserved() const
+    {
+        return _bytes_reserved;
+    }
+
+private:
+    void addBlock(size_t bytes)
+    {
+        size_t block_size = _next_block_size;
+        while (block_size < bytes)
+        {
+            block_size *= 2;
+        }
+
+        char* block = static_cast<char*>(::operator new(block_size));
+        _blocks.push_back(block);
+
+        _position = block;
+        _remaining = block_size;
+        _next_block_size = 2 * block_size;
+        _bytes_reserved += block_size;
+    }
+
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// ArenaAllocator
+//
+////////////////////////////////////////////////////////////////////////////////
+
+/// \brief A standard allocator which draws from a MonotonicArena.
+/// \ingroup allocators
+/*!
+ *  A default constructed ArenaAllocator is not attached to an arena, and
+ *  allocates from the heap like std::allocator. This allows a single
+ *  container type to be used both for ordinary, long lived structures and
+ *  for structures built in an arena.
+ *
+ *  Containers propagate the allocator on copy, assignment and swap, so that
+ *  the elements of a structure built in an arena stay in the arena.
+ */
+template <typename T>
+class ArenaAllocator
+{
+    template <typename U> friend class ArenaAllocator;
+
+    MonotonicArena* _arena;
+
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+#if __cplusplus >= 201103L
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+#endif
+
+    template <typename U>
+    struct rebind
+    {
+        typedef ArenaAllocator<U> other;
+    };
+
+    ArenaAllocator() : _arena(0) {}
+
+    explicit ArenaAllocator(MonotonicArena* arena) : _arena(arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : _arena(other._arena) {}
+
+    /// \brief The arena, or null if allocating from the heap.
+    MonotonicArena* getArena() const
+    {
+        return _arena;
+    }
+
+    pointer allocate(size_type n, const void* = 0)
+    {
+        if (_arena)
+        {
+            return static_cast<pointer>(_arena->allocate(n * sizeof(T)));
+        }
+        return static_cast<pointer>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(pointer p, size_type)
+    {
+        if (!_arena)
+        {
+            ::operator delete(p);
+        }
+    }
+
+    size_type max_size() const
+    {
+        return std::numeric_limits<size_type>::max() / sizeof(T);
+    }
+
+    void construct(pointer p, const T& value)
+    {
+        new (static_cast<void*>(p)) T(value);
+    }
+
+    void destroy(pointer p)
+    {
+        p->~T();
+    }
+
+    pointer address(reference x) const
+    {
+        return &x;
+    }
+
+    const_pointer address(const_reference x) const
+    {
+        return &x;
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const
+    {
+        return _arena == other._arena;
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const
+    {
+        return _arena != other._arena;
+    }
+
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// ArenaHolder
+//
+////////////////////////////////////////////////////////////////////////////////
+
+/// \brief Keeps an arena alive.
+/// \ingroup allocators
+/*!
+ *  A structure whose storage lives in an arena inherits from ArenaHolder
+ *  before any other base class. Bases are destroyed in the reverse order of
+ *  their construction, so the arena outlives every container built in it.
+ */
+struct ArenaHolder
+{
+    boost::shared_ptr<MonotonicArena> _arena;
+
+    ArenaHolder() {}
+
+    explicit ArenaHolder(boost::shared_ptr<MonotonicArena> arena)
+        : _arena(arena) {}
+};
+
+}
+
+#endif
@@ -67,12 +67,12 @@ public:
     }
 
     /// \brief Retrieve the node associated with the index.
-    Node getNode(unsigned int index) const {
+    Node getNode(Identifier index) const {
         return Node();
     }
 
     /// \brief Get the ID of a node.
-    unsigned int getID(Node node) const {
+    Identifier getID(Node node) const {
         return 0;
     }
 
@@ -95,7 +95,7 @@ public:
             _Edge edge = _plex.addEdge(_Node(), _Node());
             double value = _plex.getValue(_Node());
             node = _plex.getNode(0);
-            unsigned int id = _plex.getID(_Node());
+            Identifier id = _plex.getID(_Node());
 
             ignore_unused_variable_warning(edge);
             ignore_unused_variable_warning(id);
@@ -113,9 +113,9 @@ class Member
 {
 public:
 
-    Member(unsigned int, double) {}
+    Member(Identifier, double) {}
 
-    unsigned int getID() const {
+    Identifier getID() const {
         return 0;
     }
 
@@ -129,7 +129,7 @@ public:
     {
         void constraints()
         {
-            unsigned int id = _m.getID();
+            Identifier id = _m.getID();
             double v = _m.getValue();
 
             ignore_unused_variable_warning(id);
@@ -161,7 +161,7 @@ public:
     }
 
     /// Insert a member into the set.
-    void insert(unsigned int) { }
+    void insert(Identifier) { }
 
     template <typename _Members>
     struct Constraints
@@ -220,7 +220,7 @@ public:
     }
 
     /// \brief Get a node's ID
-    unsigned int getID(Node node) {
+    Identifier getID(Node node) {
         return 0;
     }
 
@@ -231,7 +231,7 @@ public:
 
     /// \brief Retrieve a node by its ID. If there is no node with such an ID,
     //      an invalid node is returned.
-    Node getNode(unsigned int id) const {
+    Node getNode(Identifier id) const {
         return Node();
     }
 
@@ -253,7 +253,7 @@ public:
             > ();
 
             double value = _tree.getValue(_Node());
-            unsigned int id = _tree.getID(_Node());
+            Identifier id = _tree.getID(_Node());
             const _Members& node_members = _tree.getNodeMembers(_Node());
             _Node node = _tree.getNode(id);
             const _Members& edge_members = _tree.getEdgeMembers(_Edge());
@@ -306,7 +306,7 @@ public:
      *  \param  id      The id of the node.
      *  \param  value   The scalar value of the node.
      */
-    Node addNode(unsigned int id, double value) {
+    Node addNode(Identifier id, double value) {
         return Node();
     }
 
@@ -339,7 +339,7 @@ public:
     }
 
     /// \brief Get a node's ID
-    unsigned int getID(Node node) const {
+    Identifier getID(Node node) const {
         return 0;
     }
 
@@ -349,7 +349,7 @@ public:
     }
 
     /// \brief Retrieve a node by its ID
-    Node getNode(unsigned int id) const {
+    Node getNode(Identifier id) const {
         return Node();
     }
 
@@ -380,7 +380,7 @@ public:
             _graph.insertEdgeMembers(_Edge(), members);
 
             double value = _graph.getValue(_Node());
-            unsigned int id = _graph.getID(_Node());
+            Identifier id = _graph.getID(_Node());
             const _Members& node_members = _graph.getNodeMembers(_Node());
             node = _graph.getNode(id);
             const _Members& edge_members = _graph.getEdgeMembers(_Edge());
@@ -458,7 +458,7 @@ class RandomAccessComparisonFunctor
 {
 public:
     RandomAccessComparisonFunctor(const RandomAccessContainer& values) { }
-    bool operator()(unsigned int u, unsigned int v) {
+    bool operator()(Identifier u, Identifier v) {
         return true;
     }
 
@@ -491,12 +491,12 @@ class TotalOrder
 public:
 
     /// \brief Retrieve the position of the element in the ordering.
-    unsigned int positionToElement(unsigned int index) const {
+    Identifier positionToElement(Identifier index) const {
         return 0;
     }
 
     /// \brief Retrieve the element at this position in the ordering.
-    unsigned int elementToPosition(unsigned int index) const {
+    Identifier elementToPosition(Identifier index) const {
         return 0;
     }
 
@@ -515,7 +515,7 @@ public:
     {
         void constraints()
         {
-            unsigned int x = _total_order.positionToElement(0);
+            Identifier x = _total_order.positionToElement(0);
             x = _total_order.elementToPosition(0);
             _TotalOrder tot = _TotalOrder::compute(_values, _functor);
             size_t sz = _total_order.size();
@@ -26,6 +26,7 @@
 #define DENALI_GRAPH_ATTRIBUTES_H
 
 #include <denali/concepts/graph_objects.h>
+#include <denali/identifiers.h>
 
 namespace denali {
 namespace concepts {
@@ -397,16 +398,16 @@ public:
     typedef concepts::Node Node;
 
     /// \brief Gets the maximum node identifier in the graph.
-    unsigned int getMaxNodeIdentifier() const {
+    Identifier getMaxNodeIdentifier() const {
         return 0;
     }
 
     /// \brief Get the identifier of the node.
-    unsigned int getNodeIdentifier(Node) const {
+    Identifier getNodeIdentifier(Node) const {
         return 0;
     }
 
-    Node getNodeFromIdentifier(unsigned int) const {
+    Node getNodeFromIdentifier(Identifier) const {
         return Node();
     }
 
@@ -417,7 +418,7 @@ public:
         {
             checkConcept<concepts::Node, _Node>();
 
-            unsigned int n = graph.getMaxNodeIdentifier();
+            Identifier n = graph.getMaxNodeIdentifier();
             n = graph.getNodeIdentifier(_Node());
 
             _Node node = graph.getNodeFromIdentifier(0);
@@ -445,17 +446,17 @@ public:
     typedef concepts::Arc Arc;
 
     /// \brief Gets the maximum arc identifier in the graph.
-    unsigned int getMaxArcIdentifier() const {
+    Identifier getMaxArcIdentifier() const {
         return 0;
     }
 
     /// \brief Get the identifier of the arc.
-    unsigned int getArcIdentifier(Arc) const {
+    Identifier getArcIdentifier(Arc) const {
         return 0;
     }
 
     /// \brief Get an arc from an identifier.
-    Arc getArcFromIdentifier(unsigned int identifier) const {
+    Arc getArcFromIdentifier(Identifier identifier) const {
         return Arc();
     }
 
@@ -466,7 +467,7 @@ public:
         {
             checkConcept<concepts::Arc, _Arc>();
 
-            unsigned int n = graph.getMaxArcIdentifier();
+            Identifier n = graph.getMaxArcIdentifier();
             n = graph.getArcIdentifier(_Arc());
             _Arc arc = graph.getArcFromIdentifier(0);
 
@@ -493,17 +494,17 @@ public:
     typedef concepts::Edge Edge;
 
     /// \brief Gets the maximum edge identifier in the graph.
-    unsigned int getMaxEdgeIdentifier() const {
+    Identifier getMaxEdgeIdentifier() const {
         return 0;
     }
 
     /// \brief Get the identifier of the edge.
-    unsigned int getEdgeIdentifier(Edge) const {
+    Identifier getEdgeIdentifier(Edge) const {
         return 0;
     }
 
     /// \brief Get an edge from an identifier.
-    Edge getEdgeFromIdentifier(unsigned int identifier) const {
+    Edge getEdgeFromIdentifier(Identifier identifier) const {
         return Edge();
     }
 
@@ -514,7 +515,7 @@ public:
         {
             checkConcept<concepts::Edge, _Edge>();
 
-            unsigned int n = graph.getMaxEdgeIdentifier();
+            Identifier n = graph.getMaxEdgeIdentifier();
             n = graph.getEdgeIdentifier(_Edge());
             _Edge edge = graph.getEdgeFromIdentifier(0);
 
@@ -717,29 +718,29 @@ public:
 
     /// \brief Get the degree of the node.
     /// \pre The node must be valid.
-    unsigned int degree(Node) const {
+    Identifier degree(Node) const {
         return 0;
     }
 
     /// \brief Get the in degree of the node.
     /// \pre The node must be valid.
-    unsigned int inDegree(Node) const {
+    Identifier inDegree(Node) const {
         return 0;
     }
 
     /// \brief Get the out degree of the node.
     /// \pre The node must be valid.
-    unsigned int outDegree(Node) const {
+    Identifier outDegree(Node) const {
         return 0;
     }
 
     /// \brief The number of nodes in the graph
-    unsigned int numberOfNodes() const {
+    Identifier numberOfNodes() const {
         return 0;
     }
 
     /// \brief The number of arcs in the graph
-    unsigned int numberOfArcs() const {
+    Identifier numberOfArcs() const {
         return 0;
     }
 
@@ -802,7 +803,7 @@ public:
                      _ReadableDirectedGraph
                      > ();
 
-            unsigned int n = _graph.degree(_Node());
+            Identifier n = _graph.degree(_Node());
             n = _graph.inDegree(_Node());
             n = _graph.outDegree(_Node());
             n = _graph.numberOfNodes();
@@ -851,7 +852,7 @@ public:
 
     /// \brief Gets the degree of the node.
     /// \pre The node must be valid.
-    unsigned int degree(Node) const {
+    Identifier degree(Node) const {
         return 0;
     }
 
@@ -868,12 +869,12 @@ public:
     }
 
     /// \brief The number of nodes in the graph
-    unsigned int numberOfNodes() const {
+    Identifier numberOfNodes() const {
         return 0;
     }
 
     /// \brief The number of arcs in the graph
-    unsigned int numberOfEdges() const {
+    Identifier numberOfEdges() const {
         return 0;
     }
 
@@ -925,7 +926,7 @@ public:
                      _ReadableUndirectedGraph
                      > ();
 
-            unsigned int n = _graph.degree(_Node());
+            Identifier n = _graph.degree(_Node());
             _Node node = _graph.u(_Edge());
             node = _graph.v(_Edge());
             n = _graph.numberOfNodes();
@@ -25,6 +25,7 @@
 #ifndef DENALI_CONCEPTS_LANDSCAPE_H
 #define DENALI_CONCEPTS_LANDSCAPE_H
 
+#include <denali/identifiers.h>
 
 namespace denali {
 namespace concepts {
@@ -43,7 +44,7 @@ public:
     double z() const {
         return 0;
     }
-    unsigned int id() const {
+    Identifier id() const {
         return 0;
     }
 
@@ -55,7 +56,7 @@ public:
             double s = point.x();
             s = point.y();
             s = point.z();
-            unsigned int id = point.id();
+            Identifier id = point.id();
         }
 
         _Point& point;
@@ -69,13 +70,13 @@ public:
 class Triangle
 {
 public:
-    unsigned int i() const {
+    Identifier i() const {
         return 0;
     }
-    unsigned int j() const {
+    Identifier j() const {
         return 0;
     }
-    unsigned int k() const {
+    Identifier k() const {
         return 0;
     }
 
@@ -84,7 +85,7 @@ public:
     {
         void constraints()
         {
-            unsigned int x = triangle.i();
+            Identifier x = triangle.i();
             x = triangle.j();
             x = triangle.k();
         }
@@ -140,7 +141,7 @@ public:
     }
 
     /// \brief Get the ID of the node.
-    unsigned int getID(Node node) const
+    Identifier getID(Node node) const
     {
         return 0;
     }
@@ -152,7 +153,7 @@ public:
     }
 
     /// \brief Get the node from an ID.
-    Node getNode(unsigned int id) const
+    Node getNode(Identifier id) const
     {
         return Node();
     }
@@ -169,7 +170,7 @@ public:
         void constraints()
         {
             double x = _tree.getValue(_Node());
-            unsigned int u = _tree.getID(_Node());
+            Identifier u = _tree.getID(_Node());
             _Node node = _tree.getNode(0);
             _Members members = _tree.getNodeMembers(_Node());
             members = _tree.getArcMembers(_Arc());
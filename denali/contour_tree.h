@@ -33,10 +33,12 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include <denali/allocators.h>
 #include <denali/graph_iterators.h>
 #include <denali/graph_maps.h>
 #include <denali/graph_mixins.h>
 #include <denali/graph_structures.h>
+#include <denali/identifiers.h>
 
 namespace denali {
 
@@ -70,7 +72,7 @@ public:
 private:
     GraphType _graph;
     ObservingNodeMap<GraphType, double> _node_to_value;
-    ObservingNodeMap<GraphType, unsigned int> _node_to_id;
+    ObservingNodeMap<GraphType, Identifier> _node_to_id;
 
     // keep a copy of the nodes locally
     std::vector<Node> _nodes;
@@ -108,12 +110,12 @@ public:
         return _node_to_value[node];
     }
 
-    Node getNode(unsigned int index) const
+    Node getNode(Identifier index) const
     {
         return _nodes[index];
     }
 
-    unsigned int getID(Node node) const
+    Identifier getID(Node node) const
     {
         return _node_to_id[node];
     }
@@ -150,7 +152,7 @@ public:
     ScalarSimplicialComplexRandomAccessAdapter(const ScalarSimplicialComplex& plex)
         : _plex(plex) { }
 
-    const double operator[](unsigned int index) const
+    const double operator[](Identifier index) const
     {
         return _plex.getValue(_plex.getNode(index));
     }
@@ -177,8 +179,11 @@ public:
  *   - concepts::UndirectedScalarMemberIDGraph
  *   - concepts::NodeObservable
  *   - concepts::EdgeObservable
+ *
+ *  The member sets and the id lookup table are stored using the Allocator,
+ *  rebound to the appropriate types.
  */
-template <typename GraphType>
+template <typename GraphType, typename Allocator = std::allocator<char> >
 class UndirectedScalarMemberIDGraphBase :
     public
     EdgeObservableMixin < GraphType,
@@ -190,10 +195,10 @@ public:
 
     class Member
     {
-        unsigned int _id;
+        Identifier _id;
         double _value;
     public:
-        Member(unsigned int id, double value) :
+        Member(Identifier id, double value) :
             _id(id), _value(value) {}
 
         bool operator==(const Member& rhs) const {
@@ -204,7 +209,7 @@ public:
             return _id < rhs._id;
         }
 
-        unsigned int getID() const {
+        Identifier getID() const {
             return _id;
         }
 
@@ -213,7 +218,8 @@ public:
         }
     };
 
-    typedef std::vector<Member> Members;
+    typedef typename Allocator::template rebind<Member>::other MemberAllocator;
+    typedef std::vector<Member, MemberAllocator> Members;
 
 private:
     typedef
@@ -223,15 +229,23 @@ private:
                         BaseGraphMixin <GraphType> > > >
                         Mixin;
 
+    typedef typename Allocator::template rebind<Identifier>::other IDAllocator;
+    typedef typename Allocator::template rebind<double>::other ValueAllocator;
+    typedef typename Allocator::template rebind<Members>::other MembersAllocator;
+
+    typedef std::pair<const Identifier, typename GraphType::Node> IDNodePair;
+    typedef typename Allocator::template rebind<IDNodePair>::other IDNodeAllocator;
+
     GraphType _graph;
 
-    ObservingNodeMap<GraphType, unsigned int> _node_to_id;
-    ObservingNodeMap<GraphType, double> _node_to_value;
-    typedef std::map<unsigned int, typename GraphType::Node> IDToNode;
+    ObservingNodeMap<GraphType, Identifier, IDAllocator> _node_to_id;
+    ObservingNodeMap<GraphType, double, ValueAllocator> _node_to_value;
+    typedef std::map<Identifier, typename GraphType::Node,
+                     std::less<Identifier>, IDNodeAllocator> IDToNode;
     IDToNode _id_to_node;
 
-    ObservingNodeMap<GraphType, Members> _node_to_members;
-    ObservingEdgeMap<GraphType, Members> _edge_to_members;
+    ObservingNodeMap<GraphType, Members, MembersAllocator> _node_to_members;
+    ObservingEdgeMap<GraphType, Members, MembersAllocator> _edge_to_members;
 
     // the total number of nodes + number of members
     size_t _nodes_plus_members;
@@ -247,12 +261,26 @@ public:
     {
     }
 
+    /// \brief Constructs the graph with all of its storage from the allocator.
+    explicit UndirectedScalarMemberIDGraphBase(const Allocator& allocator)
+        : Mixin(_graph), _graph(allocator),
+          _node_to_id(_graph, 0, IDAllocator(allocator)),
+          _node_to_value(_graph, 0, ValueAllocator(allocator)),
+          _id_to_node(std::less<Identifier>(), IDNodeAllocator(allocator)),
+          _node_to_members(_graph, Members(MemberAllocator(allocator)),
+                           MembersAllocator(allocator)),
+          _edge_to_members(_graph, Members(MemberAllocator(allocator)),
+                           MembersAllocator(allocator)),
+          _nodes_plus_members(0)
+    {
+    }
+
     /// \brief Add a node to the graph.
     /*!
      *  \param  id      The id of the node.
      *  \param  value   The scalar value of the node.
      */
-    Node addNode(unsigned int id, double value)
+    Node addNode(Identifier id, double value)
     {
         Node node = _graph.addNode();
         _node_to_id[node] = id;
@@ -299,8 +327,10 @@ public:
     {
         _nodes_plus_members -= _edge_to_members[edge].size();
 
-        // an idiom to reduce the capacity of a vector
-        std::vector<Member>().swap(_edge_to_members[edge]);
+        // an idiom to reduce the capacity of a vector. the empty vector
+        // shares the allocator of the old one
+        Members& members = _edge_to_members[edge];
+        Members(members.get_allocator()).swap(members);
 
         _graph.removeEdge(edge);
     }
@@ -348,7 +378,7 @@ public:
     }
 
     /// \brief Get a node's ID
-    unsigned int getID(Node node) const
+    Identifier getID(Node node) const
     {
         return _node_to_id[node];
     }
@@ -360,7 +390,7 @@ public:
     }
 
     /// \brief Retrieve a node by its ID.
-    Node getNode(unsigned int id)
+    Node getNode(Identifier id)
     {
         typename IDToNode::const_iterator it = _id_to_node.find(id);
 
@@ -394,18 +424,35 @@ public:
 /// \ingroup contour_tree
 /*!
  *  Conforms to concepts::UndirectedScalarMemberIDGraph
+ *
+ *  By default, storage is allocated from the heap. A graph which is
+ *  constructed with a MonotonicArena instead places all of its storage in
+ *  the arena, and keeps the arena alive for as long as the graph exists.
  */
 class UndirectedScalarMemberIDGraph :
+    private ArenaHolder,
     public
-    UndirectedScalarMemberIDGraphBase <UndirectedGraph>
+    UndirectedScalarMemberIDGraphBase <
+    BasicUndirectedGraph<ArenaAllocator<char> >,
+    ArenaAllocator<char> >
 {
-    typedef UndirectedScalarMemberIDGraphBase <UndirectedGraph> Base;
+    typedef
+    UndirectedScalarMemberIDGraphBase <
+    BasicUndirectedGraph<ArenaAllocator<char> >,
+    ArenaAllocator<char> >
+    Base;
 
 public:
     typedef Base::Node Node;
     typedef Base::Edge Edge;
     typedef Base::Members Members;
 
+    UndirectedScalarMemberIDGraph() {}
+
+    /// \brief Constructs a graph whose storage is placed in the arena.
+    explicit UndirectedScalarMemberIDGraph(boost::shared_ptr<MonotonicArena> arena)
+        : ArenaHolder(arena), Base(ArenaAllocator<char>(arena.get())) {}
+
 };
 
 ////////////////////////////////////////////////////////////////////////////
@@ -441,7 +488,7 @@ public:
     }
 
     /// \brief Get a node's ID
-    unsigned int getID(Node node) const
+    Identifier getID(Node node) const
     {
         return _graph.getID(node);
     }
@@ -453,7 +500,7 @@ public:
     }
 
     /// \brief Retrieve a node by its ID
-    Node getNode(unsigned int id) const
+    Node getNode(Identifier id) const
     {
         return _graph.getNode(id);
     }
@@ -526,6 +573,25 @@ public:
         return ContourTree(graph);
     }
 
+    /// \brief Compute a contour tree whose storage is placed in an arena.
+    /*!
+     *  The tree is built once and afterwards only read, so none of its
+     *  storage needs to be released individually. Every node, edge and
+     *  member is allocated from the arena, which is freed as a whole when
+     *  the last copy of the tree is destroyed.
+     */
+    template <typename ScalarSimplicialComplex, typename ContourTreeAlgorithm>
+    static ContourTree
+    compute(
+        const ScalarSimplicialComplex& simplicial_complex,
+        ContourTreeAlgorithm& algorithm,
+        boost::shared_ptr<MonotonicArena> arena)
+    {
+        boost::shared_ptr<Graph> graph = boost::shared_ptr<Graph>(new Graph(arena));
+        algorithm.compute(simplicial_complex, *graph);
+        return ContourTree(graph);
+    }
+
     /// \brief Load a contour tree from a UndirectedScalarMemberIDGraph.
     /*!
      *  The utility of having this function as opposed to exposing the constructor
@@ -689,10 +755,10 @@ template <typename TotalOrder>
 class DisjointSetForest
 {
     const TotalOrder& order;
-    std::vector<unsigned int> parent;
-    std::vector<unsigned int> rank;
-    std::vector<unsigned int> max_element;
-    std::vector<unsigned int> min_element;
+    std::vector<Identifier> parent;
+    std::vector<Identifier> rank;
+    std::vector<Identifier> max_element;
+    std::vector<Identifier> min_element;
 
 public:
 
@@ -712,8 +778,8 @@ public:
     }
 
 
-    unsigned int
-    findSet(unsigned int x)
+    Identifier
+    findSet(Identifier x)
     {
         if (this->parent[x] != x) {
             this->parent[x] = findSet(this->parent[x]);
@@ -722,22 +788,22 @@ public:
         return this->parent[x];
     }
 
-    unsigned int
-    findMax(unsigned int x)
+    Identifier
+    findMax(Identifier x)
     {
         return this->max_element[this->findSet(x)];
     }
 
 
-    unsigned int
-    findMin(unsigned int x)
+    Identifier
+    findMin(Identifier x)
     {
         return this->min_element[this->findSet(x)];
     }
 
 
     void
-    setUnion(unsigned int x, unsigned int y)
+    setUnion(Identifier x, Identifier y)
     {
         this->link(this->findSet(x), this->findSet(y));
     }
@@ -745,13 +811,13 @@ public:
 
 private:
     void
-    link(unsigned int x, unsigned int y)
+    link(Identifier x, Identifier y)
     {
 
-        unsigned int max_x_id = this->order.elementToPosition(this->max_element[x]);
-        unsigned int min_x_id = this->order.elementToPosition(this->min_element[x]);
-        unsigned int max_y_id = this->order.elementToPosition(this->max_element[y]);
-        unsigned int min_y_id = this->order.elementToPosition(this->min_element[y]);
+        Identifier max_x_id = this->order.elementToPosition(this->max_element[x]);
+        Identifier min_x_id = this->order.elementToPosition(this->min_element[x]);
+        Identifier max_y_id = this->order.elementToPosition(this->max_element[y]);
+        Identifier min_y_id = this->order.elementToPosition(this->min_element[y]);
 
         if (this->rank[x] > this->rank[y]) {
             this->parent[y] = x;
@@ -793,8 +859,8 @@ private:
 class TotalOrder
 {
 public:
-    typedef std::vector<unsigned int> ElementToPosition;
-    typedef std::vector<unsigned int> PositionToElement;
+    typedef std::vector<Identifier> ElementToPosition;
+    typedef std::vector<Identifier> PositionToElement;
 
 private:
     ElementToPosition _element_to_position;
@@ -805,12 +871,12 @@ private:
 
 public:
 
-    unsigned int elementToPosition(unsigned int element) const
+    Identifier elementToPosition(Identifier element) const
     {
         return _element_to_position[element];
     }
 
-    unsigned int positionToElement(unsigned int position) const
+    Identifier positionToElement(Identifier position) const
     {
         return _position_to_element[position];
     }
@@ -823,8 +889,8 @@ public:
     /*!
      *  Values must support random access by operator[] and have a size method.
      *
-     *  ComparisonFunctor must provide `bool operator()(unsigned int x,
-     *  unsigned int y)`.
+     *  ComparisonFunctor must provide `bool operator()(Identifier x,
+     *  Identifier y)`.
      */
     template <typename Values, typename ComparisonFunctor>
     static TotalOrder compute(
@@ -838,7 +904,7 @@ public:
         PositionToElement& order_to_index = ordering._position_to_element;
 
         // intialize _position_to_element to contain the range of indices
-        unsigned int index = 0;
+        Identifier index = 0;
         for (PositionToElement::iterator it = order_to_index.begin();
                 it != order_to_index.end();
                 ++it) {
@@ -848,7 +914,7 @@ public:
         // now sort the ordering
         std::sort(order_to_index.begin(), order_to_index.end(), cmp);
 
-        unsigned int order = 0;
+        Identifier order = 0;
         for (PositionToElement::iterator it = order_to_index.begin();
                 it != order_to_index.end();
                 ++it) {
@@ -877,7 +943,7 @@ class RandomAccessValueSorter
 
 public:
     RandomAccessValueSorter(const Values& values) : values(values) { }
-    bool operator()(unsigned int u, unsigned int v)
+    bool operator()(Identifier u, Identifier v)
     {
         return values[u] < values[v];
     }
@@ -903,7 +969,7 @@ class DirectedIDGraph :
 
     GraphType _graph;
 
-    ObservingNodeMap<GraphType, unsigned int> _node_to_id;
+    ObservingNodeMap<GraphType, Identifier> _node_to_id;
     std::vector<typename GraphType::Node> _id_to_node;
 
 public:
@@ -961,12 +1027,12 @@ public:
         _graph.removeArc(arc);
     }
 
-    Node getNode(unsigned int id) const
+    Node getNode(Identifier id) const
     {
         return _id_to_node[id];
     }
 
-    unsigned int getID(Node node) const
+    Identifier getID(Node node) const
     {
         return _node_to_id[node];
     }
@@ -1061,7 +1127,7 @@ public:
         // take the nodes in order
         for (size_t i=0; i<total_order.size(); ++i) {
             // get the id of this node in the order
-            unsigned int vi = total_order.positionToElement(i);
+            Identifier vi = total_order.positionToElement(i);
 
             // iterate through the neighbors of the node in the complex
             typedef UndirectedNeighborIterator<ScalarSimplicialComplex> NeighborIt;
@@ -1070,12 +1136,12 @@ public:
                     !neighbor_it.done();
                     ++neighbor_it) {
 
-                unsigned int vj = plex.getID(neighbor_it.neighbor());
+                Identifier vj = plex.getID(neighbor_it.neighbor());
 
                 if (total_order.elementToPosition(vj) < total_order.elementToPosition(vi)) {
                     if (forest.findSet(vi) != forest.findSet(vj)) {
 
-                        unsigned int vk = forest.findMax(vj);
+                        Identifier vk = forest.findMax(vj);
                         join_tree.addArc(
                             join_tree.getNode(vi),
                             join_tree.getNode(vk));
@@ -1102,9 +1168,9 @@ public:
         DisjointSetForest<TotalOrder> forest(total_order);
 
         // take the nodes in reverse order
-        for (int i=total_order.size()-1; i>=0; --i) {
+        for (Index i=total_order.size()-1; i>=0; --i) {
             // get the id of this node in the order
-            unsigned int vi = total_order.positionToElement(i);
+            Identifier vi = total_order.positionToElement(i);
 
             // iterate through the neighbors of the node in the complex
             typedef UndirectedNeighborIterator<ScalarSimplicialComplex> NeighborIt;
@@ -1113,12 +1179,12 @@ public:
                     !neighbor_it.done();
                     ++neighbor_it) {
 
-                unsigned int vj = plex.getID(neighbor_it.neighbor());
+                Identifier vj = plex.getID(neighbor_it.neighbor());
 
                 if (total_order.elementToPosition(vj) > total_order.elementToPosition(vi)) {
                     if (forest.findSet(vi) != forest.findSet(vj)) {
 
-                        unsigned int vk = forest.findMin(vj);
+                        Identifier vk = forest.findMin(vj);
                         split_tree.addArc(
                             split_tree.getNode(vi),
                             split_tree.getNode(vk));
@@ -1172,7 +1238,7 @@ public:
         // simultaneously, add nodes to the merge queue if they have a total
         // of one child in the join and split tree
         std::vector<typename MergeTree::Node> merge_tree_nodes;
-        std::queue<unsigned int> merge_queue;
+        std::queue<Identifier> merge_queue;
 
         for (size_t i=0; i<plex.numberOfNodes(); ++i) 
         {
@@ -1192,10 +1258,10 @@ public:
         std::vector<bool> visited(merge_tree.numberOfNodes(), false);
 
         // now merge the trees
-        unsigned int i = 0;
+        Identifier i = 0;
         while (i < merge_tree.numberOfNodes() - 1) 
         {
-            unsigned int vi = merge_queue.front();
+            Identifier vi = merge_queue.front();
             merge_queue.pop();
 
             if (visited[vi])
@@ -1219,8 +1285,8 @@ public:
                                                     split_tree.getFirstInArc(
                                                     split_tree.getNode(vi)));
 
-                unsigned int vk_join = join_tree.getID(vk_join_node);
-                unsigned int vk_split = split_tree.getID(vk_split_node);
+                Identifier vk_join = join_tree.getID(vk_join_node);
+                Identifier vk_split = split_tree.getID(vk_split_node);
 
                 merge_tree.addEdge(merge_tree_nodes[vi], merge_tree_nodes[vk_join]);
 
@@ -1242,7 +1308,7 @@ public:
             }
             else
             {
-                unsigned int vk;
+                Identifier vk;
 
                 if (join_tree.outDegree(join_tree.getNode(vi)) == 0) 
                 {
@@ -1324,13 +1390,13 @@ public:
         Node first_node = tree.opposite(node, first_edge);
         Node second_node = tree.opposite(node, second_edge);
 
-        unsigned int vi = tree.getID(first_node);
-        unsigned int vj = tree.getID(node);
-        unsigned int vk = tree.getID(second_node);
+        Identifier vi = tree.getID(first_node);
+        Identifier vj = tree.getID(node);
+        Identifier vk = tree.getID(second_node);
 
-        unsigned int pi = order.elementToPosition(vi);
-        unsigned int pj = order.elementToPosition(vj);
-        unsigned int pk = order.elementToPosition(vk);
+        Identifier pi = order.elementToPosition(vi);
+        Identifier pj = order.elementToPosition(vj);
+        Identifier pk = order.elementToPosition(vk);
 
         if ((pi < pj) && (pj < pk)) {
             return true;
@@ -1402,7 +1468,7 @@ private:
 //
 ////////////////////////////////////////////////////////////////////////////////
 
-typedef std::map<unsigned int, double> WeightMap;
+typedef std::map<Identifier, double> WeightMap;
 
 
 }
@@ -28,12 +28,15 @@
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
+#include <limits>
 #include <stdexcept>
 #include <sstream>
 #include <vector>
 
 #include <denali/contour_tree.h>
+#include <denali/graph_algorithms.h>
 #include <denali/graph_iterators.h>
+#include <denali/identifiers.h>
 
 namespace denali {
 
@@ -53,6 +56,39 @@ inline void safeOpenFile(const char* filename, std::ifstream& fh)
 }
 
 
+/// \brief Parse a vertex id, returning false if the string is not one.
+/*!
+ *  Only non-negative decimal integers which fit in an Identifier are
+ *  accepted. Unlike strtol, the range does not depend on the width of a long
+ *  on the platform.
+ */
+inline bool parseIdentifier(const char* str, Identifier& id)
+{
+    const Identifier max = std::numeric_limits<Identifier>::max();
+
+    if (*str == 0) {
+        return false;
+    }
+
+    Identifier result = 0;
+    for (; *str != 0; ++str) {
+        if (*str < '0' || *str > '9') {
+            return false;
+        }
+
+        Identifier digit = *str - '0';
+        if (result > (max - digit) / 10) {
+            return false;
+        }
+
+        result = 10 * result + digit;
+    }
+
+    id = result;
+    return true;
+}
+
+
 /// \brief Parses a tabular file, calling FormatParser to handle each line.
 class TabularFileParser
 {
@@ -98,7 +134,7 @@ template <typename ScalarSimplicialComplex>
 class VertexValueFormatParser
 {
     ScalarSimplicialComplex& plex;
-    int lineno;
+    Identifier lineno;
 
 public:
 
@@ -160,12 +196,17 @@ template <typename ScalarSimplicialComplex>
 class EdgeFormatParser
 {
     ScalarSimplicialComplex& plex;
-    int lineno;
+    ConcurrentDisjointSets* sets;
+    Identifier lineno;
 
 public:
 
     EdgeFormatParser(ScalarSimplicialComplex& plex)
-        : plex(plex), lineno(0) { }
+        : plex(plex), sets(0), lineno(0) { }
+
+    /// \brief Also unite the endpoints of every edge in the disjoint sets.
+    EdgeFormatParser(ScalarSimplicialComplex& plex, ConcurrentDisjointSets& sets)
+        : plex(plex), sets(&sets), lineno(0) { }
 
 
     void insert(std::vector<std::string>& line)
@@ -176,21 +217,34 @@ public:
             throw std::runtime_error(msg.str());
         }
 
-        char * err_u;
-        long int u = strtol(line[0].c_str(), &err_u, 10);
-        char * err_v;
-        long int v = strtol(line[1].c_str(), &err_v, 10);
-
-        if (*err_u != 0 || *err_v != 0) {
+        Identifier u, v;
+        if (!parseIdentifier(line[0].c_str(), u) ||
+            !parseIdentifier(line[1].c_str(), v)) {
             std::stringstream msg;
             msg << "Problem interpreting line " << lineno << " as an edge.";
             throw std::runtime_error(msg.str());
         }
+
+        Identifier n_vertices = plex.numberOfNodes();
+        if (u >= n_vertices || v >= n_vertices) {
+            std::stringstream msg;
+            msg << "Edge on line " << lineno << " refers to a vertex which "
+                << "does not exist. There are " << n_vertices << " vertices.";
+            throw std::runtime_error(msg.str());
+        }
         lineno++;
 
         // don't add self-edges
         if (u != v) {
-            plex.addEdge(plex.getNode(u),plex.getNode(v));
+            typename ScalarSimplicialComplex::Node node_u = plex.getNode(u);
+            typename ScalarSimplicialComplex::Node node_v = plex.getNode(v);
+
+            plex.addEdge(node_u, node_v);
+
+            if (sets) {
+                sets->unite(plex.getNodeIdentifier(node_u),
+                            plex.getNodeIdentifier(node_v));
+            }
         }
     }
 };
@@ -211,6 +265,35 @@ void readSimplicialEdgeFile(
     parser.parse(fh, format_parser);
 }
 
+
+/// \brief Read edges into a scalar simplicial complex, tracking connectivity.
+/// \ingroup fileio
+/*!
+ *  The endpoints of each edge are united in the disjoint sets as the edge is
+ *  read, so that the connected components are known as soon as the file has
+ *  been parsed. The sets are resized to hold one element per node
+ *  identifier, and must not be resized by another thread while the file is
+ *  being read. They can be passed to ConnectedComponents to label the
+ *  components.
+ *
+ *  \pre The vertices have already been read into the complex.
+ */
+template <typename ScalarSimplicialComplex>
+void readSimplicialEdgeFile(
+    const char * filename,
+    ScalarSimplicialComplex& plex,
+    ConcurrentDisjointSets& sets)
+{
+    sets.resize(plex.getMaxNodeIdentifier());
+
+    EdgeFormatParser<ScalarSimplicialComplex> format_parser(plex, sets);
+    TabularFileParser parser;
+
+    std::ifstream fh;
+    safeOpenFile(filename, fh);
+    parser.parse(fh, format_parser);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //
 // WriteContourTree
@@ -282,8 +365,8 @@ class ContourTreeFormatParser
     typedef typename GraphType::Member Member;
 
     GraphType& _graph;
-    unsigned int _lineno;
-    unsigned int _n_vertices;
+    Identifier _lineno;
+    Identifier _n_vertices;
 
     std::vector<double> _vertex_values;
 
@@ -313,10 +396,7 @@ public:
                 "of vertices in the file.");
         }
 
-        char * err;
-        _n_vertices = strtol(line[0].c_str(), &err, 10);
-
-        if (*err != 0) {
+        if (!parseIdentifier(line[0].c_str(), _n_vertices)) {
             throw std::runtime_error(
                 "Could not interpret first line of contour tree file.");
         }
@@ -335,13 +415,13 @@ public:
             throw std::runtime_error(msg.str());
         }
 
-        char* id_err;
-        long int id = strtol(line[0].c_str(), &id_err, 10);
+        Identifier id;
+        bool id_ok = parseIdentifier(line[0].c_str(), id);
 
         char* value_err;
         double value = strtod(line[1].c_str(), &value_err);
 
-        if (*value_err != 0 || *id_err !=0 || id < 0) {
+        if (*value_err != 0 || !id_ok) {
             throw std::runtime_error(msg.str());
         }
 
@@ -358,12 +438,9 @@ public:
             throw std::runtime_error(msg.str());
         }
 
-        char * u_err;
-        char * v_err;
-        unsigned int u_id = strtol(line[0].c_str(), &u_err, 10);
-        unsigned int v_id = strtol(line[1].c_str(), &v_err, 10);
-
-        if (*u_err != 0 || *v_err != 0) {
+        Identifier u_id, v_id;
+        if (!parseIdentifier(line[0].c_str(), u_id) ||
+            !parseIdentifier(line[1].c_str(), v_id)) {
             throw std::runtime_error(msg.str());
         }
 
@@ -381,13 +458,13 @@ public:
         Edge edge = _graph.addEdge(u,v);
 
         for (size_t i=2; i<line.size(); i+=2) {
-            char* id_err;
-            unsigned int member_id = strtol(line[i].c_str(), &id_err, 10);
+            Identifier member_id;
+            bool id_ok = parseIdentifier(line[i].c_str(), member_id);
 
             char* value_err;
             double member_value = strtod(line[i+1].c_str(), &value_err);
 
-            if (*id_err != 0 || *value_err != 0) {
+            if (!id_ok || *value_err != 0) {
                 throw std::runtime_error(msg.str());
             }
 
@@ -444,7 +521,7 @@ inline ContourTree readContourTreeFile(
 class WeightMapFormatParser
 {
     WeightMap& _weight_map;
-    int lineno;
+    Identifier lineno;
 
 public:
 
@@ -460,12 +537,12 @@ public:
             throw std::runtime_error(msg.str());
         }
 
-        char * err_u;
-        long int u = strtol(line[0].c_str(), &err_u, 10);
+        Identifier u;
+        bool u_ok = parseIdentifier(line[0].c_str(), u);
         char * err_weight;
         double weight = strtod(line[1].c_str(), &err_weight);
 
-        if (*err_u != 0 || *err_weight != 0 || u < 0) {
+        if (!u_ok || *err_weight != 0) {
             std::stringstream msg;
             msg << "Problem interpreting line " << lineno << " as a vertex ID and a weight.";
             throw std::runtime_error(msg.str());
@@ -516,12 +593,12 @@ inline void readWeightMapFile(
 //
 ////////////////////////////////////////////////////////////////////////////////
 
-typedef std::map<unsigned int, double> ColorMap;
+typedef std::map<Identifier, double> ColorMap;
 
 class ColorMapFormatParser
 {
     ColorMap& _color_map;
-    int lineno;
+    Identifier lineno;
 
 public:
 
@@ -537,13 +614,13 @@ public:
             throw std::runtime_error(msg.str());
         }
 
-        char* err_id;
-        long int id = strtol(line[0].c_str(), &err_id, 10);
+        Identifier id;
+        bool id_ok = parseIdentifier(line[0].c_str(), id);
 
         char* err_color;
         double color = strtod(line[1].c_str(), &err_color);
 
-        if (*err_color != 0 || *err_id != 0) {
+        if (*err_color != 0 || !id_ok) {
             std::stringstream msg;
             msg << "Problem interpreting line " << lineno << " as an edge.";
             throw std::runtime_error(msg.str());
@@ -619,7 +696,7 @@ void writeJoinSplitTreeFile(
     // write each vertex (node and member alike) to the file
     for (NodeIterator<JoinSplitTree> it(tree); !it.done(); ++it)
     {
-        unsigned int id = tree.getID(it.node());
+        Identifier id = tree.getID(it.node());
         double value = plex.getValue(plex.getNode(id));
 
         fh << id << "\t" 
@@ -31,7 +31,13 @@
 #include <denali/graph_structures.h>
 #include <denali/mappable_list.h>
 
+#include <boost/unordered_map.hpp>
+
+#include <algorithm>
+#include <limits>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
 namespace denali {
 
@@ -42,36 +48,185 @@ namespace denali {
 ////////////////////////////////////////////////////////////////////////////////
 
 
-/// \brief Expands the subtree
+/// \brief Counts the graph elements folded beneath nodes and edges.
 /// \ingroup fold_tree
 /*!
- *  Given an edge, specified by the parent and child nodes, fully expands every
- *  edge and node that is in the induced subtree. 
+ *  Walks the fold hierarchy below each counted node and edge, totalling the
+ *  nodes and edges that unfolding them would restore. The totals are used to
+ *  reserve the tree's storage before a batched expansion. An unreduce
+ *  restores two edges and removes one, so it adds one to the edge count.
  */
 template <typename FoldedTree>
-void expandSubtree(
-        FoldedTree& tree,
-        typename FoldedTree::Node parent,
-        typename FoldedTree::Node child)
+class FoldedElementCounter
 {
     typedef typename FoldedTree::Node Node;
     typedef typename FoldedTree::Edge Edge;
+    typedef typename FoldedTree::NodeFold NodeFold;
+    typedef typename FoldedTree::EdgeFold EdgeFold;
 
-    std::queue<Edge> expand_queue;
+    const FoldedTree& _tree;
+    std::vector<NodeFold> _node_stack;
+    std::vector<EdgeFold> _edge_stack;
 
-    // add all of the edges in the subtree to the queue
-    expand_queue.push(tree.findEdge(parent,child));
+    size_t _nodes;
+    size_t _edges;
 
-    assert(tree.isEdgeValid(tree.findEdge(parent, child)));
+    void count()
+    {
+        while (!_node_stack.empty() || !_edge_stack.empty())
+        {
+            if (!_node_stack.empty())
+            {
+                NodeFold node_fold = _node_stack.back();
+                _node_stack.pop_back();
 
-    for (UndirectedBFSIterator<FoldedTree> it(tree, parent, child);
-            !it.done(); ++it) 
+                // every collapsed edge restores itself and the opposite node
+                for (int i=0;
+                        i<_tree.numberOfCollapsedEdgeFolds(node_fold); ++i)
+                {
+                    EdgeFold edge_fold =
+                            _tree.getCollapsedEdgeFold(node_fold, i);
+
+                    NodeFold opposite = _tree.uFold(edge_fold) == node_fold ?
+                            _tree.vFold(edge_fold) : _tree.uFold(edge_fold);
+
+                    _nodes++;
+                    _edges++;
+                    _edge_stack.push_back(edge_fold);
+                    _node_stack.push_back(opposite);
+                }
+            }
+            else
+            {
+                EdgeFold edge_fold = _edge_stack.back();
+                _edge_stack.pop_back();
+
+                if (_tree.hasReduced(edge_fold))
+                {
+                    NodeFold reduced = _tree.reducedFold(edge_fold);
+
+                    _nodes++;
+                    _edges++;
+                    _node_stack.push_back(reduced);
+                    _edge_stack.push_back(_tree.uvFold(reduced));
+                    _edge_stack.push_back(_tree.vwFold(reduced));
+                }
+            }
+        }
+    }
+
+public:
+
+    FoldedElementCounter(const FoldedTree& tree)
+        : _tree(tree), _nodes(0), _edges(0) {}
+
+    /// \brief Counts the elements folded into the node.
+    void countNode(Node node)
     {
-        assert(tree.isEdgeValid(it.edge()));
-        expand_queue.push(it.edge());
+        _node_stack.push_back(_tree.getNodeFold(node));
+        count();
     }
 
-    // now we expand each edge
+    /// \brief Counts the elements folded into the edge.
+    void countEdge(Edge edge)
+    {
+        _edge_stack.push_back(_tree.getEdgeFold(edge));
+        count();
+    }
+
+    size_t numberOfNodes() const {
+        return _nodes;
+    }
+
+    size_t numberOfEdges() const {
+        return _edges;
+    }
+};
+
+
+/// \brief Finds which of a node's collapsed edges leads to a leaf.
+/// \ingroup fold_tree
+/*!
+ *  The search starts with the most recently collapsed edge. Returns -1 if
+ *  the leaf is not collapsed into the base.
+ */
+template <typename FoldedTree>
+int findCollapsedIndex(
+        const FoldedTree& tree,
+        typename FoldedTree::NodeFold base_fold,
+        typename FoldedTree::NodeFold leaf_fold)
+{
+    typedef typename FoldedTree::EdgeFold EdgeFold;
+
+    for (int i=tree.numberOfCollapsedEdgeFolds(base_fold)-1; i>=0; --i)
+    {
+        EdgeFold edge_fold = tree.getCollapsedEdgeFold(base_fold, i);
+        if (tree.uFold(edge_fold) == leaf_fold ||
+                tree.vFold(edge_fold) == leaf_fold) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+
+/// \brief Finds the edge which a reduced node was folded into.
+/// \ingroup fold_tree
+/*!
+ *  The nodes at either end of the reduced node's edges must be in the tree.
+ */
+template <typename FoldedTree>
+typename FoldedTree::Edge findReducingEdge(
+        const FoldedTree& tree,
+        typename FoldedTree::NodeFold node_fold)
+{
+    typedef typename FoldedTree::NodeFold NodeFold;
+    typedef typename FoldedTree::EdgeFold EdgeFold;
+
+    EdgeFold uv_fold = tree.uvFold(node_fold);
+    EdgeFold vw_fold = tree.vwFold(node_fold);
+
+    NodeFold u_fold = tree.uFold(uv_fold) == node_fold ?
+            tree.vFold(uv_fold) : tree.uFold(uv_fold);
+
+    NodeFold w_fold = tree.uFold(vw_fold) == node_fold ?
+            tree.vFold(vw_fold) : tree.uFold(vw_fold);
+
+    return tree.findEdge(tree.getNodeFromFold(u_fold),
+                         tree.getNodeFromFold(w_fold));
+}
+
+
+/// \brief Ignores the unfolds made by an expansion.
+template <typename FoldedTree>
+struct NullExpansionRecorder
+{
+    void uncollapsed(const FoldedTree&, typename FoldedTree::Node,
+                     typename FoldedTree::Edge) {}
+    void unreducing(const FoldedTree&, typename FoldedTree::Edge) {}
+};
+
+
+/// \brief Unfolds the queued edges and everything folded into them.
+/// \ingroup fold_tree
+/*!
+ *  The nodes at the ends of each edge are uncollapsed as well. Edges which
+ *  are restored along the way are queued and expanded in turn.
+ *
+ *  Before an edge is unreduced, `recorder.unreducing(tree, edge)` is called.
+ *  After an edge is uncollapsed from a node, `recorder.uncollapsed(tree,
+ *  node, edge)` is called with the restored edge.
+ */
+template <typename FoldedTree, typename Recorder>
+void expandQueuedEdges(
+        FoldedTree& tree,
+        std::queue<typename FoldedTree::Edge>& expand_queue,
+        Recorder& recorder)
+{
+    typedef typename FoldedTree::Node Node;
+    typedef typename FoldedTree::Edge Edge;
+
     while (expand_queue.size() > 0)
     {
         Edge edge = expand_queue.front();
@@ -80,6 +235,7 @@ void expandSubtree(
         // if the edge has a reduced node, unreduce it
         if (tree.hasReduced(edge))
         {
+            recorder.unreducing(tree, edge);
             Node node = tree.unreduce(edge);
 
             // add each of the node's neighbor edges to the expand list
@@ -93,6 +249,7 @@ void expandSubtree(
             while (tree.hasCollapsed(node))
             {
                 Edge collapsed_edge = tree.uncollapse(node);
+                recorder.uncollapsed(tree, node, collapsed_edge);
                 expand_queue.push(collapsed_edge);
             }
         }
@@ -104,17 +261,146 @@ void expandSubtree(
         while (tree.hasCollapsed(u))
         {
             Edge collapsed_edge = tree.uncollapse(u);
+            recorder.uncollapsed(tree, u, collapsed_edge);
             expand_queue.push(collapsed_edge);
         }
 
         while (tree.hasCollapsed(v))
         {
             Edge collapsed_edge = tree.uncollapse(v);
+            recorder.uncollapsed(tree, v, collapsed_edge);
             expand_queue.push(collapsed_edge);
         }
     }
 }
 
+
+/// \brief Unfolds the queued edges and everything folded into them.
+/// \ingroup fold_tree
+template <typename FoldedTree>
+void expandQueuedEdges(
+        FoldedTree& tree,
+        std::queue<typename FoldedTree::Edge>& expand_queue)
+{
+    NullExpansionRecorder<FoldedTree> null_recorder;
+    expandQueuedEdges(tree, expand_queue, null_recorder);
+}
+
+
+/// \brief Expands the subtree
+/// \ingroup fold_tree
+/*!
+ *  Given an edge, specified by the parent and child nodes, fully expands every
+ *  edge and node that is in the induced subtree. 
+ *
+ *  The expansion is batched: the nodes and edges to be restored are counted
+ *  and reserved up front, and the tree's observers are notified once at the
+ *  end rather than after every unfold.
+ */
+template <typename FoldedTree, typename Recorder>
+void expandSubtree(
+        FoldedTree& tree,
+        typename FoldedTree::Node parent,
+        typename FoldedTree::Node child,
+        Recorder& recorder)
+{
+    typedef typename FoldedTree::Edge Edge;
+
+    std::queue<Edge> expand_queue;
+    FoldedElementCounter<FoldedTree> counter(tree);
+
+    // add all of the edges in the subtree to the queue
+    Edge edge = tree.findEdge(parent, child);
+    assert(tree.isEdgeValid(edge));
+
+    expand_queue.push(edge);
+    counter.countEdge(edge);
+    counter.countNode(parent);
+    counter.countNode(child);
+
+    for (UndirectedBFSIterator<FoldedTree> it(tree, parent, child);
+            !it.done(); ++it) 
+    {
+        assert(tree.isEdgeValid(it.edge()));
+        expand_queue.push(it.edge());
+        counter.countEdge(it.edge());
+        counter.countNode(it.child());
+    }
+
+    // the reduced edge is restored before the reducing edge is removed
+    tree.reserve(counter.numberOfNodes(), counter.numberOfEdges() + 1);
+
+    tree.holdNotifications();
+    expandQueuedEdges(tree, expand_queue, recorder);
+    tree.releaseNotifications();
+}
+
+/// \brief Expands the subtree
+/// \ingroup fold_tree
+template <typename FoldedTree>
+void expandSubtree(
+        FoldedTree& tree,
+        typename FoldedTree::Node parent,
+        typename FoldedTree::Node child)
+{
+    NullExpansionRecorder<FoldedTree> null_recorder;
+    expandSubtree(tree, parent, child, null_recorder);
+}
+
+/// \brief Expands every folded node and edge of the tree.
+/// \ingroup fold_tree
+/*!
+ *  Afterwards, the tree has the structure of the unfolded contour tree. Like
+ *  expandSubtree(), the whole expansion is a single batch, and the unfolds
+ *  are reported to the recorder.
+ */
+template <typename FoldedTree, typename Recorder>
+void expandTree(FoldedTree& tree, Recorder& recorder)
+{
+    typedef typename FoldedTree::Edge Edge;
+
+    if (tree.numberOfNodes() == 0) {
+        return;
+    }
+
+    std::queue<Edge> expand_queue;
+    FoldedElementCounter<FoldedTree> counter(tree);
+
+    for (NodeIterator<FoldedTree> it(tree); !it.done(); ++it) {
+        counter.countNode(it.node());
+    }
+
+    for (EdgeIterator<FoldedTree> it(tree); !it.done(); ++it) {
+        expand_queue.push(it.edge());
+        counter.countEdge(it.edge());
+    }
+
+    tree.reserve(counter.numberOfNodes(), counter.numberOfEdges() + 1);
+
+    tree.holdNotifications();
+
+    // a lone node has no edges to queue
+    typename FoldedTree::Node root = tree.getFirstNode();
+    while (tree.hasCollapsed(root))
+    {
+        Edge collapsed_edge = tree.uncollapse(root);
+        recorder.uncollapsed(tree, root, collapsed_edge);
+        expand_queue.push(collapsed_edge);
+    }
+
+    expandQueuedEdges(tree, expand_queue, recorder);
+    tree.releaseNotifications();
+}
+
+/// \brief Expands every folded node and edge of the tree.
+/// \ingroup fold_tree
+template <typename FoldedTree>
+void expandTree(FoldedTree& tree)
+{
+    NullExpansionRecorder<FoldedTree> null_recorder;
+    expandTree(tree, null_recorder);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //
 // FoldTree
@@ -145,13 +431,17 @@ public:
     {
     public:
         virtual void notify() = 0;
+
+        /// \brief Called by compactFolds() with the new identifier of every
+        /// old fold, or -1 for folds which had been removed.
+        virtual void remap(const std::vector<Index>& new_identifiers) = 0;
     };
 
     class NodeFold
     {
         friend class FoldTree;
-        int _index;
-        NodeFold(int i) : _index(i) {}
+        Index _index;
+        NodeFold(Index i) : _index(i) {}
     public:
         NodeFold() : _index(-1) {}
 
@@ -171,8 +461,8 @@ public:
     class EdgeFold
     {
         friend class FoldTree;
-        int _index;
-        EdgeFold(int i) : _index(i) {}
+        Index _index;
+        EdgeFold(Index i) : _index(i) {}
 
     public:
     
@@ -213,7 +503,7 @@ public:
         Node node = _graph.addNode();
 
         // create the node fold representation
-        int n = _node_folds.insert(NodeFoldRep());
+        Index n = _node_folds.insert(NodeFoldRep());
         _node_folds[n].node = node;
 
         // link the node to the fold
@@ -232,7 +522,7 @@ public:
         NodeFold v_fold = _node_to_fold[v];
 
         // make an edge fold
-        int n = _edge_folds.insert(EdgeFoldRep());
+        Index n = _edge_folds.insert(EdgeFoldRep());
         _edge_folds[n].edge = edge;
         _edge_folds[n].u_fold = u_fold;
         _edge_folds[n].v_fold = v_fold;
@@ -270,7 +560,7 @@ public:
 
         // add the fold edge to the parent node folds collapse list
         NodeFold parent_node_fold = _node_to_fold[parent];
-        int n = parent_node_fold._index;
+        Index n = parent_node_fold._index;
         _node_folds[n].collapsed.push_back(_edge_to_fold[edge]);
 
         // remove the child from the tree
@@ -436,6 +726,82 @@ public:
         _edge_fold_observers.remove(&observer);
     }
 
+    /// \brief Makes room for restoring nodes and edges without growing the
+    /// graph's identifier space one element at a time.
+    void reserve(size_t nodes, size_t edges)
+    {
+        _graph.reserveNodes(nodes);
+        _graph.reserveEdges(edges);
+    }
+
+    /// \brief Defers graph and fold observer notifications.
+    /*!
+     *  Notifications which do not grow an identifier space are held back
+     *  until the matching releaseNotifications(), which fires each pending
+     *  notification once.
+     */
+    void holdNotifications()
+    {
+        _graph.holdNotifications();
+        _node_folds.holdNotifications();
+        _edge_folds.holdNotifications();
+    }
+
+    /// \brief Fires the notifications deferred since holdNotifications().
+    void releaseNotifications()
+    {
+        _graph.releaseNotifications();
+        _node_folds.releaseNotifications();
+        _edge_folds.releaseNotifications();
+    }
+
+    /// \brief Reclaims the storage of removed folds.
+    /*!
+     *  Edge folds are removed when an edge is unreduced, and their slots are
+     *  otherwise only reused by later reductions. Compaction renumbers the
+     *  folds in their storage order, updating the tree's own references and
+     *  every attached fold map.
+     *
+     *  NodeFold and EdgeFold handles held elsewhere are invalidated, except
+     *  for node folds: they are never removed, so their identifiers do not
+     *  change.
+     */
+    void compactFolds()
+    {
+        std::vector<Index> new_nodes;
+        std::vector<Index> new_edges;
+        _node_folds.compact(new_nodes);
+        _edge_folds.compact(new_edges);
+
+        for (MappableListIndexIterator<MappableList<NodeFoldRep> >
+                it(_node_folds); !it.done(); ++it)
+        {
+            NodeFoldRep& rep = *it;
+            for (size_t i=0; i<rep.collapsed.size(); ++i) {
+                rep.collapsed[i] = remap(new_edges, rep.collapsed[i]);
+            }
+            rep.uv_fold = remap(new_edges, rep.uv_fold);
+            rep.vw_fold = remap(new_edges, rep.vw_fold);
+        }
+
+        for (MappableListIndexIterator<MappableList<EdgeFoldRep> >
+                it(_edge_folds); !it.done(); ++it)
+        {
+            EdgeFoldRep& rep = *it;
+            rep.u_fold = remap(new_nodes, rep.u_fold);
+            rep.v_fold = remap(new_nodes, rep.v_fold);
+            rep.reduced_fold = remap(new_nodes, rep.reduced_fold);
+        }
+
+        for (NodeIterator<GraphType> it(_graph); !it.done(); ++it) {
+            _node_to_fold[it.node()] = remap(new_nodes, _node_to_fold[it.node()]);
+        }
+
+        for (EdgeIterator<GraphType> it(_graph); !it.done(); ++it) {
+            _edge_to_fold[it.edge()] = remap(new_edges, _edge_to_fold[it.edge()]);
+        }
+    }
+
 
 private:
 
@@ -484,6 +850,15 @@ private:
                 (*it)->notify();
             }
         }
+
+        virtual void remap(const std::vector<Index>& new_identifiers) const
+        {
+            for (FoldObservers::const_iterator it = _observers.begin();
+                    it != _observers.end(); ++it)
+            {
+                (*it)->remap(new_identifiers);
+            }
+        }
     };
 
     MasterFoldObserver<NodeFoldRep> _master_node_fold_observer;
@@ -497,6 +872,14 @@ private:
                 uv_fold_rep.v_fold : uv_fold_rep.u_fold;
     }
 
+    static NodeFold remap(const std::vector<Index>& new_nodes, NodeFold nf) {
+        return nf._index == -1 ? nf : NodeFold(new_nodes[nf._index]);
+    }
+
+    static EdgeFold remap(const std::vector<Index>& new_edges, EdgeFold ef) {
+        return ef._index == -1 ? ef : EdgeFold(new_edges[ef._index]);
+    }
+
     Node restoreNode(NodeFold v_fold)
     {
         Node v = _graph.addNode();
@@ -557,6 +940,19 @@ public:
         _values.resize(_graph.getMaxNodeFoldIdentifier());
     }
 
+    void remap(const std::vector<Index>& new_identifiers)
+    {
+        // compaction only moves folds down, so this is done in place
+        for (size_t i=0; i<new_identifiers.size(); ++i)
+        {
+            if (new_identifiers[i] != -1 && (size_t) new_identifiers[i] != i) {
+                _values[new_identifiers[i]] = _values[i];
+            }
+        }
+
+        _values.resize(_graph.getMaxNodeFoldIdentifier());
+    }
+
     typename std::vector<ValueType>::reference
     operator[](typename NodeFoldObservable::NodeFold node_fold)
     {
@@ -602,6 +998,19 @@ public:
         _values.resize(_graph.getMaxEdgeFoldIdentifier());
     }
 
+    void remap(const std::vector<Index>& new_identifiers)
+    {
+        // compaction only moves folds down, so this is done in place
+        for (size_t i=0; i<new_identifiers.size(); ++i)
+        {
+            if (new_identifiers[i] != -1 && (size_t) new_identifiers[i] != i) {
+                _values[new_identifiers[i]] = _values[i];
+            }
+        }
+
+        _values.resize(_graph.getMaxEdgeFoldIdentifier());
+    }
+
     typename std::vector<ValueType>::reference
     operator[](typename EdgeFoldObservable::EdgeFold edge_fold)
     {
@@ -651,18 +1060,58 @@ public:
     typedef FoldTree::EdgeFold EdgeFold;
 
     /// \brief A set of node members.
+    /*!
+     *  The members of a folded node or edge are those of the contour tree
+     *  node or edge, followed by the members of everything folded into it,
+     *  which are kept as a list of nested member sets. Once flattened, the
+     *  members are also copied into one contiguous array, which is iterated
+     *  instead until the set is next changed by a fold.
+     */
     class Members
     {
         template <typename T> friend class FoldedContourTree;
 
         typedef boost::shared_ptr<Members> MembersPtr;
+        typedef typename ContourTree::Member Member;
 
         size_t _size;
         const typename ContourTree::Members* _ct_members;
         std::list<MembersPtr> _nested_members;
 
+        std::vector<Member> _flat_members;
+        bool _is_flat;
+
+        // the total weight of the members, which is current if its
+        // generation is the tree's weight generation
+        mutable double _weight;
+        mutable unsigned int _weight_generation;
+
         Members(const typename ContourTree::Members* ctm) :
-                _size(ctm->size()), _ct_members(ctm) {}
+                _size(ctm->size()), _ct_members(ctm), _is_flat(false),
+                _weight(0), _weight_generation(0) {}
+
+        /// \brief Copies the members into the contiguous array. If nothing
+        /// has been folded in, the members are already contiguous.
+        void flatten()
+        {
+            if (_is_flat || _nested_members.empty()) return;
+
+            std::vector<Member> flat_members;
+            flat_members.reserve(_size);
+            for (const_iterator it = begin(); it != end(); ++it) {
+                flat_members.push_back(*it);
+            }
+
+            _flat_members.swap(flat_members);
+            _is_flat = true;
+        }
+
+        /// \brief Discards the contiguous array, as the members have changed.
+        void unflatten()
+        {
+            std::vector<Member>().swap(_flat_members);
+            _is_flat = false;
+        }
 
     public:
         class const_iterator
@@ -675,8 +1124,10 @@ public:
             typename ContourTree::Members::const_iterator _ct_member_it;
             typename std::list<MembersPtr>::const_iterator _folded_list_it;
             boost::shared_ptr<const_iterator> _folded_member_it;
+            size_t _flat_index;
 
-            const_iterator(const Members* members) : _members(members) {}
+            const_iterator(const Members* members) :
+                    _members(members), _flat_index(0) {}
 
             /// \brief Advance the list and make the _folded_member_it valid, if possible.
             void advanceList()
@@ -702,6 +1153,10 @@ public:
                     return false;
                 }
 
+                if (_members->_is_flat) {
+                    return _flat_index == rhs._flat_index;
+                }
+
                 if (_members->_ct_members) {
                     if (_ct_member_it != rhs._ct_member_it) {
                         return false;
@@ -728,6 +1183,12 @@ public:
             /// \brief Advances the iterator until the end or a valid entry is met.
             void operator++() 
             {
+                if (_members->_is_flat)
+                {
+                    ++_flat_index;
+                    return;
+                }
+
                 if (_members->_ct_members)
                 {
                     if (_ct_member_it != _members->_ct_members->end())
@@ -748,6 +1209,10 @@ public:
 
             const Member& operator*() const 
             {
+                if (_members->_is_flat) {
+                    return _members->_flat_members[_flat_index];
+                }
+
                 if (_members->_ct_members)
                 {
                     if (_ct_member_it != _members->_ct_members->end())
@@ -760,19 +1225,34 @@ public:
                 return **_folded_member_it;
             }
 
+            const Member* operator->() const {
+                return &**this;
+            }
+
         };
         friend class const_iterator;
 
         Members() : 
-                _size(0), _ct_members(0) {}
+                _size(0), _ct_members(0), _is_flat(false),
+                _weight(0), _weight_generation(0) {}
 
         size_t size() const {
             return _size;
         }
 
+        /// \brief Returns true if the members have been copied into a
+        /// contiguous array.
+        bool isFlat() const {
+            return _is_flat;
+        }
+
         const_iterator begin() const {
             const_iterator it(this);
 
+            if (_is_flat) {
+                return it;
+            }
+
             if (_ct_members)
             {
                 it._ct_member_it = (_ct_members->begin());
@@ -792,6 +1272,12 @@ public:
         {
             const_iterator it(this);
 
+            if (_is_flat)
+            {
+                it._flat_index = _flat_members.size();
+                return it;
+            }
+
             if (_ct_members)
             {
                 it._ct_member_it = (_ct_members->end());
@@ -831,6 +1317,34 @@ private:
     ObservingNodeFoldMap<FoldTree, boost::shared_ptr<Members> > _node_members;
     ObservingEdgeFoldMap<FoldTree, boost::shared_ptr<Members> > _edge_members;
 
+    // the number of visible neighbors above and below each node, kept up to
+    // date by every fold so that degree queries don't scan the neighbors
+    ObservingNodeFoldMap<FoldTree, unsigned int> _up_degree;
+    ObservingNodeFoldMap<FoldTree, unsigned int> _down_degree;
+
+    // the weight of the members on either side of an edge fold, counting
+    // everything folded away. Folding only moves members within one side,
+    // so these never change: they are computed once for the contour tree's
+    // edges, and for an edge made by a reduction, from the edges it replaced
+    struct SubtreeWeights
+    {
+        double u_side;
+        double v_side;
+        unsigned int generation;
+
+        SubtreeWeights() : u_side(0), v_side(0), generation(0) {}
+    };
+
+    const WeightMap* _weight_map;
+
+    // the weights of reduced edges computed before the last setWeightMap
+    // have an older generation, and are recomputed when next needed
+    unsigned int _weights_generation;
+
+    StaticEdgeMap<ContourTree, SubtreeWeights> _ct_subtree_weights;
+    mutable ObservingEdgeFoldMap<FoldTree, SubtreeWeights>
+            _reduced_subtree_weights;
+
     typename ContourTree::Node getContourTreeNode(Node node) const {
         return _fold_to_ct_node[_fold_tree.getNodeFold(node)];
     }
@@ -839,6 +1353,201 @@ private:
         return _fold_to_ct_edge[_fold_tree.getEdgeFold(edge)];
     }
 
+    /// \brief Returns true if u is below v, breaking ties by ID.
+    bool foldLess(NodeFold u, NodeFold v) const
+    {
+        typename ContourTree::Node ct_u = _fold_to_ct_node[u];
+        typename ContourTree::Node ct_v = _fold_to_ct_node[v];
+
+        double u_value = _contour_tree.getValue(ct_u);
+        double v_value = _contour_tree.getValue(ct_v);
+
+        if (u_value != v_value) {
+            return u_value < v_value;
+        }
+
+        return _contour_tree.getID(ct_u) < _contour_tree.getID(ct_v);
+    }
+
+    double lookupWeight(Identifier id) const
+    {
+        WeightMap::const_iterator it = _weight_map->find(id);
+        return it == _weight_map->end() ? 1 : it->second;
+    }
+
+    template <typename MemberSet>
+    double sumMemberWeights(const MemberSet& members) const
+    {
+        if (!_weight_map) return members.size();
+
+        double weight = 0;
+        for (typename MemberSet::const_iterator it = members.begin();
+                it != members.end(); ++it)
+        {
+            weight += lookupWeight((*it).getID());
+        }
+        return weight;
+    }
+
+    bool hasMemberWeight(const Members& members) const {
+        return members._weight_generation == _weights_generation;
+    }
+
+    /// \brief The cached weight of the members, summing them only if a
+    /// fold or a new weight map has made the cache stale.
+    double memberWeight(const Members& members) const
+    {
+        if (!hasMemberWeight(members))
+        {
+            members._weight = sumMemberWeights(members);
+            members._weight_generation = _weights_generation;
+        }
+        return members._weight;
+    }
+
+    /// \brief Computes the subtree weights of the contour tree's edges.
+    void computeSubtreeWeights()
+    {
+        typedef typename ContourTree::Node CTNode;
+        typedef typename ContourTree::Edge CTEdge;
+
+        StaticNodeMap<ContourTree, double> subtree_weight(_contour_tree, 0.);
+        StaticNodeBitMap<ContourTree> visited(_contour_tree, false);
+
+        std::vector<CTNode> stack;
+        std::vector<std::pair<CTNode, CTEdge> > discovered;
+        std::vector<double> edge_weights;
+
+        for (NodeIterator<ContourTree> it(_contour_tree); !it.done(); ++it)
+        {
+            if (visited[it.node()]) continue;
+
+            // find the component, recording each node with the edge to the
+            // node it was discovered from
+            discovered.clear();
+            edge_weights.clear();
+            visited[it.node()] = true;
+            stack.push_back(it.node());
+
+            while (!stack.empty())
+            {
+                CTNode node = stack.back();
+                stack.pop_back();
+
+                subtree_weight[node] = sumMemberWeights(
+                        _contour_tree.getNodeMembers(node));
+
+                for (UndirectedNeighborIterator<ContourTree>
+                        nit(_contour_tree, node); !nit.done(); ++nit)
+                {
+                    if (visited[nit.neighbor()]) continue;
+                    visited[nit.neighbor()] = true;
+                    stack.push_back(nit.neighbor());
+                    discovered.push_back(std::make_pair(nit.neighbor(), nit.edge()));
+                    edge_weights.push_back(sumMemberWeights(
+                            _contour_tree.getEdgeMembers(nit.edge())));
+                }
+            }
+
+            // a node is discovered after its parent, so in reverse order
+            // every subtree is complete before it is added to its parent
+            for (size_t i=discovered.size(); i-- > 0;)
+            {
+                CTNode child = discovered[i].first;
+                CTNode parent = _contour_tree.opposite(child, discovered[i].second);
+                subtree_weight[parent] += edge_weights[i] + subtree_weight[child];
+            }
+
+            double total_weight = subtree_weight[it.node()];
+
+            for (size_t i=0; i<discovered.size(); ++i)
+            {
+                CTNode child = discovered[i].first;
+                CTEdge edge = discovered[i].second;
+
+                double child_side = subtree_weight[child];
+                double parent_side = total_weight - child_side - edge_weights[i];
+
+                SubtreeWeights& weights = _ct_subtree_weights[edge];
+                bool child_is_u = _contour_tree.u(edge) == child;
+                weights.u_side = child_is_u ? child_side : parent_side;
+                weights.v_side = child_is_u ? parent_side : child_side;
+            }
+        }
+    }
+
+    /// \brief The weight on the node's side of the edge fold, which must be
+    /// computed.
+    double sideWeight(EdgeFold edge_fold, NodeFold node_fold) const
+    {
+        const SubtreeWeights& weights = getSubtreeWeights(edge_fold);
+        return _fold_tree.uFold(edge_fold) == node_fold ?
+                weights.u_side : weights.v_side;
+    }
+
+    bool hasSubtreeWeights(EdgeFold edge_fold) const
+    {
+        return !_fold_tree.hasReduced(edge_fold) ||
+                _reduced_subtree_weights[edge_fold].generation ==
+                _weights_generation;
+    }
+
+    /// \brief Computes the weights of a reduced edge from those of the two
+    /// edges it replaced, which must be computed.
+    void joinSubtreeWeights(EdgeFold uw_fold) const
+    {
+        NodeFold v_fold = _fold_tree.reducedFold(uw_fold);
+
+        SubtreeWeights& weights = _reduced_subtree_weights[uw_fold];
+        weights.u_side = sideWeight(_fold_tree.uvFold(v_fold), _fold_tree.uFold(uw_fold));
+        weights.v_side = sideWeight(_fold_tree.vwFold(v_fold), _fold_tree.vFold(uw_fold));
+        weights.generation = _weights_generation;
+    }
+
+    const SubtreeWeights& getSubtreeWeights(EdgeFold edge_fold) const
+    {
+        if (!_fold_tree.hasReduced(edge_fold)) {
+            return _ct_subtree_weights[_fold_to_ct_edge[edge_fold]];
+        }
+
+        // reductions may be nested deeply, so the edges they replaced are
+        // computed with an explicit stack
+        std::vector<EdgeFold> stack(1, edge_fold);
+        while (!stack.empty())
+        {
+            EdgeFold uw_fold = stack.back();
+            if (hasSubtreeWeights(uw_fold)) {
+                stack.pop_back();
+                continue;
+            }
+
+            NodeFold v_fold = _fold_tree.reducedFold(uw_fold);
+            EdgeFold uv_fold = _fold_tree.uvFold(v_fold);
+            EdgeFold vw_fold = _fold_tree.vwFold(v_fold);
+
+            if (!hasSubtreeWeights(uv_fold)) {
+                stack.push_back(uv_fold);
+            } else if (!hasSubtreeWeights(vw_fold)) {
+                stack.push_back(vw_fold);
+            } else {
+                joinSubtreeWeights(uw_fold);
+                stack.pop_back();
+            }
+        }
+
+        return _reduced_subtree_weights[edge_fold];
+    }
+
+    /// \brief Counts (or with delta -1, uncounts) the neighbor of the node.
+    void countNeighbor(NodeFold node, NodeFold neighbor, int delta)
+    {
+        if (foldLess(node, neighbor)) {
+            _up_degree[node] += delta;
+        } else {
+            _down_degree[node] += delta;
+        }
+    }
+
 public:
 
     typedef typename ContourTree::Member Member;
@@ -847,7 +1556,11 @@ public:
             Mixin(_fold_tree), _contour_tree(contour_tree),
             _ct_to_fold_node(_contour_tree),
             _fold_to_ct_node(_fold_tree), _fold_to_ct_edge(_fold_tree),
-            _node_members(_fold_tree), _edge_members(_fold_tree)
+            _node_members(_fold_tree), _edge_members(_fold_tree),
+            _up_degree(_fold_tree), _down_degree(_fold_tree),
+            _weight_map(0), _weights_generation(0),
+            _ct_subtree_weights(contour_tree),
+            _reduced_subtree_weights(_fold_tree)
     {
         // we need to initialize the fold tree with the structure of the contour
         // tree. We also want to map the folds to their corresponding nodes and 
@@ -898,7 +1611,12 @@ public:
             // set the edge's members to be the CT edge's members
             const ContourTreeMembers* ctm = &_contour_tree.getEdgeMembers(it.edge());
             _edge_members[edge_fold] = MembersPtr(new Members(ctm));
+
+            countNeighbor(u_fold, v_fold, 1);
+            countNeighbor(v_fold, u_fold, 1);
         }
+
+        setWeightMap(0);
     }
 
     /// \brief Retrieve the node's scalar value.
@@ -907,12 +1625,12 @@ public:
     }
 
     /// \brief Get the ID of a node.
-    unsigned int getID(Node node) const {
+    Identifier getID(Node node) const {
         return _contour_tree.getID(getContourTreeNode(node));
     }
 
     /// \brief Retrieve a node by ID.
-    Node getNode(unsigned int id) const
+    Node getNode(Identifier id) const
     {
         typename ContourTree::Node node = _contour_tree.getNode(id);
 
@@ -943,17 +1661,33 @@ public:
         // get the base's members
         MembersPtr base_members = _node_members[base_fold];
 
-        // add the leaf members and collapsed edge members to the base node's members
+        // add the leaf members and collapsed edge members to the base node's members.
+        // they are only iterated through the base from now on, so their
+        // contiguous copies are discarded
         NodeFold leaf_fold = _fold_tree.getNodeFold(leaf);
         MembersPtr leaf_members = _node_members[leaf_fold];
+        leaf_members->unflatten();
         base_members->_nested_members.push_back(leaf_members);
 
         EdgeFold edge_fold = _fold_tree.getEdgeFold(edge);
         MembersPtr edge_members = _edge_members[edge_fold];
+        edge_members->unflatten();
         base_members->_nested_members.push_back(edge_members);
 
         // update the size of the node's members
         base_members->_size += leaf_members->_size + edge_members->_size;
+        base_members->unflatten();
+
+        if (hasMemberWeight(*base_members) && hasMemberWeight(*leaf_members) &&
+                hasMemberWeight(*edge_members)) {
+            base_members->_weight += leaf_members->_weight + edge_members->_weight;
+        } else {
+            base_members->_weight_generation = 0;
+        }
+
+        // the leaf keeps its counts, as it has the same single neighbor
+        // whenever it is visible
+        countNeighbor(base_fold, leaf_fold, -1);
 
         // collapse the edge.
         _fold_tree.collapse(edge);
@@ -971,6 +1705,15 @@ public:
         MembersPtr uv_members = _edge_members[_fold_tree.getEdgeFold(uv)];
         MembersPtr vw_members = _edge_members[_fold_tree.getEdgeFold(vw)];
 
+        // u and w trade v for each other as neighbors
+        NodeFold v_fold = _fold_tree.getNodeFold(v);
+        NodeFold u_fold = _fold_tree.getNodeFold(_fold_tree.opposite(v, uv));
+        NodeFold w_fold = _fold_tree.getNodeFold(_fold_tree.opposite(v, vw));
+        countNeighbor(u_fold, v_fold, -1);
+        countNeighbor(u_fold, w_fold, 1);
+        countNeighbor(w_fold, v_fold, -1);
+        countNeighbor(w_fold, u_fold, 1);
+
         // make the new edge
         Edge uw = _fold_tree.reduce(v);
 
@@ -978,15 +1721,44 @@ public:
         MembersPtr uw_members = MembersPtr(new Members());
         _edge_members[_fold_tree.getEdgeFold(uw)] = uw_members;
 
+        // the nested sets are only iterated through the new edge, so their
+        // contiguous copies are discarded
+        v_members->unflatten();
+        uv_members->unflatten();
+        vw_members->unflatten();
+
         uw_members->_nested_members.push_back(v_members);
         uw_members->_nested_members.push_back(uv_members);
         uw_members->_nested_members.push_back(vw_members);
 
         uw_members->_size += v_members->_size + uv_members->_size + vw_members->_size;
 
+        if (hasMemberWeight(*v_members) && hasMemberWeight(*uv_members) &&
+                hasMemberWeight(*vw_members)) {
+            uw_members->_weight = v_members->_weight + uv_members->_weight +
+                    vw_members->_weight;
+            uw_members->_weight_generation = _weights_generation;
+        }
+
+        // the new edge may reuse the slot of a removed one, so its weights
+        // are always recomputed
+        EdgeFold uw_fold = _fold_tree.getEdgeFold(uw);
+        _reduced_subtree_weights[uw_fold].generation = 0;
+        getSubtreeWeights(uw_fold);
+
         return uw;
     }
 
+    /// \brief Returns the fold of a visible node.
+    NodeFold getNodeFold(Node node) const {
+        return _fold_tree.getNodeFold(node);
+    }
+
+    /// \brief Returns the fold of a visible edge.
+    EdgeFold getEdgeFold(Edge edge) const {
+        return _fold_tree.getEdgeFold(edge);
+    }
+
     /// \brief Returns the number of edges contained within the node.
     int numberOfCollapsedEdgeFolds(NodeFold node_fold) const {
         return _fold_tree.numberOfCollapsedEdgeFolds(node_fold);
@@ -1055,13 +1827,36 @@ public:
         MembersPtr edge_members = _edge_members[_fold_tree.getEdgeFold(edge)];
         MembersPtr v_members = _node_members[_fold_tree.getNodeFold(v)];
 
-        // now remove these from u's nested members
+        // now remove these from u's nested members. the most recent collapse
+        // pushed them to the back of the list, so undoing it is cheap
         MembersPtr u_members = _node_members[_fold_tree.getNodeFold(u)];
-        u_members->_nested_members.remove(v_members);
-        u_members->_nested_members.remove(edge_members);
+        std::list<MembersPtr>& nested = u_members->_nested_members;
+        if (!nested.empty() && nested.back() == edge_members) {
+            nested.pop_back();
+        } else {
+            nested.remove(edge_members);
+        }
+
+        if (!nested.empty() && nested.back() == v_members) {
+            nested.pop_back();
+        } else {
+            nested.remove(v_members);
+        }
 
         // and decrease the size by the appropriate amount
         u_members->_size -= v_members->_size + edge_members->_size;
+        u_members->unflatten();
+
+        // once nothing is folded in, the weight is resummed rather than
+        // left with the rounding of the additions and subtractions
+        if (!nested.empty() && hasMemberWeight(*u_members) &&
+                hasMemberWeight(*v_members) && hasMemberWeight(*edge_members)) {
+            u_members->_weight -= v_members->_weight + edge_members->_weight;
+        } else {
+            u_members->_weight_generation = 0;
+        }
+
+        countNeighbor(_fold_tree.getNodeFold(u), _fold_tree.getNodeFold(v), 1);
 
         return edge;
     }
@@ -1069,7 +1864,30 @@ public:
     /// \brief Unreduces the edge.
     Node unreduce(Edge uw)
     {
-        return _fold_tree.unreduce(uw); 
+        NodeFold u_fold = _fold_tree.getNodeFold(_fold_tree.u(uw));
+        NodeFold w_fold = _fold_tree.getNodeFold(_fold_tree.v(uw));
+
+        Node v = _fold_tree.unreduce(uw); 
+
+        NodeFold v_fold = _fold_tree.getNodeFold(v);
+        countNeighbor(u_fold, w_fold, -1);
+        countNeighbor(u_fold, v_fold, 1);
+        countNeighbor(w_fold, u_fold, -1);
+        countNeighbor(w_fold, v_fold, 1);
+
+        return v;
+    }
+
+    /// \brief The number of neighbors of the node with a greater value,
+    /// breaking ties by ID.
+    unsigned int upDegree(Node node) const {
+        return _up_degree[_fold_tree.getNodeFold(node)];
+    }
+
+    /// \brief The number of neighbors of the node with a lesser value,
+    /// breaking ties by ID.
+    unsigned int downDegree(Node node) const {
+        return _down_degree[_fold_tree.getNodeFold(node)];
     }
 
     /// \brief Retrieves the members contained within the node.
@@ -1082,6 +1900,84 @@ public:
         return *_edge_members[_fold_tree.getEdgeFold(edge)];
     }
 
+    /// \brief Stores the node's members contiguously, so that iterating
+    /// over them is fast. The copy is discarded when the node is next
+    /// folded. Like the cached weights, the copy is not part of the tree's
+    /// state, so this may be called on a const tree.
+    void flattenMembers(Node node) const {
+        _node_members[_fold_tree.getNodeFold(node)]->flatten();
+    }
+
+    /// \brief Stores the edge's members contiguously. Since folding never
+    /// changes a visible edge's members, the copy is kept until the edge is
+    /// removed.
+    void flattenMembers(Edge edge) const {
+        _edge_members[_fold_tree.getEdgeFold(edge)]->flatten();
+    }
+
+    /// \brief Stores the members of every visible node and edge
+    /// contiguously.
+    void flattenMembers() const
+    {
+        for (NodeIterator<FoldedContourTree> it(*this); !it.done(); ++it) {
+            flattenMembers(it.node());
+        }
+
+        for (EdgeIterator<FoldedContourTree> it(*this); !it.done(); ++it) {
+            flattenMembers(it.edge());
+        }
+    }
+
+    /// \brief Sets the weights of the members, which are otherwise one.
+    /*!
+     *  Members missing from the map have weight one, as in LandscapeWeights.
+     *  The map is not copied, and must outlive its use by the tree. This
+     *  recomputes the subtree weights, taking time linear in the number of
+     *  members, and discards the cached node and edge weights, so the map
+     *  must be set again whenever its contents change.
+     */
+    void setWeightMap(const WeightMap* weight_map)
+    {
+        _weight_map = weight_map;
+        ++_weights_generation;
+        computeSubtreeWeights();
+    }
+
+    /// \brief The map of member weights, or null if every member has
+    /// weight one.
+    const WeightMap* getWeightMap() const {
+        return _weight_map;
+    }
+
+    /// \brief The total weight of the node's members.
+    /*!
+     *  The weight is cached with the node's members. A fold updates the
+     *  cached weights of the folds it joins or splits, so the members are
+     *  only summed again after setWeightMap, or when a fold met an
+     *  uncached weight.
+     */
+    double getNodeWeight(Node node) const {
+        return memberWeight(getNodeMembers(node));
+    }
+
+    /// \brief The total weight of the edge's members, cached as for nodes.
+    double getEdgeWeight(Edge edge) const {
+        return memberWeight(getEdgeMembers(edge));
+    }
+
+    /// \brief The total weight of the members on the node's side of the edge.
+    /*!
+     *  This counts the node and every member folded into the nodes and edges
+     *  on its side, but not the edge's own members. Folding never moves a
+     *  member across an edge, so this is kept without resumming members:
+     *  after a fold, it takes constant time.
+     */
+    double getSubtreeWeight(Edge edge, Node node) const
+    {
+        return sideWeight(_fold_tree.getEdgeFold(edge),
+                          _fold_tree.getNodeFold(node));
+    }
+
     /// \brief Returns true if the edge has a reduced node within.
     bool hasReduced(Edge edge) const {
         return hasReduced(_fold_tree.getEdgeFold(edge));
@@ -1092,6 +1988,224 @@ public:
         return numberOfCollapsedEdgeFolds(_fold_tree.getNodeFold(node)) > 0;
     }
 
+    /// \brief Makes room for restoring nodes and edges. See FoldTree.
+    void reserve(size_t nodes, size_t edges) {
+        _fold_tree.reserve(nodes, edges);
+    }
+
+    /// \brief Defers observer notifications. See FoldTree.
+    void holdNotifications() {
+        _fold_tree.holdNotifications();
+    }
+
+    /// \brief Fires the deferred observer notifications.
+    void releaseNotifications() {
+        _fold_tree.releaseNotifications();
+    }
+
+    /// \brief Reclaims the storage of removed folds. See FoldTree.
+    void compactFolds() {
+        _fold_tree.compactFolds();
+    }
+
+    /// \brief The number of edge fold slots, including those of removed
+    /// folds which have not been reclaimed.
+    size_t getMaxEdgeFoldIdentifier() const {
+        return _fold_tree.getMaxEdgeFoldIdentifier();
+    }
+
+    /// \brief The number of edge folds in use.
+    size_t numberOfEdgeFolds() const {
+        return _fold_tree.numberOfEdgeFolds();
+    }
+
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Member intervals
+//
+////////////////////////////////////////////////////////////////////////////////
+
+/// \brief Numbers the members of a contour tree in depth-first order.
+/// \ingroup fold_tree
+/*!
+ *  Starting from the root, the members of each node are numbered, then for
+ *  each child the members of the edge leading to it, followed by the
+ *  subtree below it. The members of any subtree, and so of any branch
+ *  collapsed towards the root, then have consecutive ranks, and a
+ *  MemberIntervals built with this renumbering stores them as a single
+ *  range.
+ */
+template <typename ContourTree>
+class MemberRenumbering
+{
+    typedef typename ContourTree::Node Node;
+    typedef typename ContourTree::Edge Edge;
+    typedef typename ContourTree::Members Members;
+
+    boost::unordered_map<Identifier, Identifier> _ranks;
+    std::vector<Identifier> _ids;
+
+    void number(const Members& members)
+    {
+        for (typename Members::const_iterator it = members.begin();
+                it != members.end(); ++it)
+        {
+            _ranks[(*it).getID()] = _ids.size();
+            _ids.push_back((*it).getID());
+        }
+    }
+
+public:
+    MemberRenumbering(const ContourTree& tree, Node root)
+    {
+        number(tree.getNodeMembers(root));
+
+        // an explicit stack of (edge, child) pairs, as trees may be deep
+        std::vector<std::pair<Edge, Node> > stack;
+        for (UndirectedNeighborIterator<ContourTree> it(tree, root);
+                !it.done(); ++it)
+        {
+            stack.push_back(std::make_pair(it.edge(), it.neighbor()));
+        }
+
+        while (!stack.empty())
+        {
+            Edge edge = stack.back().first;
+            Node node = stack.back().second;
+            stack.pop_back();
+
+            number(tree.getEdgeMembers(edge));
+            number(tree.getNodeMembers(node));
+
+            for (UndirectedNeighborIterator<ContourTree> it(tree, node);
+                    !it.done(); ++it)
+            {
+                if (it.edge() != edge) {
+                    stack.push_back(std::make_pair(it.edge(), it.neighbor()));
+                }
+            }
+        }
+    }
+
+    /// \brief The number of members renumbered.
+    size_t size() const {
+        return _ids.size();
+    }
+
+    /// \brief The new number of the member with the ID.
+    Identifier getRank(Identifier id) const
+    {
+        boost::unordered_map<Identifier, Identifier>::const_iterator it =
+                _ranks.find(id);
+
+        if (it == _ranks.end()) {
+            throw std::runtime_error("The member is not in the contour tree.");
+        }
+        return it->second;
+    }
+
+    /// \brief The ID of the member with the new number.
+    Identifier getID(Identifier rank) const {
+        return _ids[rank];
+    }
+};
+
+
+/// \brief A set of member IDs stored as sorted, disjoint ranges.
+/// \ingroup fold_tree
+/*!
+ *  A folded node or edge may hold a great many members. When their IDs are
+ *  mostly consecutive, as they are after a MemberRenumbering, storing the
+ *  ranges takes far less space than the members themselves, and membership
+ *  is tested by a binary search.
+ */
+class MemberIntervals
+{
+    // inclusive [first, last] ranges, in increasing order
+    std::vector<std::pair<Identifier, Identifier> > _intervals;
+    size_t _size;
+
+    void encode(std::vector<Identifier>& ids)
+    {
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+        _size = ids.size();
+        for (size_t i=0; i<ids.size(); ++i)
+        {
+            if (!_intervals.empty() && _intervals.back().second + 1 == ids[i]) {
+                _intervals.back().second = ids[i];
+            } else {
+                _intervals.push_back(std::make_pair(ids[i], ids[i]));
+            }
+        }
+    }
+
+public:
+    MemberIntervals() : _size(0) {}
+
+    /// \brief Encodes the IDs of the members.
+    template <typename Members>
+    explicit MemberIntervals(const Members& members) : _size(0)
+    {
+        std::vector<Identifier> ids;
+        ids.reserve(members.size());
+        for (typename Members::const_iterator it = members.begin();
+                it != members.end(); ++it)
+        {
+            ids.push_back((*it).getID());
+        }
+        encode(ids);
+    }
+
+    /// \brief Encodes the ranks of the members under the renumbering.
+    template <typename Members, typename Renumbering>
+    MemberIntervals(const Members& members, const Renumbering& renumbering)
+        : _size(0)
+    {
+        std::vector<Identifier> ids;
+        ids.reserve(members.size());
+        for (typename Members::const_iterator it = members.begin();
+                it != members.end(); ++it)
+        {
+            ids.push_back(renumbering.getRank((*it).getID()));
+        }
+        encode(ids);
+    }
+
+    /// \brief The number of distinct IDs in the set.
+    size_t size() const {
+        return _size;
+    }
+
+    size_t numberOfIntervals() const {
+        return _intervals.size();
+    }
+
+    /// \brief The first ID in the ith range.
+    Identifier getFirst(size_t i) const {
+        return _intervals[i].first;
+    }
+
+    /// \brief The last ID in the ith range, inclusive.
+    Identifier getLast(size_t i) const {
+        return _intervals[i].second;
+    }
+
+    bool contains(Identifier id) const
+    {
+        // find the first range starting after the ID
+        std::vector<std::pair<Identifier, Identifier> >::const_iterator it =
+                std::upper_bound(_intervals.begin(), _intervals.end(),
+                        std::make_pair(id, std::numeric_limits<Identifier>::max()));
+
+        if (it == _intervals.begin()) return false;
+        --it;
+        return id <= it->second;
+    }
 };
 
 
@@ -0,0 +1,662 @@
+// Copyright (c) 2014, Justin Eldridge, Mikhail Belkin, and Yusu Wang
+// at The Ohio State University. All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef DENALI_GRAPH_ALGORITHMS_H
+#define DENALI_GRAPH_ALGORITHMS_H
+
+#include <algorithm>
+#include <vector>
+
+#include <denali/identifiers.h>
+#include <denali/parallel.h>
+
+/// \file
+/// \brief Parallel algorithms on generic graphs.
+/*!
+ *  The algorithms in this file operate on any type conforming to
+ *  concepts::ReadableUndirectedGraph together with the node and edge
+ *  mappable concepts. They access the graph only through const methods,
+ *  so they may be run concurrently on the same graph.
+ */
+
+namespace denali {
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// ConcurrentDisjointSets
+//
+////////////////////////////////////////////////////////////////////////////////
+
+/// \brief A disjoint set forest supporting concurrent unions.
+/// \ingroup graph_implementations_algorithms
+/*!
+ *  The elements are the integers 0, ..., n-1. Any number of threads may call
+ *  unite() and find() simultaneously. Roots are always linked beneath the
+ *  root with the smaller index, so that the representative of a set is its
+ *  smallest element. Paths are shortened by halving during find().
+ */
+class ConcurrentDisjointSets
+{
+    mutable std::vector<Identifier> _parent;
+
+public:
+    ConcurrentDisjointSets(size_t n = 0)
+    {
+        resize(n);
+    }
+
+    /// \brief Resets the structure to hold n singleton sets.
+    /// \pre No other thread is accessing the structure.
+    void resize(size_t n)
+    {
+        _parent.resize(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            _parent[i] = i;
+        }
+    }
+
+    /// \brief The number of elements.
+    size_t size() const
+    {
+        return _parent.size();
+    }
+
+    /// \brief Returns the representative of the set containing x.
+    Identifier find(Identifier x) const
+    {
+        for (;;)
+        {
+            Identifier p = parallel::load(_parent[x]);
+            if (p == x)
+            {
+                return x;
+            }
+
+            Identifier gp = parallel::load(_parent[p]);
+            if (p != gp)
+            {
+                parallel::compareAndSwap(_parent[x], p, gp);
+            }
+
+            x = gp;
+        }
+    }
+
+    /// \brief Merges the sets containing x and y.
+    /// Returns true if the sets were distinct.
+    bool unite(Identifier x, Identifier y)
+    {
+        for (;;)
+        {
+            x = find(x);
+            y = find(y);
+
+            if (x == y)
+            {
+                return false;
+            }
+
+            if (x > y)
+            {
+                std::swap(x, y);
+            }
+
+            // link the larger root beneath the smaller. if another thread has
+            // linked y in the meantime, the CAS fails and we try again
+            if (parallel::compareAndSwap(_parent[y], y, x))
+            {
+                return true;
+            }
+        }
+    }
+
+    /// \brief Returns true if x and y are in the same set.
+    bool connected(Identifier x, Identifier y) const
+    {
+        return find(x) == find(y);
+    }
+
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// ConnectedComponents
+//
+////////////////////////////////////////////////////////////////////////////////
+
+/// \brief Computes the connected components of an undirected graph.
+/// \ingroup graph_implementations_algorithms
+/*!
+ *  The edges of the graph are united in parallel in a
+ *  ConcurrentDisjointSets. Components are numbered 0, ..., k-1 in order of
+ *  their smallest node identifier, so the numbering does not depend on the
+ *  number of threads.
+ *
+ *  GraphType must conform to concepts::ReadableUndirectedGraph,
+ *  concepts::NodeMappable and concepts::EdgeMappable.
+ */
+template <typename GraphType>
+class ConnectedComponents
+{
+    typedef typename GraphType::Node Node;
+    typedef typename GraphType::Edge Edge;
+
+    const GraphType& _graph;
+
+    // the component of each node, indexed by node identifier
+    std::vector<Identifier> _component;
+
+    // the number of nodes in each component
+    std::vector<size_t> _sizes;
+
+public:
+    /// \brief Identifies an invalid component.
+    static const Identifier NO_COMPONENT = (Identifier) -1;
+
+    ConnectedComponents(const GraphType& graph)
+        : _graph(graph)
+    {
+        ConcurrentDisjointSets sets(graph.getMaxNodeIdentifier());
+        compute(sets);
+    }
+
+    /// \brief Labels the components from a previously computed forest.
+    /*!
+     *  The forest must contain an element for every node identifier, and
+     *  the graph's edges must already have been united. This allows the
+     *  components to be computed while the graph is being read, as is done
+     *  by the loader in fileio.h.
+     */
+    ConnectedComponents(const GraphType& graph, const ConcurrentDisjointSets& sets)
+        : _graph(graph)
+    {
+        label(sets);
+    }
+
+    /// \brief The number of connected components.
+    size_t numberOfComponents() const
+    {
+        return _sizes.size();
+    }
+
+    /// \brief The component containing the node.
+    Identifier getComponent(Node node) const
+    {
+        return _component[_graph.getNodeIdentifier(node)];
+    }
+
+    /// \brief The number of nodes in the component.
+    size_t getComponentSize(Identifier component) const
+    {
+        return _sizes[component];
+    }
+
+    /// \brief True if the graph has at most one component.
+    bool isConnected() const
+    {
+        return _sizes.size() <= 1;
+    }
+
+private:
+    void compute(ConcurrentDisjointSets& sets)
+    {
+        long n_edges = _graph.getMaxEdgeIdentifier();
+
+        #pragma omp parallel for schedule(static)
+        for (long i = 0; i < n_edges; ++i)
+        {
+            Edge edge = _graph.getEdgeFromIdentifier(i);
+            if (!_graph.isEdgeValid(edge))
+            {
+                continue;
+            }
+
+            sets.unite(
+                    _graph.getNodeIdentifier(_graph.u(edge)),
+                    _graph.getNodeIdentifier(_graph.v(edge)));
+        }
+
+        label(sets);
+    }
+
+    void label(const ConcurrentDisjointSets& sets)
+    {
+        long n_nodes = _graph.getMaxNodeIdentifier();
+        _component.resize(n_nodes);
+
+        // flatten the forest. slots which do not hold a valid node are
+        // excluded from the components
+        #pragma omp parallel for schedule(static)
+        for (long i = 0; i < n_nodes; ++i)
+        {
+            if (_graph.isNodeValid(_graph.getNodeFromIdentifier(i)))
+            {
+                _component[i] = sets.find(i);
+            }
+            else
+            {
+                _component[i] = NO_COMPONENT;
+            }
+        }
+
+        // the representative of each set is its smallest member, so it is
+        // always encountered before the rest of its set
+        _sizes.clear();
+        for (long i = 0; i < n_nodes; ++i)
+        {
+            if (_component[i] == NO_COMPONENT)
+            {
+                continue;
+            }
+
+            if (_component[i] == (Identifier) i)
+            {
+                _component[i] = _sizes.size();
+                _sizes.push_back(0);
+            }
+            else
+            {
+                _component[i] = _component[_component[i]];
+            }
+
+            _sizes[_component[i]]++;
+        }
+    }
+
+};
+
+template <typename GraphType>
+const Identifier ConnectedComponents<GraphType>::NO_COMPONENT;
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// ParallelBFS
+//
+////////////////////////////////////////////////////////////////////////////////
+
+/// \brief A level-synchronous breadth first search of an undirected graph.
+/// \ingroup graph_implementations_algorithms
+/*!
+ *  The nodes of each frontier are expanded in parallel. A node is claimed
+ *  by the first thread to reach it, so the depth of every node is
+ *  deterministic, but the BFS parent of a node may be any of its neighbors
+ *  in the previous level.
+ *
+ *  GraphType must conform to concepts::ReadableUndirectedGraph and
+ *  concepts::NodeMappable.
+ */
+template <typename GraphType>
+class ParallelBFS
+{
+    typedef typename GraphType::Node Node;
+    typedef typename GraphType::Edge Edge;
+    typedef std::vector<Identifier> Frontier;
+
+    const GraphType& _graph;
+
+    // the depth of each node, or -1 if the node was not reached
+    std::vector<Index> _depth;
+
+    // the identifier of the BFS parent of each node
+    std::vector<Identifier> _parent;
+
+    size_t _n_reached;
+    size_t _n_levels;
+
+public:
+    ParallelBFS(const GraphType& graph, Node root)
+        : _graph(graph), _depth(graph.getMaxNodeIdentifier(), -1),
+          _parent(graph.getMaxNodeIdentifier()), _n_reached(1), _n_levels(0)
+    {
+        Identifier root_id = graph.getNodeIdentifier(root);
+        _depth[root_id] = 0;
+        _parent[root_id] = root_id;
+
+        Frontier frontier(1, root_id);
+        while (!frontier.empty())
+        {
+            _n_levels++;
+            Frontier next;
+            expand(frontier, next, _n_levels);
+            _n_reached += next.size();
+            frontier.swap(next);
+        }
+    }
+
+    /// \brief True if the node is reachable from the root.
+    bool isReached(Node node) const
+    {
+        return _depth[_graph.getNodeIdentifier(node)] != -1;
+    }
+
+    /// \brief The number of edges on a shortest path from the root.
+    /// \pre The node is reached.
+    Index getDepth(Node node) const
+    {
+        return _depth[_graph.getNodeIdentifier(node)];
+    }
+
+    /// \brief The node from which this node was discovered.
+    /// \pre The node is reached. The root is its own parent.
+    Node getParent(Node node) const
+    {
+        return _graph.getNodeFromIdentifier(
+                _parent[_graph.getNodeIdentifier(node)]);
+    }
+
+    /// \brief The number of nodes reachable from the root, including the root.
+    size_t numberOfReachedNodes() const
+    {
+        return _n_reached;
+    }
+
+    /// \brief The number of distinct depths.
+    size_t numberOfLevels() const
+    {
+        return _n_levels;
+    }
+
+private:
+    void expand(const Frontier& frontier, Frontier& next, Index depth)
+    {
+        long n = frontier.size();
+
+        #pragma omp parallel
+        {
+            Frontier local;
+
+            #pragma omp for schedule(dynamic, 64)
+            for (long i = 0; i < n; ++i)
+            {
+                Node node = _graph.getNodeFromIdentifier(frontier[i]);
+                for (Edge edge = _graph.getFirstNeighborEdge(node);
+                        _graph.isEdgeValid(edge);
+                        edge = _graph.getNextNeighborEdge(node, edge))
+                {
+                    Identifier neighbor =
+                            _graph.getNodeIdentifier(_graph.opposite(node, edge));
+
+                    if (parallel::load(_depth[neighbor]) == -1 &&
+                        parallel::compareAndSwap(_depth[neighbor], (Index) -1, depth))
+                    {
+                        _parent[neighbor] = frontier[i];
+                        local.push_back(neighbor);
+                    }
+                }
+            }
+
+            #pragma omp critical (denali_bfs_frontier)
+            next.insert(next.end(), local.begin(), local.end());
+        }
+    }
+
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// EulerTourTree
+//
+////////////////////////////////////////////////////////////////////////////////
+
+/// \brief Roots a tree and computes subtree sizes using an Euler tour.
+/// \ingroup graph_implementations_algorithms
+/*!
+ *  Every edge of the tree is replaced by a pair of opposing arcs. The
+ *  successor of each arc in the Euler tour is found independently from the
+ *  rotation of the neighbor lists, and each arc is then ranked by parallel
+ *  pointer jumping. From the positions of the two arcs of an edge we obtain
+ *  the parent of each node, the size of its subtree, and its index in a
+ *  preorder traversal.
+ *
+ *  Only the component containing the root is processed. GraphType must be
+ *  acyclic, and must conform to concepts::ReadableUndirectedGraph,
+ *  concepts::NodeMappable and concepts::EdgeMappable.
+ */
+template <typename GraphType>
+class EulerTourTree
+{
+    typedef typename GraphType::Node Node;
+    typedef typename GraphType::Edge Edge;
+
+    const GraphType& _graph;
+    Node _root;
+
+    // per node identifier
+    std::vector<Identifier> _parent;
+    std::vector<size_t> _subtree_size;
+    std::vector<size_t> _preorder;
+    std::vector<char> _reached;
+
+public:
+    EulerTourTree(const GraphType& graph, Node root)
+        : _graph(graph), _root(root)
+    {
+        compute();
+    }
+
+    /// \brief The root of the tree.
+    Node getRoot() const
+    {
+        return _root;
+    }
+
+    /// \brief True if the node is in the root's component.
+    bool isReached(Node node) const
+    {
+        return _reached[_graph.getNodeIdentifier(node)] != 0;
+    }
+
+    /// \brief The parent of the node. The root is its own parent.
+    Node getParent(Node node) const
+    {
+        return _graph.getNodeFromIdentifier(
+                _parent[_graph.getNodeIdentifier(node)]);
+    }
+
+    /// \brief The number of nodes in the subtree rooted at the node.
+    size_t getSubtreeSize(Node node) const
+    {
+        return _subtree_size[_graph.getNodeIdentifier(node)];
+    }
+
+    /// \brief The position of the node in a preorder traversal from the root.
+    /*!
+     *  The nodes of any subtree occupy the contiguous range of positions
+     *  starting at the position of the subtree's root.
+     */
+    size_t getPreorderIndex(Node node) const
+    {
+        return _preorder[_graph.getNodeIdentifier(node)];
+    }
+
+private:
+    static const long END = -1;
+
+    /// The arc leaving the node along the edge.
+    long arcFrom(Node node, Edge edge) const
+    {
+        long base = 2 * (long) _graph.getEdgeIdentifier(edge);
+        return _graph.u(edge) == node ? base : base + 1;
+    }
+
+    /// The node at which the arc terminates.
+    Node head(long arc) const
+    {
+        Edge edge = _graph.getEdgeFromIdentifier(arc / 2);
+        return (arc % 2 == 0) ? _graph.v(edge) : _graph.u(edge);
+    }
+
+    void compute()
+    {
+        long n_nodes = _graph.getMaxNodeIdentifier();
+        long n_arcs = 2 * (long) _graph.getMaxEdgeIdentifier();
+
+        Identifier root_id = _graph.getNodeIdentifier(_root);
+        _parent.assign(n_nodes, 0);
+        _subtree_size.assign(n_nodes, 0);
+        _preorder.assign(n_nodes, 0);
+        _reached.assign(n_nodes, 0);
+
+        _parent[root_id] = root_id;
+        _subtree_size[root_id] = 1;
+        _reached[root_id] = 1;
+
+        Edge first_edge = _graph.getFirstNeighborEdge(_root);
+        if (!_graph.isEdgeValid(first_edge))
+        {
+            return;
+        }
+
+        long first_arc = arcFrom(_root, first_edge);
+
+        // the successor of an arc (x,y) along edge e is the arc leaving y
+        // along the edge following e in y's neighbor list
+        std::vector<long> next(n_arcs, END);
+        std::vector<long> rank(n_arcs, 0);
+
+        #pragma omp parallel for schedule(static)
+        for (long arc = 0; arc < n_arcs; ++arc)
+        {
+            Edge edge = _graph.getEdgeFromIdentifier(arc / 2);
+            if (!_graph.isEdgeValid(edge))
+            {
+                continue;
+            }
+
+            Node y = head(arc);
+            Edge successor = _graph.getNextNeighborEdge(y, edge);
+            if (!_graph.isEdgeValid(successor))
+            {
+                successor = _graph.getFirstNeighborEdge(y);
+            }
+
+            long next_arc = arcFrom(y, successor);
+
+            // break the cycle where the tour returns to the root
+            if (next_arc != first_arc)
+            {
+                next[arc] = next_arc;
+                rank[arc] = 1;
+            }
+        }
+
+        // the arcs of other components form cycles, and never reach the end.
+        // after enough rounds for the longest possible tour, they are ignored
+        long rounds = 1;
+        for (long length = 1; length < n_arcs; length *= 2)
+        {
+            rounds++;
+        }
+
+        std::vector<long> next_buffer(n_arcs);
+        std::vector<long> rank_buffer(n_arcs);
+
+        for (long round = 0; round < rounds; ++round)
+        {
+            #pragma omp parallel for schedule(static)
+            for (long arc = 0; arc < n_arcs; ++arc)
+            {
+                long successor = next[arc];
+                if (successor == END)
+                {
+                    next_buffer[arc] = END;
+                    rank_buffer[arc] = rank[arc];
+                }
+                else
+                {
+                    next_buffer[arc] = next[successor];
+                    rank_buffer[arc] = rank[arc] + rank[successor];
+                }
+            }
+
+            next.swap(next_buffer);
+            rank.swap(rank_buffer);
+        }
+
+        // the rank is now the distance to the end of the tour. convert it to
+        // a position from the start
+        long tour_length = rank[first_arc] + 1;
+
+        // an arc is a descent if it precedes its twin in the tour. mark the
+        // position of each descent, so that a prefix sum yields the preorder
+        std::vector<size_t> descents(tour_length, 0);
+
+        #pragma omp parallel for schedule(static)
+        for (long arc = 0; arc < n_arcs; arc += 2)
+        {
+            if (next[arc] != END || next[arc + 1] != END)
+            {
+                continue;
+            }
+
+            Edge edge = _graph.getEdgeFromIdentifier(arc / 2);
+            if (!_graph.isEdgeValid(edge))
+            {
+                continue;
+            }
+
+            long position = tour_length - 1 - rank[arc];
+            long twin_position = tour_length - 1 - rank[arc + 1];
+
+            long down = (position < twin_position) ? arc : arc + 1;
+            long down_position = std::min(position, twin_position);
+            long up_position = std::max(position, twin_position);
+
+            Identifier child = _graph.getNodeIdentifier(head(down));
+            Identifier parent = _graph.getNodeIdentifier(head(down ^ 1));
+
+            _parent[child] = parent;
+            _subtree_size[child] = (up_position - down_position + 1) / 2;
+            _preorder[child] = down_position;
+            _reached[child] = 1;
+            descents[down_position] = 1;
+        }
+
+        _subtree_size[root_id] = tour_length / 2 + 1;
+
+        parallel::exclusiveScan(descents);
+
+        // the root precedes the first descent in preorder
+        #pragma omp parallel for schedule(static)
+        for (long i = 0; i < n_nodes; ++i)
+        {
+            if (_reached[i] && (Identifier) i != root_id)
+            {
+                _preorder[i] = descents[_preorder[i]] + 1;
+            }
+        }
+    }
+
+};
+
+template <typename GraphType>
+const long EulerTourTree<GraphType>::END;
+
+}
+
+#endif
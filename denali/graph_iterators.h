@@ -327,7 +327,7 @@ class UndirectedBFSIterator
 
     const GraphType& _graph;
     std::queue<Visit> _bfs_queue;
-    StaticNodeMap<GraphType, bool> _visited;
+    StaticNodeBitMap<GraphType> _visited;
 
 private:
     void visit(Node node)
@@ -346,14 +346,9 @@ private:
 public:
     /// \brief Perform a full BFS, starting at the root.
     UndirectedBFSIterator(const GraphType& graph, Node root)
-        : _graph(graph), _visited(graph)
+        : _graph(graph), _visited(graph, false)
     {
-        // no nodes have been visited
-        for (NodeIterator<GraphType> node_it(graph); !node_it.done(); ++node_it) {
-            _visited[node_it.node()] = false;
-        }
-
-        // except for the root node
+        // no nodes have been visited, except for the root node
         _visited[root] = true;
 
         // now visit the children
@@ -362,14 +357,9 @@ public:
 
     /// \brief Perform a partial BFS, starting at the pivot, and stopping when the parent it reached.
     UndirectedBFSIterator(const GraphType& graph, Node parent, Node pivot)
-        : _graph(graph), _visited(graph)
+        : _graph(graph), _visited(graph, false)
     {
-        // no nodes have been visited
-        for (NodeIterator<GraphType> node_it(graph); !node_it.done(); ++node_it) {
-            _visited[node_it.node()] = false;
-        }
-
-        // except for the root node
+        // no nodes have been visited, except for the parent and pivot
         _visited[parent] = true;
         _visited[pivot] = true;
 
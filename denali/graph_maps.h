@@ -25,8 +25,16 @@
 #ifndef DENALI_GRAPH_MAPS_H
 #define DENALI_GRAPH_MAPS_H
 
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <utility>
 #include <vector>
 
+#include <boost/unordered_map.hpp>
+
+#include <denali/identifiers.h>
+
 namespace denali {
 
 /// \brief An observing node map.
@@ -37,15 +45,32 @@ namespace denali {
  *
  *  The map will resize itself whenever the watched graph grows or shrinks.
  */
-template <typename NodeObservable, typename ValueType>
+template <typename NodeObservable, typename ValueType,
+          typename Allocator = std::allocator<ValueType> >
 class ObservingNodeMap : public NodeObservable::Observer
 {
+    typedef std::vector<ValueType, Allocator> Values;
+
     NodeObservable& _graph;
-    std::vector<ValueType> _values;
+    ValueType _default;
+    Values _values;
 
 public:
     ObservingNodeMap(NodeObservable& graph)
-        : _graph(graph), _values(_graph.getMaxNodeIdentifier())
+        : _graph(graph), _default(), _values(_graph.getMaxNodeIdentifier())
+    {
+        _graph.attachNodeObserver(*this);
+    }
+
+    /// \brief Constructs a map whose slots are copies of the default value.
+    /*!
+     *  Slots added as the graph grows are also initialized to the default,
+     *  and the values are stored using the allocator.
+     */
+    ObservingNodeMap(NodeObservable& graph, const ValueType& default_value,
+            const Allocator& allocator = Allocator())
+        : _graph(graph), _default(default_value),
+          _values(_graph.getMaxNodeIdentifier(), default_value, allocator)
     {
         _graph.attachNodeObserver(*this);
     }
@@ -57,16 +82,16 @@ public:
 
     void notify()
     {
-        _values.resize(_graph.getMaxNodeIdentifier());
+        _values.resize(_graph.getMaxNodeIdentifier(), _default);
     }
 
-    typename std::vector<ValueType>::reference
+    typename Values::reference
     operator[](typename NodeObservable::Node node)
     {
         return _values[_graph.getNodeIdentifier(node)];
     }
 
-    typename std::vector<ValueType>::const_reference
+    typename Values::const_reference
     operator[](typename NodeObservable::Node node) const
     {
         return _values[_graph.getNodeIdentifier(node)];
@@ -83,15 +108,32 @@ public:
  *
  *  The map will resize itself whenever the watched graph grows or shrinks.
  */
-template <typename ArcObservable, typename ValueType>
+template <typename ArcObservable, typename ValueType,
+          typename Allocator = std::allocator<ValueType> >
 class ObservingArcMap : public ArcObservable::Observer
 {
+    typedef std::vector<ValueType, Allocator> Values;
+
     ArcObservable& _graph;
-    std::vector<ValueType> _values;
+    ValueType _default;
+    Values _values;
 
 public:
     ObservingArcMap(ArcObservable& graph)
-        : _graph(graph), _values(_graph.getMaxArcIdentifier())
+        : _graph(graph), _default(), _values(_graph.getMaxArcIdentifier())
+    {
+        _graph.attachArcObserver(*this);
+    }
+
+    /// \brief Constructs a map whose slots are copies of the default value.
+    /*!
+     *  Slots added as the graph grows are also initialized to the default,
+     *  and the values are stored using the allocator.
+     */
+    ObservingArcMap(ArcObservable& graph, const ValueType& default_value,
+            const Allocator& allocator = Allocator())
+        : _graph(graph), _default(default_value),
+          _values(_graph.getMaxArcIdentifier(), default_value, allocator)
     {
         _graph.attachArcObserver(*this);
     }
@@ -103,16 +145,16 @@ public:
 
     void notify()
     {
-        _values.resize(_graph.getMaxArcIdentifier());
+        _values.resize(_graph.getMaxArcIdentifier(), _default);
     }
 
-    typename std::vector<ValueType>::reference
+    typename Values::reference
     operator[](typename ArcObservable::Arc arc)
     {
         return _values[_graph.getArcIdentifier(arc)];
     }
 
-    typename std::vector<ValueType>::const_reference
+    typename Values::const_reference
     operator[](typename ArcObservable::Arc arc) const
     {
         return _values[_graph.getArcIdentifier(arc)];
@@ -129,15 +171,32 @@ public:
  *
  *  The map will resize itself whenever the watched graph grows or shrinks.
  */
-template <typename EdgeObservable, typename ValueType>
+template <typename EdgeObservable, typename ValueType,
+          typename Allocator = std::allocator<ValueType> >
 class ObservingEdgeMap : public EdgeObservable::Observer
 {
+    typedef std::vector<ValueType, Allocator> Values;
+
     EdgeObservable& _graph;
-    std::vector<ValueType> _values;
+    ValueType _default;
+    Values _values;
 
 public:
     ObservingEdgeMap(EdgeObservable& graph)
-        : _graph(graph), _values(_graph.getMaxEdgeIdentifier())
+        : _graph(graph), _default(), _values(_graph.getMaxEdgeIdentifier())
+    {
+        _graph.attachEdgeObserver(*this);
+    }
+
+    /// \brief Constructs a map whose slots are copies of the default value.
+    /*!
+     *  Slots added as the graph grows are also initialized to the default,
+     *  and the values are stored using the allocator.
+     */
+    ObservingEdgeMap(EdgeObservable& graph, const ValueType& default_value,
+            const Allocator& allocator = Allocator())
+        : _graph(graph), _default(default_value),
+          _values(_graph.getMaxEdgeIdentifier(), default_value, allocator)
     {
         _graph.attachEdgeObserver(*this);
     }
@@ -149,16 +208,16 @@ public:
 
     void notify()
     {
-        _values.resize(_graph.getMaxEdgeIdentifier());
+        _values.resize(_graph.getMaxEdgeIdentifier(), _default);
     }
 
-    typename std::vector<ValueType>::reference
+    typename Values::reference
     operator[](typename EdgeObservable::Edge edge)
     {
         return _values[_graph.getEdgeIdentifier(edge)];
     }
 
-    typename std::vector<ValueType>::const_reference
+    typename Values::const_reference
     operator[](typename EdgeObservable::Edge edge) const
     {
         return _values[_graph.getEdgeIdentifier(edge)];
@@ -172,27 +231,47 @@ public:
 /*!
  *  The observed graph must conform to concepts::NodeMappable
  */
-template <typename NodeMappable, typename ValueType>
+template <typename NodeMappable, typename ValueType,
+          typename Allocator = std::allocator<ValueType> >
 class StaticNodeMap
 {
+    typedef std::vector<ValueType, Allocator> Values;
+
     const NodeMappable& _graph;
-    std::vector<ValueType> _values;
+    Values _values;
 
 public:
     StaticNodeMap(const NodeMappable& graph)
         : _graph(graph), _values(_graph.getMaxNodeIdentifier()) {}
 
-    typename std::vector<ValueType>::reference
+    /// \brief Constructs a map with every slot set to the initial value.
+    StaticNodeMap(const NodeMappable& graph, const ValueType& initial_value,
+            const Allocator& allocator = Allocator())
+        : _graph(graph),
+          _values(_graph.getMaxNodeIdentifier(), initial_value, allocator) {}
+
+    typename Values::reference
     operator[](typename NodeMappable::Node node)
     {
         return _values[_graph.getNodeIdentifier(node)];
     }
 
-    typename std::vector<ValueType>::const_reference
+    typename Values::const_reference
     operator[](typename NodeMappable::Node node) const
     {
         return _values[_graph.getNodeIdentifier(node)];
     }
+    /// \brief Resizes the map to fit the graph after it has grown, setting
+    /// any new slots to the value.
+    void resize(const ValueType& value = ValueType())
+    {
+        _values.resize(_graph.getMaxNodeIdentifier(), value);
+    }
+
+    /// \brief Set every slot to the value.
+    void fill(const ValueType& value) {
+        std::fill(_values.begin(), _values.end(), value);
+    }
 };
 
 
@@ -201,27 +280,47 @@ public:
 /*!
  *  The observed graph must conform to concepts::ArcMappable
  */
-template <typename ArcMappable, typename ValueType>
+template <typename ArcMappable, typename ValueType,
+          typename Allocator = std::allocator<ValueType> >
 class StaticArcMap
 {
+    typedef std::vector<ValueType, Allocator> Values;
+
     const ArcMappable& _graph;
-    std::vector<ValueType> _values;
+    Values _values;
 
 public:
     StaticArcMap(const ArcMappable& graph)
         : _graph(graph), _values(_graph.getMaxArcIdentifier()) {}
 
-    typename std::vector<ValueType>::reference
+    /// \brief Constructs a map with every slot set to the initial value.
+    StaticArcMap(const ArcMappable& graph, const ValueType& initial_value,
+            const Allocator& allocator = Allocator())
+        : _graph(graph),
+          _values(_graph.getMaxArcIdentifier(), initial_value, allocator) {}
+
+    typename Values::reference
     operator[](typename ArcMappable::Arc arc)
     {
         return _values[_graph.getArcIdentifier(arc)];
     }
 
-    typename std::vector<ValueType>::const_reference
+    typename Values::const_reference
     operator[](typename ArcMappable::Arc arc) const
     {
         return _values[_graph.getArcIdentifier(arc)];
     }
+    /// \brief Resizes the map to fit the graph after it has grown, setting
+    /// any new slots to the value.
+    void resize(const ValueType& value = ValueType())
+    {
+        _values.resize(_graph.getMaxArcIdentifier(), value);
+    }
+
+    /// \brief Set every slot to the value.
+    void fill(const ValueType& value) {
+        std::fill(_values.begin(), _values.end(), value);
+    }
 };
 
 
@@ -230,27 +329,487 @@ public:
 /*!
  *  The observed graph must conform to concepts::EdgeMappable
  */
-template <typename EdgeMappable, typename ValueType>
+template <typename EdgeMappable, typename ValueType,
+          typename Allocator = std::allocator<ValueType> >
 class StaticEdgeMap
 {
+    typedef std::vector<ValueType, Allocator> Values;
+
     const EdgeMappable& _graph;
-    std::vector<ValueType> _values;
+    Values _values;
 
 public:
     StaticEdgeMap(const EdgeMappable& graph)
         : _graph(graph), _values(_graph.getMaxEdgeIdentifier()) {}
 
-    typename std::vector<ValueType>::reference
+    /// \brief Constructs a map with every slot set to the initial value.
+    StaticEdgeMap(const EdgeMappable& graph, const ValueType& initial_value,
+            const Allocator& allocator = Allocator())
+        : _graph(graph),
+          _values(_graph.getMaxEdgeIdentifier(), initial_value, allocator) {}
+
+    typename Values::reference
     operator[](typename EdgeMappable::Edge edge)
     {
         return _values[_graph.getEdgeIdentifier(edge)];
     }
 
-    typename std::vector<ValueType>::const_reference
+    typename Values::const_reference
     operator[](typename EdgeMappable::Edge edge) const
     {
         return _values[_graph.getEdgeIdentifier(edge)];
     }
+    /// \brief Resizes the map to fit the graph after it has grown, setting
+    /// any new slots to the value.
+    void resize(const ValueType& value = ValueType())
+    {
+        _values.resize(_graph.getMaxEdgeIdentifier(), value);
+    }
+
+    /// \brief Set every slot to the value.
+    void fill(const ValueType& value) {
+        std::fill(_values.begin(), _values.end(), value);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+//
+// Compact maps
+//
+////////////////////////////////////////////////////////////////////////////
+
+// The compact maps are written once in terms of a key policy, which says how
+// to turn a node, arc or edge into an identifier. The node, arc and edge
+// variants below only fix the policy.
+
+/// \brief Key policy for maps over the nodes of a graph.
+template <typename NodeMappable>
+struct NodeKeys
+{
+    typedef typename NodeMappable::Node Key;
+
+    static Identifier identifier(const NodeMappable& graph, Key node) {
+        return graph.getNodeIdentifier(node);
+    }
+
+    static Identifier size(const NodeMappable& graph) {
+        return graph.getMaxNodeIdentifier();
+    }
+};
+
+
+/// \brief Key policy for maps over the arcs of a graph.
+template <typename ArcMappable>
+struct ArcKeys
+{
+    typedef typename ArcMappable::Arc Key;
+
+    static Identifier identifier(const ArcMappable& graph, Key arc) {
+        return graph.getArcIdentifier(arc);
+    }
+
+    static Identifier size(const ArcMappable& graph) {
+        return graph.getMaxArcIdentifier();
+    }
+};
+
+
+/// \brief Key policy for maps over the edges of a graph.
+template <typename EdgeMappable>
+struct EdgeKeys
+{
+    typedef typename EdgeMappable::Edge Key;
+
+    static Identifier identifier(const EdgeMappable& graph, Key edge) {
+        return graph.getEdgeIdentifier(edge);
+    }
+
+    static Identifier size(const EdgeMappable& graph) {
+        return graph.getMaxEdgeIdentifier();
+    }
+};
+
+
+/// \brief A static map from keys to booleans, storing one bit per key.
+/// \ingroup graph_implementations_maps
+/*!
+ *  This uses an eighth of the memory of a map storing a bool per slot, which
+ *  makes it the natural choice for visited and protected flags in large
+ *  traversals. Since neighboring keys share a word, different threads must
+ *  not write to the same map concurrently; use a byte map for that.
+ *
+ *  The non-const operator[] returns a proxy which converts to and can be
+ *  assigned from a bool.
+ */
+template <typename Mappable, typename Keys>
+class BasicBitMap
+{
+    typedef unsigned long Word;
+    typedef std::vector<Word> Words;
+
+    static const Identifier BITS = std::numeric_limits<Word>::digits;
+
+    const Mappable& _graph;
+    Words _words;
+    Identifier _size;
+
+public:
+    typedef typename Keys::Key Key;
+
+    /// \brief A reference to a single bit of the map.
+    class Reference
+    {
+        friend class BasicBitMap;
+
+        Word& _word;
+        Word _mask;
+
+        Reference(Word& word, Word mask) : _word(word), _mask(mask) {}
+
+    public:
+        operator bool() const {
+            return (_word & _mask) != 0;
+        }
+
+        Reference& operator=(bool value)
+        {
+            if (value) {
+                _word |= _mask;
+            } else {
+                _word &= ~_mask;
+            }
+            return *this;
+        }
+
+        Reference& operator=(const Reference& other) {
+            return *this = bool(other);
+        }
+    };
+
+    BasicBitMap(const Mappable& graph, bool initial_value = false)
+        : _graph(graph),
+          _words((Keys::size(graph) + BITS - 1) / BITS,
+                 initial_value ? ~Word(0) : Word(0)),
+          _size(Keys::size(graph)) {}
+
+    Reference operator[](Key key)
+    {
+        Identifier i = Keys::identifier(_graph, key);
+        return Reference(_words[i / BITS], Word(1) << (i % BITS));
+    }
+
+    bool operator[](Key key) const
+    {
+        Identifier i = Keys::identifier(_graph, key);
+        return (_words[i / BITS] & (Word(1) << (i % BITS))) != 0;
+    }
+
+    /// \brief Set every slot to the value.
+    void fill(bool value) {
+        std::fill(_words.begin(), _words.end(), value ? ~Word(0) : Word(0));
+    }
+
+    /// \brief Resizes the map to fit the graph after it has grown, setting
+    /// any new slots to the value.
+    void resize(bool value = false)
+    {
+        Identifier size = Keys::size(_graph);
+        _words.resize((size + BITS - 1) / BITS, value ? ~Word(0) : Word(0));
+
+        // the slots past the old end of its last word are not yet set
+        for (Identifier i = _size; i < size && i % BITS != 0; ++i) {
+            Word mask = Word(1) << (i % BITS);
+            _words[i / BITS] = value ? (_words[i / BITS] | mask)
+                                     : (_words[i / BITS] & ~mask);
+        }
+        _size = size;
+    }
+};
+
+template <typename Mappable, typename Keys>
+const Identifier BasicBitMap<Mappable, Keys>::BITS;
+
+
+/// \brief A static map storing one byte per key.
+/// \ingroup graph_implementations_maps
+/*!
+ *  ValueType must be bool, or an integral or enumeration type whose values
+ *  fit in an unsigned char, such as a small state or a degree that is known
+ *  to be bounded. Each slot is its own byte, so distinct keys may be written
+ *  by different threads at the same time.
+ *
+ *  The non-const operator[] returns a proxy which converts to and can be
+ *  assigned from a ValueType.
+ */
+template <typename Mappable, typename Keys, typename ValueType = bool>
+class BasicByteMap
+{
+    typedef std::vector<unsigned char> Bytes;
+
+    const Mappable& _graph;
+    Bytes _bytes;
+
+public:
+    typedef typename Keys::Key Key;
+
+    /// \brief A reference to a single slot of the map.
+    class Reference
+    {
+        friend class BasicByteMap;
+
+        unsigned char& _byte;
+
+        Reference(unsigned char& byte) : _byte(byte) {}
+
+    public:
+        operator ValueType() const {
+            return static_cast<ValueType>(_byte);
+        }
+
+        Reference& operator=(ValueType value) {
+            _byte = static_cast<unsigned char>(value);
+            return *this;
+        }
+
+        Reference& operator=(const Reference& other) {
+            _byte = other._byte;
+            return *this;
+        }
+    };
+
+    BasicByteMap(const Mappable& graph,
+            ValueType initial_value = ValueType())
+        : _graph(graph),
+          _bytes(Keys::size(graph), static_cast<unsigned char>(initial_value))
+    {}
+
+    Reference operator[](Key key) {
+        return Reference(_bytes[Keys::identifier(_graph, key)]);
+    }
+
+    ValueType operator[](Key key) const {
+        return static_cast<ValueType>(_bytes[Keys::identifier(_graph, key)]);
+    }
+
+    /// \brief Set every slot to the value.
+    void fill(ValueType value) {
+        std::fill(_bytes.begin(), _bytes.end(),
+                  static_cast<unsigned char>(value));
+    }
+};
+
+
+/// \brief A map which only stores the keys that have been written.
+/// \ingroup graph_implementations_maps
+/*!
+ *  Reading a key that was never written gives the default value. Memory
+ *  and construction time are proportional to the number of keys written,
+ *  not to the size of the graph, so this suits maps over a small part of a
+ *  large graph. The map does not need to observe the graph: keys added
+ *  after the map was built simply read as the default.
+ *
+ *  As with std::map, the non-const operator[] inserts the default value if
+ *  the key is not yet present.
+ */
+template <typename Mappable, typename Keys, typename ValueType>
+class BasicSparseMap
+{
+    typedef boost::unordered_map<Identifier, ValueType> Values;
+
+    const Mappable& _graph;
+    ValueType _default;
+    Values _values;
+
+public:
+    typedef typename Keys::Key Key;
+
+    BasicSparseMap(const Mappable& graph,
+            const ValueType& default_value = ValueType())
+        : _graph(graph), _default(default_value) {}
+
+    ValueType& operator[](Key key)
+    {
+        Identifier i = Keys::identifier(_graph, key);
+        return _values.insert(std::make_pair(i, _default)).first->second;
+    }
+
+    const ValueType& operator[](Key key) const
+    {
+        typename Values::const_iterator it =
+                _values.find(Keys::identifier(_graph, key));
+        return it == _values.end() ? _default : it->second;
+    }
+
+    /// \brief Whether a value has been stored for the key.
+    bool contains(Key key) const {
+        return _values.count(Keys::identifier(_graph, key)) != 0;
+    }
+
+    /// \brief The number of keys with a stored value.
+    size_t size() const {
+        return _values.size();
+    }
+
+    /// \brief Forget every stored value, so that all keys read as the default.
+    void clear() {
+        _values.clear();
+    }
+};
+
+
+/// \brief A static node map storing one bit per node.
+/// \ingroup graph_implementations_maps
+/*!
+ *  The graph must conform to concepts::NodeMappable. See BasicBitMap.
+ */
+template <typename NodeMappable>
+class StaticNodeBitMap
+    : public BasicBitMap<NodeMappable, NodeKeys<NodeMappable> >
+{
+public:
+    StaticNodeBitMap(const NodeMappable& graph, bool initial_value = false)
+        : BasicBitMap<NodeMappable, NodeKeys<NodeMappable> >(graph, initial_value)
+    {}
+};
+
+
+/// \brief A static arc map storing one bit per arc.
+/// \ingroup graph_implementations_maps
+/*!
+ *  The graph must conform to concepts::ArcMappable. See BasicBitMap.
+ */
+template <typename ArcMappable>
+class StaticArcBitMap
+    : public BasicBitMap<ArcMappable, ArcKeys<ArcMappable> >
+{
+public:
+    StaticArcBitMap(const ArcMappable& graph, bool initial_value = false)
+        : BasicBitMap<ArcMappable, ArcKeys<ArcMappable> >(graph, initial_value)
+    {}
+};
+
+
+/// \brief A static edge map storing one bit per edge.
+/// \ingroup graph_implementations_maps
+/*!
+ *  The graph must conform to concepts::EdgeMappable. See BasicBitMap.
+ */
+template <typename EdgeMappable>
+class StaticEdgeBitMap
+    : public BasicBitMap<EdgeMappable, EdgeKeys<EdgeMappable> >
+{
+public:
+    StaticEdgeBitMap(const EdgeMappable& graph, bool initial_value = false)
+        : BasicBitMap<EdgeMappable, EdgeKeys<EdgeMappable> >(graph, initial_value)
+    {}
+};
+
+
+/// \brief A static node map storing one byte per node.
+/// \ingroup graph_implementations_maps
+/*!
+ *  The graph must conform to concepts::NodeMappable. See BasicByteMap.
+ */
+template <typename NodeMappable, typename ValueType = bool>
+class StaticNodeByteMap
+    : public BasicByteMap<NodeMappable, NodeKeys<NodeMappable>, ValueType>
+{
+public:
+    StaticNodeByteMap(const NodeMappable& graph,
+            ValueType initial_value = ValueType())
+        : BasicByteMap<NodeMappable, NodeKeys<NodeMappable>, ValueType>(
+                graph, initial_value)
+    {}
+};
+
+
+/// \brief A static arc map storing one byte per arc.
+/// \ingroup graph_implementations_maps
+/*!
+ *  The graph must conform to concepts::ArcMappable. See BasicByteMap.
+ */
+template <typename ArcMappable, typename ValueType = bool>
+class StaticArcByteMap
+    : public BasicByteMap<ArcMappable, ArcKeys<ArcMappable>, ValueType>
+{
+public:
+    StaticArcByteMap(const ArcMappable& graph,
+            ValueType initial_value = ValueType())
+        : BasicByteMap<ArcMappable, ArcKeys<ArcMappable>, ValueType>(
+                graph, initial_value)
+    {}
+};
+
+
+/// \brief A static edge map storing one byte per edge.
+/// \ingroup graph_implementations_maps
+/*!
+ *  The graph must conform to concepts::EdgeMappable. See BasicByteMap.
+ */
+template <typename EdgeMappable, typename ValueType = bool>
+class StaticEdgeByteMap
+    : public BasicByteMap<EdgeMappable, EdgeKeys<EdgeMappable>, ValueType>
+{
+public:
+    StaticEdgeByteMap(const EdgeMappable& graph,
+            ValueType initial_value = ValueType())
+        : BasicByteMap<EdgeMappable, EdgeKeys<EdgeMappable>, ValueType>(
+                graph, initial_value)
+    {}
+};
+
+
+/// \brief A node map which only stores the nodes that have been written.
+/// \ingroup graph_implementations_maps
+/*!
+ *  The graph must conform to concepts::NodeMappable. See BasicSparseMap.
+ */
+template <typename NodeMappable, typename ValueType>
+class SparseNodeMap
+    : public BasicSparseMap<NodeMappable, NodeKeys<NodeMappable>, ValueType>
+{
+public:
+    SparseNodeMap(const NodeMappable& graph,
+            const ValueType& default_value = ValueType())
+        : BasicSparseMap<NodeMappable, NodeKeys<NodeMappable>, ValueType>(
+                graph, default_value)
+    {}
+};
+
+
+/// \brief An arc map which only stores the arcs that have been written.
+/// \ingroup graph_implementations_maps
+/*!
+ *  The graph must conform to concepts::ArcMappable. See BasicSparseMap.
+ */
+template <typename ArcMappable, typename ValueType>
+class SparseArcMap
+    : public BasicSparseMap<ArcMappable, ArcKeys<ArcMappable>, ValueType>
+{
+public:
+    SparseArcMap(const ArcMappable& graph,
+            const ValueType& default_value = ValueType())
+        : BasicSparseMap<ArcMappable, ArcKeys<ArcMappable>, ValueType>(
+                graph, default_value)
+    {}
+};
+
+
+/// \brief An edge map which only stores the edges that have been written.
+/// \ingroup graph_implementations_maps
+/*!
+ *  The graph must conform to concepts::EdgeMappable. See BasicSparseMap.
+ */
+template <typename EdgeMappable, typename ValueType>
+class SparseEdgeMap
+    : public BasicSparseMap<EdgeMappable, EdgeKeys<EdgeMappable>, ValueType>
+{
+public:
+    SparseEdgeMap(const EdgeMappable& graph,
+            const ValueType& default_value = ValueType())
+        : BasicSparseMap<EdgeMappable, EdgeKeys<EdgeMappable>, ValueType>(
+                graph, default_value)
+    {}
 };
 
 }
@@ -25,6 +25,8 @@
 #ifndef DENALI_GRAPH_MIXINS_H
 #define DENALI_GRAPH_MIXINS_H
 
+#include <denali/identifiers.h>
+
 namespace denali {
 
 /// \brief An empty base for mixing in graph concepts.
@@ -148,58 +150,58 @@ public:
 
     /// \brief Get the degree of the node.
     /// \pre The node must be valid.
-    unsigned int degree(Node node) const {
+    Identifier degree(Node node) const {
         return _graph.degree(node);
     }
 
     /// \brief Get the in degree of the node.
     /// \pre The node must be valid.
-    unsigned int inDegree(Node node) const {
+    Identifier inDegree(Node node) const {
         return _graph.inDegree(node);
     }
 
     /// \brief Get the out degree of the node.
     /// \pre The node must be valid.
-    unsigned int outDegree(Node node) const {
+    Identifier outDegree(Node node) const {
         return _graph.outDegree(node);
     }
 
     /// \brief The number of nodes in the graph
-    unsigned int numberOfNodes() const {
+    Identifier numberOfNodes() const {
         return _graph.numberOfNodes();
     }
 
     /// \brief The number of arcs in the graph
-    unsigned int numberOfArcs() const {
+    Identifier numberOfArcs() const {
         return _graph.numberOfArcs();
     }
 
     /// \brief Gets the maximum node identifier in the graph.
-    unsigned int getMaxNodeIdentifier() const {
+    Identifier getMaxNodeIdentifier() const {
         return _graph.getMaxNodeIdentifier();
     }
 
     /// \brief Get the identifier of the node.
-    unsigned int getNodeIdentifier(Node node) const {
+    Identifier getNodeIdentifier(Node node) const {
         return _graph.getNodeIdentifier(node);
     }
 
     /// \brief Retrieve a node by its identifier.
-    Node getNodeFromIdentifier(unsigned int identifier) const {
+    Node getNodeFromIdentifier(Identifier identifier) const {
         return _graph.getNodeFromIdentifier(identifier);
     }
 
     /// \brief Gets the maximum arc identifier in the graph.
-    unsigned int getMaxArcIdentifier() const {
+    Identifier getMaxArcIdentifier() const {
         return _graph.getMaxArcIdentifier();
     }
 
     /// \brief Get the identifier of the arc.
-    unsigned int getArcIdentifier(Arc arc) const {
+    Identifier getArcIdentifier(Arc arc) const {
         return _graph.getArcIdentifier(arc);
     }
 
-    Arc getArcFromIdentifier(unsigned int id) const {
+    Arc getArcFromIdentifier(Identifier id) const {
         return _graph.getArcFromIdentifier(id);
     }
 
@@ -297,41 +299,41 @@ public:
     }
 
     /// \brief Gets the maximum node identifier in the graph.
-    unsigned int getMaxNodeIdentifier() const
+    Identifier getMaxNodeIdentifier() const
     {
         return _graph.getMaxNodeIdentifier();
     }
 
     /// \brief Get the identifier of the node.
-    unsigned int getNodeIdentifier(Node node) const
+    Identifier getNodeIdentifier(Node node) const
     {
         return _graph.getNodeIdentifier(node);
     }
 
     /// \brief Retrieve a node by its identifier.
-    Node getNodeFromIdentifier(unsigned int identifier) const {
+    Node getNodeFromIdentifier(Identifier identifier) const {
         return _graph.getNodeFromIdentifier(identifier);
     }
 
     /// \brief Gets the maximum edge identifier in the graph.
-    unsigned int getMaxEdgeIdentifier() const
+    Identifier getMaxEdgeIdentifier() const
     {
         return _graph.getMaxEdgeIdentifier();
     }
 
     /// \brief Get the identifier of the edge.
-    unsigned int getEdgeIdentifier(Edge edge) const
+    Identifier getEdgeIdentifier(Edge edge) const
     {
         return _graph.getEdgeIdentifier(edge);
     }
 
-    Edge getEdgeFromIdentifier(unsigned int id) const {
+    Edge getEdgeFromIdentifier(Identifier id) const {
         return _graph.getEdgeFromIdentifier(id);
     }
 
     /// \brief Gets the degree of the node.
     /// \pre The node must be valid.
-    unsigned int degree(Node node) const
+    Identifier degree(Node node) const
     {
         return _graph.degree(node);
     }
@@ -349,12 +351,12 @@ public:
     }
 
     /// \brief The number of nodes in the graph
-    unsigned int numberOfNodes() const {
+    Identifier numberOfNodes() const {
         return _graph.numberOfNodes();
     }
 
     /// \brief The number of arcs in the graph
-    unsigned int numberOfEdges() const {
+    Identifier numberOfEdges() const {
         return _graph.numberOfEdges();
     }
 
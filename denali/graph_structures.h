@@ -63,9 +63,11 @@
 
 #include <algorithm>
 #include <list>
+#include <memory>
 #include <vector>
 
 #include <denali/graph_mixins.h>
+#include <denali/identifiers.h>
 
 namespace denali {
 
@@ -79,8 +81,12 @@ namespace denali {
 /*!
  * It contains functionality that is not intended to be part of the
  * interface of VectorDirectedGraph.
+ *
+ * The node and arc records are stored in vectors obtained from the
+ * Allocator, which is rebound to the record types.
  */
-class VectorDirectedGraphImplementation
+template <typename Allocator = std::allocator<char> >
+class BasicVectorDirectedGraphImplementation
 {
 public:
     class Observer;
@@ -88,51 +94,67 @@ public:
 private:
     struct NodeRep
     {
-        int first_in, first_out;
-        int prev, next;
+        Index first_in, first_out;
+        Index prev, next;
         bool valid;
-        int in_degree;
-        int out_degree;
+        Index in_degree;
+        Index out_degree;
     };
 
     struct ArcRep
     {
-        int target, source;
-        int prev_in, prev_out;
-        int next_in, next_out;
+        Index target, source;
+        Index prev_in, prev_out;
+        Index next_in, next_out;
         bool valid;
     };
 
-    typedef std::vector<NodeRep> Nodes;
+    typedef typename Allocator::template rebind<NodeRep>::other NodeAllocator;
+    typedef typename Allocator::template rebind<ArcRep>::other ArcAllocator;
+
+    typedef std::vector<NodeRep, NodeAllocator> Nodes;
     Nodes nodes;
-    int first_node;
-    int first_free_node;
+    Index first_node;
+    Index first_free_node;
 
-    typedef std::vector<ArcRep> Arcs;
+    typedef std::vector<ArcRep, ArcAllocator> Arcs;
     Arcs arcs;
-    int first_free_arc;
+    Index first_free_arc;
 
-    int number_of_nodes;
-    int number_of_arcs;
+    Index number_of_nodes;
+    Index number_of_arcs;
 
     typedef std::list<Observer*> Observers;
     Observers _node_observers;
     Observers _arc_observers;
 
+    // while notifications are held, observers are only notified when the
+    // identifier space grows; the rest are deferred until release
+    int _held_notifications;
+    mutable bool _node_notification_pending;
+    mutable bool _arc_notification_pending;
+    mutable size_t _notified_nodes;
+    mutable size_t _notified_arcs;
+
 public:
 
+    typedef Allocator allocator_type;
 
-    VectorDirectedGraphImplementation()
-        : first_node(-1), first_free_node(-1), first_free_arc(-1),
-          number_of_nodes(0), number_of_arcs(0) {};
+    BasicVectorDirectedGraphImplementation(
+            const Allocator& allocator = Allocator())
+        : nodes(NodeAllocator(allocator)), first_node(-1), first_free_node(-1),
+          arcs(ArcAllocator(allocator)), first_free_arc(-1),
+          number_of_nodes(0), number_of_arcs(0), _held_notifications(0),
+          _node_notification_pending(false), _arc_notification_pending(false),
+          _notified_nodes(0), _notified_arcs(0) {};
 
     class Node
     {
-        friend class VectorDirectedGraphImplementation;
+        friend class BasicVectorDirectedGraphImplementation;
 
     protected:
-        int index;
-        Node(int index) : index(index) {}
+        Index index;
+        Node(Index index) : index(index) {}
 
     public:
         Node() {}
@@ -152,11 +174,11 @@ public:
 
     class Arc
     {
-        friend class VectorDirectedGraphImplementation;
+        friend class BasicVectorDirectedGraphImplementation;
 
     protected:
-        int index;
-        Arc(int index) : index(index) {}
+        Index index;
+        Arc(Index index) : index(index) {}
 
     public:
         Arc() {}
@@ -184,26 +206,116 @@ public:
 
     void notifyNodeObservers() const
     {
-        for (Observers::const_iterator it = _node_observers.begin();
+        if (_held_notifications > 0 && nodes.size() <= _notified_nodes) {
+            _node_notification_pending = true;
+            return;
+        }
+
+        for (typename Observers::const_iterator it = _node_observers.begin();
                 it != _node_observers.end();
                 ++it) {
             (*it)->notify();
         }
+
+        _notified_nodes = nodes.size();
+        _node_notification_pending = false;
     }
 
     void notifyArcObservers() const
     {
-        for (Observers::const_iterator it = _arc_observers.begin();
+        if (_held_notifications > 0 && arcs.size() <= _notified_arcs) {
+            _arc_notification_pending = true;
+            return;
+        }
+
+        for (typename Observers::const_iterator it = _arc_observers.begin();
                 it != _arc_observers.end();
                 ++it) {
             (*it)->notify();
         }
+
+        _notified_arcs = arcs.size();
+        _arc_notification_pending = false;
+    }
+
+    /// \brief Defers observer notifications until releaseNotifications().
+    /*!
+     *  Observers are still notified immediately whenever the identifier
+     *  space grows, so that observing maps are always large enough. Calls
+     *  may be nested.
+     */
+    void holdNotifications()
+    {
+        _held_notifications++;
+    }
+
+    /// \brief Fires the notifications deferred since holdNotifications().
+    void releaseNotifications()
+    {
+        assert(_held_notifications > 0);
+        if (--_held_notifications > 0) {
+            return;
+        }
+
+        if (_node_notification_pending) {
+            notifyNodeObservers();
+        }
+
+        if (_arc_notification_pending) {
+            notifyArcObservers();
+        }
+    }
+
+    /// \brief Makes room for n nodes to be added without growing.
+    /*!
+     *  Free node records are appended so that the next n additions reuse
+     *  them. The observers are notified once for the whole reservation.
+     */
+    void reserveNodes(size_t n)
+    {
+        size_t free_nodes = nodes.size() - number_of_nodes;
+        if (n <= free_nodes) {
+            return;
+        }
+
+        nodes.reserve(nodes.size() + n - free_nodes);
+        for (size_t i=free_nodes; i<n; ++i)
+        {
+            NodeRep rep = NodeRep();
+            rep.valid = false;
+            rep.next = first_free_node;
+            first_free_node = nodes.size();
+            nodes.push_back(rep);
+        }
+
+        notifyNodeObservers();
+    }
+
+    /// \brief Makes room for n arcs to be added without growing.
+    void reserveArcs(size_t n)
+    {
+        size_t free_arcs = arcs.size() - number_of_arcs;
+        if (n <= free_arcs) {
+            return;
+        }
+
+        arcs.reserve(arcs.size() + n - free_arcs);
+        for (size_t i=free_arcs; i<n; ++i)
+        {
+            ArcRep rep = ArcRep();
+            rep.valid = false;
+            rep.next_in = first_free_arc;
+            first_free_arc = arcs.size();
+            arcs.push_back(rep);
+        }
+
+        notifyArcObservers();
     }
 
     Node addNode()
     {
         // the index of the node in the vector
-        int n;
+        Index n;
 
         // if there isn't a free node, we push a new one
         if (first_free_node == -1) {
@@ -249,7 +361,7 @@ public:
         assert(u.index != v.index);
 
         // the index of the arc in the vector
-        int n;
+        Index n;
 
         // check to see if there is an available slot
         if (first_free_arc == -1) {
@@ -302,10 +414,10 @@ public:
         return Arc(n);
     }
 
-    int numberOfNodes() const {
+    Index numberOfNodes() const {
         return number_of_nodes;
     }
-    int numberOfArcs() const {
+    Index numberOfArcs() const {
         return number_of_arcs;
     }
 
@@ -324,7 +436,7 @@ public:
         //      - marks the node as invalid
         //      - decrements the number of nodes counter
 
-        int n = node.index;
+        Index n = node.index;
 
         // if the next and prev nodes are valid connect them
 
@@ -360,7 +472,7 @@ public:
         //      - decrements the number of arcs counter
         //      - decrements the degrees of associated nodes
 
-        int n = arc.index;
+        Index n = arc.index;
 
         if (arcs[n].next_in != -1) {
             arcs[arcs[n].next_in].prev_in = arcs[n].prev_in;
@@ -442,17 +554,17 @@ public:
         eraseArc(arc);
     }
 
-    int degree(const Node node) const
+    Index degree(const Node node) const
     {
         return nodes[node.index].in_degree + nodes[node.index].out_degree;
     }
 
-    int inDegree(const Node node) const
+    Index inDegree(const Node node) const
     {
         return nodes[node.index].in_degree;
     }
 
-    int outDegree(const Node node) const
+    Index outDegree(const Node node) const
     {
         return nodes[node.index].out_degree;
     }
@@ -471,13 +583,13 @@ public:
 
     bool isNodeValid(const Node node) const
     {
-        return node.index >= 0 && (unsigned int) node.index < nodes.size() &&
+        return node.index >= 0 && (size_t) node.index < nodes.size() &&
                nodes[node.index].valid;
     }
 
     bool isArcValid(const Arc arc) const
     {
-        return (arc.index >= 0 && (unsigned int) arc.index < arcs.size() &&
+        return (arc.index >= 0 && (size_t) arc.index < arcs.size() &&
                arcs[arc.index].valid);
     }
 
@@ -584,30 +696,30 @@ public:
         }
     }
 
-    unsigned int getNodeIdentifier(const Node node) const
+    Identifier getNodeIdentifier(const Node node) const
     {
         return node.index;
     }
 
-    Node getNodeFromIdentifier(unsigned int identifier) const {
+    Node getNodeFromIdentifier(Identifier identifier) const {
         return Node(identifier);
     }
 
-    unsigned int getArcIdentifier(const Arc arc) const
+    Identifier getArcIdentifier(const Arc arc) const
     {
         return arc.index;
     }
 
-    Arc getArcFromIdentifier(unsigned int identifier) const {
+    Arc getArcFromIdentifier(Identifier identifier) const {
         return Arc(identifier);
     }
 
-    unsigned int getMaxNodeIdentifier() const
+    Identifier getMaxNodeIdentifier() const
     {
         return nodes.size();
     }
 
-    unsigned int getMaxArcIdentifier() const
+    Identifier getMaxArcIdentifier() const
     {
         return arcs.size();
     }
@@ -673,6 +785,9 @@ public:
 
 };
 
+/// \brief The implementation of a directed graph using the default allocator.
+typedef BasicVectorDirectedGraphImplementation<> VectorDirectedGraphImplementation;
+
 
 ////////////////////////////////////////////////////////////////////////////
 //
@@ -706,6 +821,58 @@ class DirectedGraphBase :
 
 public:
     DirectedGraphBase() : Mixin(_graph) {}
+
+    /// \brief Constructs the graph with storage from the allocator.
+    template <typename Allocator>
+    explicit DirectedGraphBase(const Allocator& allocator)
+        : Mixin(_graph), _graph(allocator) {}
+
+    /// \brief Defers observer notifications. See releaseNotifications().
+    void holdNotifications() {
+        _graph.holdNotifications();
+    }
+
+    /// \brief Fires the notifications deferred since holdNotifications().
+    void releaseNotifications() {
+        _graph.releaseNotifications();
+    }
+
+    /// \brief Makes room for n nodes to be added without growing.
+    void reserveNodes(size_t n) {
+        _graph.reserveNodes(n);
+    }
+
+    /// \brief Makes room for n arcs to be added without growing.
+    void reserveArcs(size_t n) {
+        _graph.reserveArcs(n);
+    }
+};
+
+
+/// \brief A directed graph whose storage is obtained from an allocator.
+/// \ingroup graph_implementations_structures
+/*!
+ *  Identical to DirectedGraph, except that its nodes and arcs are stored
+ *  using the Allocator. See ArenaAllocator.
+ */
+template <typename Allocator>
+class BasicDirectedGraph :
+    public DirectedGraphBase<BasicVectorDirectedGraphImplementation<Allocator> >
+{
+    typedef
+    DirectedGraphBase<BasicVectorDirectedGraphImplementation<Allocator> >
+    Base;
+
+public:
+    typedef typename Base::Node Node;
+    typedef typename Base::Arc Arc;
+    typedef typename Base::Observer Observer;
+    typedef Allocator allocator_type;
+
+    BasicDirectedGraph() {}
+
+    explicit BasicDirectedGraph(const Allocator& allocator)
+        : Base(allocator) {}
 };
 
 
@@ -721,10 +888,10 @@ public:
  *  reference instead of this page.
  */
 class DirectedGraph :
-    public DirectedGraphBase<VectorDirectedGraphImplementation>
+    public BasicDirectedGraph<std::allocator<char> >
 {
     typedef
-    DirectedGraphBase<VectorDirectedGraphImplementation>
+    BasicDirectedGraph<std::allocator<char> >
     Base;
 
 public:
@@ -758,6 +925,13 @@ class UndirectedGraphImplementation
     Impl impl;
 
 public:
+    UndirectedGraphImplementation() {}
+
+    /// \brief Constructs the graph with storage from the allocator.
+    template <typename Allocator>
+    explicit UndirectedGraphImplementation(const Allocator& allocator)
+        : impl(allocator) {}
+
     class Node
     {
         friend class UndirectedGraphImplementation;
@@ -843,7 +1017,7 @@ public:
         return Node(impl.opposite(node.base, edge.base));
     }
 
-    unsigned int degree(Node node) const {
+    Identifier degree(Node node) const {
         return impl.degree(node.base);
     }
     Node u(Edge edge) const {
@@ -853,37 +1027,37 @@ public:
         return impl.target(edge.base);
     }
 
-    unsigned int numberOfNodes() const {
+    Identifier numberOfNodes() const {
         return impl.numberOfNodes();
     }
-    unsigned int numberOfEdges() const {
+    Identifier numberOfEdges() const {
         return impl.numberOfArcs();
     }
 
-    unsigned int getMaxNodeIdentifier() const
+    Identifier getMaxNodeIdentifier() const
     {
         return impl.getMaxNodeIdentifier();
     }
-    unsigned int getNodeIdentifier(Node node) const
+    Identifier getNodeIdentifier(Node node) const
     {
         return impl.getNodeIdentifier(node.base);
     }
 
-    Node getNodeFromIdentifier(unsigned int identifier) const {
+    Node getNodeFromIdentifier(Identifier identifier) const {
         return Node(impl.getNodeFromIdentifier(identifier));
     }
 
-    unsigned int getMaxEdgeIdentifier() const
+    Identifier getMaxEdgeIdentifier() const
     {
         return impl.getMaxArcIdentifier();
     }
 
-    unsigned int getEdgeIdentifier(Edge edge) const
+    Identifier getEdgeIdentifier(Edge edge) const
     {
         return impl.getArcIdentifier(edge.base);
     }
 
-    Edge getEdgeFromIdentifier(unsigned int identifier) const {
+    Edge getEdgeFromIdentifier(Identifier identifier) const {
         return Edge(impl.getArcFromIdentifier(identifier));
     }
 
@@ -906,6 +1080,19 @@ public:
         impl.clear();
     }
 
+    void holdNotifications() {
+        impl.holdNotifications();
+    }
+    void releaseNotifications() {
+        impl.releaseNotifications();
+    }
+    void reserveNodes(size_t n) {
+        impl.reserveNodes(n);
+    }
+    void reserveEdges(size_t n) {
+        impl.reserveArcs(n);
+    }
+
     void attachNodeObserver(Observer& ob) {
         impl.attachNodeObserver(ob);
     }
@@ -985,8 +1172,65 @@ class UndirectedGraphBase :
 public:
     UndirectedGraphBase() : Mixin(_graph) {}
 
+    /// \brief Constructs the graph with storage from the allocator.
+    template <typename Allocator>
+    explicit UndirectedGraphBase(const Allocator& allocator)
+        : Mixin(_graph), _graph(allocator) {}
+
+    /// \brief Defers observer notifications. See releaseNotifications().
+    void holdNotifications() {
+        _graph.holdNotifications();
+    }
+
+    /// \brief Fires the notifications deferred since holdNotifications().
+    void releaseNotifications() {
+        _graph.releaseNotifications();
+    }
+
+    /// \brief Makes room for n nodes to be added without growing.
+    void reserveNodes(size_t n) {
+        _graph.reserveNodes(n);
+    }
+
+    /// \brief Makes room for n edges to be added without growing.
+    void reserveEdges(size_t n) {
+        _graph.reserveEdges(n);
+    }
+
 };
 
+/// \brief An undirected graph whose storage is obtained from an allocator.
+/// \ingroup graph_implementations_structures
+/*!
+ *  Identical to UndirectedGraph, except that its nodes and edges are stored
+ *  using the Allocator. See ArenaAllocator.
+ */
+template <typename Allocator>
+class BasicUndirectedGraph :
+    public
+    UndirectedGraphBase <
+    UndirectedGraphImplementation <
+    BasicDirectedGraph<Allocator> > >
+{
+    typedef
+    UndirectedGraphBase <
+    UndirectedGraphImplementation <
+    BasicDirectedGraph<Allocator> > >
+    Base;
+
+public:
+    typedef typename Base::Node Node;
+    typedef typename Base::Edge Edge;
+    typedef typename Base::Observer Observer;
+    typedef Allocator allocator_type;
+
+    BasicUndirectedGraph() {}
+
+    explicit BasicUndirectedGraph(const Allocator& allocator)
+        : Base(allocator) {}
+};
+
+
 /// \brief The principal undirected graph class.
 /// \ingroup graph_implementations_structures
 /*!
@@ -999,16 +1243,9 @@ public:
  *  reference instead of this page.
  */
 class UndirectedGraph :
-    public
-    UndirectedGraphBase <
-    UndirectedGraphImplementation <
-    DirectedGraph > >
+    public BasicUndirectedGraph<std::allocator<char> >
 {
-    typedef
-    UndirectedGraphBase <
-    UndirectedGraphImplementation <
-    DirectedGraph > >
-    Base;
+    typedef BasicUndirectedGraph<std::allocator<char> > Base;
 
 public:
     typedef Base::Node Node;
@@ -1026,7 +1263,7 @@ bool isConnected(const UndirectedGraph& graph)
         return true;
 
     // the node count is 1, because the source node isn't visited by the loop
-    unsigned int node_count = 1;
+    Identifier node_count = 1;
 
     typename UndirectedGraph::Node source_node = graph.getFirstNode();
     for (UndirectedBFSIterator<UndirectedGraph> it(graph, source_node); 
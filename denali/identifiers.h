@@ -0,0 +1,61 @@
+// Copyright (c) 2014, Justin Eldridge, Mikhail Belkin, and Yusu Wang
+// at The Ohio State University. All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef DENALI_IDENTIFIERS_H
+#define DENALI_IDENTIFIERS_H
+
+#include <boost/cstdint.hpp>
+
+/// \file
+/// \brief The integer types used for vertex ids and graph indices.
+/*!
+ *  By default, ids and indices are 32 bits wide, which keeps the node and
+ *  arc records of the graphs compact and is enough for complexes with up to
+ *  about two billion vertices and edges. Defining `DENALI_64BIT_IDS` before
+ *  any denali header is included (the CMake option of the same name does
+ *  this for the whole build) widens them to 64 bits, so that larger inputs
+ *  can be processed. Every translation unit of a program must agree on the
+ *  setting.
+ */
+
+namespace denali {
+
+#ifdef DENALI_64BIT_IDS
+
+typedef boost::uint64_t Identifier;
+typedef boost::int64_t Index;
+
+#else
+
+/// \brief The type of vertex ids and of node, arc and edge identifiers.
+typedef boost::uint32_t Identifier;
+
+/// \brief The type of indices into graph storage. Negative means invalid.
+typedef boost::int32_t Index;
+
+#endif
+
+} // namespace denali
+
+#endif
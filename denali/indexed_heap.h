@@ -0,0 +1,249 @@
+// Copyright (c) 2014, Justin Eldridge, Mikhail Belkin, and Yusu Wang
+// at The Ohio State University. All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef DENALI_INDEXED_HEAP_H
+#define DENALI_INDEXED_HEAP_H
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <denali/identifiers.h>
+
+namespace denali {
+
+/// \brief A d-ary min-heap holding at most one entry per key.
+/// \ingroup priority_queues
+/*!
+ *  Keys are identifiers in the range [0, capacity). Each key has at most
+ *  one entry, and the position of every entry is tracked so that its
+ *  priority can be changed in place. Inserting a key which is already in
+ *  the heap updates its priority instead of adding a second entry, and an
+ *  entry can be removed before it reaches the top. This makes the heap
+ *  suitable for queues whose priorities change as they are processed,
+ *  without leaving stale entries behind to be discarded when popped.
+ *
+ *  The entry with the least priority according to Compare is on top. Ties
+ *  are broken by the smaller key, so the order of the pops depends only on
+ *  the keys and their priorities.
+ *
+ *  A larger Arity makes the heap shallower, so that updates and pushes move
+ *  fewer entries, at the cost of more comparisons per pop.
+ */
+template <
+    typename Priority,
+    typename Compare = std::less<Priority>,
+    unsigned int Arity = 4
+    >
+class IndexedDaryHeap
+{
+    typedef std::pair<Priority, Identifier> Entry;
+
+    std::vector<Entry> _entries;
+    std::vector<Index> _positions;
+    Compare _compare;
+
+    bool entryLess(const Entry& lhs, const Entry& rhs) const
+    {
+        if (_compare(lhs.first, rhs.first)) return true;
+        if (_compare(rhs.first, lhs.first)) return false;
+        return lhs.second < rhs.second;
+    }
+
+    void place(size_t position, const Entry& entry)
+    {
+        _entries[position] = entry;
+        _positions[entry.second] = position;
+    }
+
+    void siftUp(size_t position)
+    {
+        Entry entry = _entries[position];
+
+        while (position > 0)
+        {
+            size_t parent = (position - 1) / Arity;
+            if (!entryLess(entry, _entries[parent])) break;
+
+            place(position, _entries[parent]);
+            position = parent;
+        }
+
+        place(position, entry);
+    }
+
+    void siftDown(size_t position)
+    {
+        Entry entry = _entries[position];
+
+        for (;;)
+        {
+            size_t first = position * Arity + 1;
+            if (first >= _entries.size()) break;
+
+            size_t last = std::min(first + Arity, _entries.size());
+
+            size_t least = first;
+            for (size_t child = first + 1; child < last; ++child) {
+                if (entryLess(_entries[child], _entries[least])) {
+                    least = child;
+                }
+            }
+
+            if (!entryLess(_entries[least], entry)) break;
+
+            place(position, _entries[least]);
+            position = least;
+        }
+
+        place(position, entry);
+    }
+
+    void checkKey(Identifier key) const
+    {
+        if (key >= _positions.size()) {
+            throw std::runtime_error("Heap key is out of range.");
+        }
+    }
+
+public:
+
+    IndexedDaryHeap(size_t capacity = 0, const Compare& compare = Compare())
+        : _positions(capacity, -1), _compare(compare) {}
+
+    /// \brief The number of keys the heap can hold.
+    size_t capacity() const {
+        return _positions.size();
+    }
+
+    /// \brief Allows keys up to capacity-1. The heap must be empty.
+    void setCapacity(size_t capacity)
+    {
+        if (!empty()) {
+            throw std::runtime_error("Cannot resize a nonempty heap.");
+        }
+        _positions.assign(capacity, -1);
+    }
+
+    size_t size() const {
+        return _entries.size();
+    }
+
+    bool empty() const {
+        return _entries.empty();
+    }
+
+    /// \brief Whether the key has an entry in the heap.
+    bool contains(Identifier key) const {
+        return key < _positions.size() && _positions[key] != -1;
+    }
+
+    /// \brief The priority of a key in the heap.
+    const Priority& getPriority(Identifier key) const {
+        return _entries[_positions[key]].first;
+    }
+
+    /// \brief Inserts the key, or changes its priority if it is present.
+    /*!
+     *  Returns true if the key was inserted, false if it was updated.
+     */
+    bool push(Identifier key, const Priority& priority)
+    {
+        checkKey(key);
+
+        Entry entry(priority, key);
+
+        if (_positions[key] == -1)
+        {
+            _entries.push_back(entry);
+            _positions[key] = _entries.size() - 1;
+            siftUp(_entries.size() - 1);
+            return true;
+        }
+
+        size_t position = _positions[key];
+        bool decreased = entryLess(entry, _entries[position]);
+        _entries[position] = entry;
+
+        if (decreased) {
+            siftUp(position);
+        } else {
+            siftDown(position);
+        }
+
+        return false;
+    }
+
+    /// \brief The key with the least priority.
+    Identifier top() const {
+        return _entries.front().second;
+    }
+
+    /// \brief The least priority in the heap.
+    const Priority& topPriority() const {
+        return _entries.front().first;
+    }
+
+    /// \brief Removes the entry on top of the heap.
+    void pop() {
+        erase(top());
+    }
+
+    /// \brief Removes the key's entry, if there is one.
+    void erase(Identifier key)
+    {
+        if (!contains(key)) return;
+
+        size_t position = _positions[key];
+        _positions[key] = -1;
+
+        Entry last = _entries.back();
+        _entries.pop_back();
+
+        if (position == _entries.size()) return;
+
+        // move the last entry into the hole and restore the order
+        place(position, last);
+        if (position > 0 && entryLess(last, _entries[(position - 1) / Arity])) {
+            siftUp(position);
+        } else {
+            siftDown(position);
+        }
+    }
+
+    /// \brief Removes every entry.
+    void clear()
+    {
+        for (size_t i=0; i<_entries.size(); ++i) {
+            _positions[_entries[i].second] = -1;
+        }
+        _entries.clear();
+    }
+};
+
+} // namespace denali
+
+#endif
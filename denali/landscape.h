@@ -25,14 +25,18 @@
 #ifndef DENALI_LANDSCAPE_H
 #define DENALI_LANDSCAPE_H
 
+#include <denali/allocators.h>
 #include <denali/graph_structures.h>
 #include <denali/graph_mixins.h>
 #include <denali/graph_iterators.h>
+#include <algorithm>
 #include <stack>
+#include <vector>
 
 namespace denali {
 
-template <typename ContourTree, typename GraphType>
+template <typename ContourTree,
+          typename GraphType = BasicDirectedGraph<ArenaAllocator<char> > >
 class LandscapeTreeBase :
     public
     ArcObservableMixin < GraphType,
@@ -47,15 +51,26 @@ class LandscapeTreeBase :
                        BaseGraphMixin <GraphType> > > >
                        Mixin;
 
+    typedef typename GraphType::allocator_type Allocator;
+    typedef typename GraphType::Node GraphNode;
+    typedef typename GraphType::Arc GraphArc;
+    typedef typename ContourTree::Node CTNode;
+    typedef typename ContourTree::Edge CTEdge;
+
+    typedef typename Allocator::template rebind<GraphNode>::other NodeAllocator;
+    typedef typename Allocator::template rebind<GraphArc>::other ArcAllocator;
+    typedef typename Allocator::template rebind<CTNode>::other CTNodeAllocator;
+    typedef typename Allocator::template rebind<CTEdge>::other CTEdgeAllocator;
+
     GraphType _graph;
     const ContourTree& _contour_tree;
-    typename GraphType::Node _root;
+    GraphNode _root;
 
-    StaticNodeMap<ContourTree, typename GraphType::Node> _ct_node_to_lscape_node;
-    StaticEdgeMap<ContourTree, typename GraphType::Arc> _ct_edge_to_lscape_arc;
+    StaticNodeMap<ContourTree, GraphNode, NodeAllocator> _ct_node_to_lscape_node;
+    StaticEdgeMap<ContourTree, GraphArc, ArcAllocator> _ct_edge_to_lscape_arc;
 
-    ObservingNodeMap<GraphType, typename ContourTree::Node> _lscape_node_to_ct_node;
-    ObservingArcMap<GraphType, typename ContourTree::Edge> _lscape_arc_to_ct_edge;
+    ObservingNodeMap<GraphType, CTNode, CTNodeAllocator> _lscape_node_to_ct_node;
+    ObservingArcMap<GraphType, CTEdge, CTEdgeAllocator> _lscape_arc_to_ct_edge;
 
 public:
 
@@ -65,30 +80,78 @@ public:
 
     LandscapeTreeBase(
         const ContourTree& contour_tree,
-        typename ContourTree::Node root)
-        : Mixin(_graph), _contour_tree(contour_tree), _ct_node_to_lscape_node(contour_tree),
-          _ct_edge_to_lscape_arc(contour_tree), _lscape_node_to_ct_node(_graph),
-          _lscape_arc_to_ct_edge(_graph)
+        typename ContourTree::Node root,
+        const Allocator& allocator = Allocator())
+        : Mixin(_graph), _graph(allocator), _contour_tree(contour_tree),
+          _ct_node_to_lscape_node(contour_tree, GraphNode(), NodeAllocator(allocator)),
+          _ct_edge_to_lscape_arc(contour_tree, GraphArc(), ArcAllocator(allocator)),
+          _lscape_node_to_ct_node(_graph, CTNode(), CTNodeAllocator(allocator)),
+          _lscape_arc_to_ct_edge(_graph, CTEdge(), CTEdgeAllocator(allocator))
     {
+        // the landscape tree has a node for every node of the contour tree
+        // and an arc for every edge, so the observing maps are sized once
+        _graph.reserveNodes(contour_tree.numberOfNodes());
+        _graph.reserveArcs(contour_tree.numberOfEdges());
         _root = addNode(root);
     }
 
+    /// \brief Defers observer notifications until releaseNotifications().
+    void holdNotifications() {
+        _graph.holdNotifications();
+    }
+
+    /// \brief Fires the notifications deferred since holdNotifications().
+    void releaseNotifications() {
+        _graph.releaseNotifications();
+    }
+
     Node addNode(typename ContourTree::Node ct_node)
     {
         Node node = _graph.addNode();
-        _ct_node_to_lscape_node[ct_node] = node;
-        _lscape_node_to_ct_node[node] = ct_node;
-
+        setContourTreeNode(node, ct_node);
         return node;
     }
 
     Arc addArc(Node parent, Node child, typename ContourTree::Edge ct_edge)
     {
         Arc arc = _graph.addArc(parent, child);
+        setContourTreeEdge(arc, ct_edge);
+        return arc;
+    }
+
+    void removeNode(Node node)
+    {
+        _graph.removeNode(node);
+    }
+
+    void removeArc(Arc arc)
+    {
+        _graph.removeArc(arc);
+    }
+
+    void setRoot(Node root)
+    {
+        _root = root;
+    }
 
+    void setContourTreeNode(Node node, typename ContourTree::Node ct_node)
+    {
+        _ct_node_to_lscape_node[ct_node] = node;
+        _lscape_node_to_ct_node[node] = ct_node;
+    }
+
+    void setContourTreeEdge(Arc arc, typename ContourTree::Edge ct_edge)
+    {
         _ct_edge_to_lscape_arc[ct_edge] = arc;
         _lscape_arc_to_ct_edge[arc] = ct_edge;
-        return arc;
+    }
+
+    /// \brief Makes room for the nodes and edges the contour tree has
+    /// gained since the landscape tree was built.
+    void resizeContourTreeMaps()
+    {
+        _ct_node_to_lscape_node.resize();
+        _ct_edge_to_lscape_arc.resize();
     }
 
     typename ContourTree::Node getContourTreeNode(Node node) const
@@ -115,12 +178,16 @@ public:
         return _root;
     }
 
+    const ContourTree& getContourTree() const {
+        return _contour_tree;
+    }
+
     double getValue(Node node) const
     {
         return _contour_tree.getValue(_lscape_node_to_ct_node[node]);
     }
 
-    unsigned int getID(Node node) const
+    Identifier getID(Node node) const
     {
         return _contour_tree.getID(_lscape_node_to_ct_node[node]);
     }
@@ -130,7 +197,7 @@ public:
         return _contour_tree.getNodeMembers(_lscape_node_to_ct_node[node]);
     }
 
-    Node getNode(unsigned int id) const
+    Node getNode(Identifier id) const
     {
         return _ct_node_to_lscape_node[_contour_tree.getNode(id)];
     }
@@ -149,41 +216,72 @@ public:
  *  relationship between the nodes of the contour tree and the landscape
  *  tree, as well as between the edges of the contour tree and the arcs of
  *  the landscape tree.
+ *
+ *  A landscape tree is built once and then only read, except that a
+ *  subtree may be replaced after the contour tree is folded within it; see
+ *  replaceSubtree(), and that it may be rooted elsewhere; see changeRoot().
+ *  The storage of the nodes and arcs it removes is reused by those it
+ *  adds, so the tree may be placed in a MonotonicArena.
  */
 template <typename ContourTree>
 class LandscapeTree :
+    private ArenaHolder,
     public
-    ArcObservableMixin < LandscapeTreeBase<ContourTree, DirectedGraph>,
-    NodeObservableMixin < LandscapeTreeBase<ContourTree, DirectedGraph>,
-    ReadableDirectedGraphMixin <LandscapeTreeBase<ContourTree, DirectedGraph>,
-    BaseGraphMixin <LandscapeTreeBase<ContourTree, DirectedGraph> > > > >
+    ArcObservableMixin < LandscapeTreeBase<ContourTree>,
+    NodeObservableMixin < LandscapeTreeBase<ContourTree>,
+    ReadableDirectedGraphMixin <LandscapeTreeBase<ContourTree>,
+    BaseGraphMixin <LandscapeTreeBase<ContourTree> > > > >
 
 {
     typedef
-    ArcObservableMixin < LandscapeTreeBase<ContourTree, DirectedGraph>,
-                       NodeObservableMixin < LandscapeTreeBase<ContourTree, DirectedGraph>,
-                       ReadableDirectedGraphMixin <LandscapeTreeBase<ContourTree, DirectedGraph>,
-                       BaseGraphMixin <LandscapeTreeBase<ContourTree, DirectedGraph> > > > >
+    ArcObservableMixin < LandscapeTreeBase<ContourTree>,
+                       NodeObservableMixin < LandscapeTreeBase<ContourTree>,
+                       ReadableDirectedGraphMixin <LandscapeTreeBase<ContourTree>,
+                       BaseGraphMixin <LandscapeTreeBase<ContourTree> > > > >
                        Mixin;
 
-    LandscapeTreeBase<ContourTree, DirectedGraph> _tree;
+    LandscapeTreeBase<ContourTree> _tree;
 
 public:
 
     typedef typename Mixin::Node Node;
     typedef typename Mixin::Arc Arc;
-    typedef typename LandscapeTreeBase<ContourTree, DirectedGraph>::Members Members;
+    typedef typename LandscapeTreeBase<ContourTree>::Members Members;
+    typedef ContourTree ContourTreeType;
 
     /// \brief Build a landscape tree from the contour tree.
     /*!
      *  This computes a landscape tree by performing a BFS from the root
-     *  node, resulting in a directed acyclic graph.
+     *  node, resulting in a directed acyclic graph. Room for every node and
+     *  arc is made before the search, and the maps observing the tree are
+     *  notified once it is complete.
      */
     LandscapeTree(
         const ContourTree& contour_tree,
         typename ContourTree::Node root)
         : Mixin(_tree), _tree(contour_tree, root)
     {
+        build(contour_tree, root);
+    }
+
+    /// \brief Build a landscape tree whose storage is placed in the arena.
+    LandscapeTree(
+        const ContourTree& contour_tree,
+        typename ContourTree::Node root,
+        boost::shared_ptr<MonotonicArena> arena)
+        : ArenaHolder(arena), Mixin(_tree),
+          _tree(contour_tree, root, ArenaAllocator<char>(arena.get()))
+    {
+        build(contour_tree, root);
+    }
+
+private:
+    void build(
+        const ContourTree& contour_tree,
+        typename ContourTree::Node root)
+    {
+        _tree.holdNotifications();
+
         // the root has already been added to the tree
         // do a search from the root
         for (UndirectedBFSIterator<ContourTree> it(contour_tree, root);
@@ -197,6 +295,205 @@ public:
                 _tree.getLandscapeTreeNode(it.child()),
                 it.edge());
         }
+
+        _tree.releaseNotifications();
+    }
+
+    /// \brief Returns true if the nodes and arcs of the tree are still
+    /// those of the contour tree, joined in the same way.
+    bool matchesContourTree()
+    {
+        typedef typename ContourTree::Node CTNode;
+        typedef typename ContourTree::Edge CTEdge;
+
+        const ContourTree& contour_tree = getContourTree();
+        if (contour_tree.numberOfNodes() != this->numberOfNodes() ||
+                contour_tree.numberOfEdges() != this->numberOfArcs()) {
+            return false;
+        }
+
+        _tree.resizeContourTreeMaps();
+
+        for (NodeIterator<ContourTree> it(contour_tree); !it.done(); ++it)
+        {
+            Node node = getLandscapeTreeNode(it.node());
+            if (!this->isNodeValid(node) || getContourTreeNode(node) != it.node()) {
+                return false;
+            }
+        }
+
+        for (EdgeIterator<ContourTree> it(contour_tree); !it.done(); ++it)
+        {
+            Arc arc = getLandscapeTreeArc(it.edge());
+            if (!this->isArcValid(arc) || getContourTreeEdge(arc) != it.edge()) {
+                return false;
+            }
+
+            CTNode source = getContourTreeNode(this->source(arc));
+            CTNode target = getContourTreeNode(this->target(arc));
+            CTEdge edge = it.edge();
+            if (!(source == contour_tree.u(edge) && target == contour_tree.v(edge)) &&
+                    !(source == contour_tree.v(edge) && target == contour_tree.u(edge))) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+public:
+    /// \brief Replaces the subtree below the arc after the contour tree
+    /// has been folded or expanded within it.
+    /*!
+     *  The folds must have been made on the far side of the arc's source,
+     *  as by simplifySubtree(), so that the source still has one edge
+     *  leading into the subtree, although that edge and its far node may
+     *  have changed. The arc and its target are kept, and take on the new
+     *  edge and node; the nodes below the target are replaced by a search
+     *  of the contour tree. The rest of the tree is untouched, so every
+     *  node keeps its children in the same order.
+     *
+     *  Returns false, leaving the tree unchanged, if the source no longer
+     *  has exactly one edge into the subtree: if the subtree was folded
+     *  into the source, for instance.
+     */
+    bool replaceSubtree(Arc arc)
+    {
+        typedef typename ContourTree::Node CTNode;
+        typedef typename ContourTree::Edge CTEdge;
+
+        const ContourTree& contour_tree = getContourTree();
+        Node parent = this->source(arc);
+        CTNode ct_parent = getContourTreeNode(parent);
+
+        if (!contour_tree.isNodeValid(ct_parent) ||
+                contour_tree.degree(ct_parent) != this->degree(parent)) {
+            return false;
+        }
+
+        // the edges of the parent's other arcs are outside of the subtree,
+        // and so are unchanged. The one remaining edge leads into it
+        std::vector<Identifier> other_edges;
+        for (ParentIterator<LandscapeTree> it(*this, parent); !it.done(); ++it) {
+            other_edges.push_back(contour_tree.getEdgeIdentifier(
+                    getContourTreeEdge(it.arc())));
+        }
+        for (ChildIterator<LandscapeTree> it(*this, parent); !it.done(); ++it) {
+            if (it.arc() != arc) {
+                other_edges.push_back(contour_tree.getEdgeIdentifier(
+                        getContourTreeEdge(it.arc())));
+            }
+        }
+        std::sort(other_edges.begin(), other_edges.end());
+
+        CTEdge edge;
+        size_t n_found = 0;
+        for (UndirectedNeighborIterator<ContourTree> it(contour_tree, ct_parent);
+                !it.done(); ++it)
+        {
+            if (!std::binary_search(other_edges.begin(), other_edges.end(),
+                        contour_tree.getEdgeIdentifier(it.edge()))) {
+                edge = it.edge();
+                ++n_found;
+            }
+        }
+
+        if (n_found != 1) {
+            return false;
+        }
+
+        _tree.holdNotifications();
+
+        // remove everything below the arc's target
+        Node child = this->target(arc);
+        std::vector<Node> below;
+        for (DirectedBFSIterator<LandscapeTree> it(*this, child); !it.done(); ++it) {
+            below.push_back(it.child());
+        }
+        for (size_t i=0; i<below.size(); ++i) {
+            _tree.removeNode(below[i]);
+        }
+
+        // the arc now stands for the new edge, and its target for the node
+        // across it
+        _tree.resizeContourTreeMaps();
+        CTNode ct_child = contour_tree.opposite(ct_parent, edge);
+        _tree.setContourTreeNode(child, ct_child);
+        _tree.setContourTreeEdge(arc, edge);
+
+        for (UndirectedBFSIterator<ContourTree> it(contour_tree, ct_parent, ct_child);
+                !it.done(); ++it) {
+            _tree.addNode(it.child());
+            _tree.addArc(
+                _tree.getLandscapeTreeNode(it.parent()),
+                _tree.getLandscapeTreeNode(it.child()),
+                it.edge());
+        }
+
+        _tree.releaseNotifications();
+        return true;
+    }
+
+    /// \brief Roots the tree at the node of the contour tree.
+    /*!
+     *  Only the arcs on the path from the new root to the old one change
+     *  direction, so rather than building the tree again, the children of
+     *  the nodes on the path are found again from the contour tree. Every
+     *  other node keeps its arcs, and the nodes and arcs keep their
+     *  identifiers. The children come out in the order a new tree rooted
+     *  at the node would give them.
+     *
+     *  Returns false, leaving the tree unchanged, if the node is not in the
+     *  contour tree, or if the contour tree has been folded or expanded
+     *  since the tree was built, other than by replaceSubtree(). The tree
+     *  must then be built again.
+     */
+    bool changeRoot(typename ContourTree::Node ct_root)
+    {
+        const ContourTree& contour_tree = getContourTree();
+        if (!contour_tree.isNodeValid(ct_root) || !matchesContourTree()) {
+            return false;
+        }
+
+        // the path from the new root up to the old one, each node followed
+        // by its parent
+        std::vector<Node> path;
+        path.push_back(getLandscapeTreeNode(ct_root));
+        while (path.back() != getRoot()) {
+            ParentIterator<LandscapeTree> it(*this, path.back());
+            path.push_back(it.parent());
+        }
+
+        _tree.holdNotifications();
+
+        for (size_t i=0; i<path.size(); ++i)
+        {
+            std::vector<Arc> children;
+            for (ChildIterator<LandscapeTree> it(*this, path[i]); !it.done(); ++it) {
+                children.push_back(it.arc());
+            }
+            for (size_t j=0; j<children.size(); ++j) {
+                _tree.removeArc(children[j]);
+            }
+        }
+
+        // each node on the path is now the child of the node before it
+        for (size_t i=0; i<path.size(); ++i)
+        {
+            typename ContourTree::Node ct_node = getContourTreeNode(path[i]);
+            for (UndirectedNeighborIterator<ContourTree> it(contour_tree, ct_node);
+                    !it.done(); ++it)
+            {
+                Node neighbor = getLandscapeTreeNode(it.neighbor());
+                if (i == 0 || neighbor != path[i-1]) {
+                    _tree.addArc(path[i], neighbor, it.edge());
+                }
+            }
+        }
+
+        _tree.setRoot(path[0]);
+        _tree.releaseNotifications();
+        return true;
     }
 
     /// \brief Get the root of the landscape tree.
@@ -204,6 +501,11 @@ public:
         return _tree.getRoot();
     }
 
+    /// \brief Get the contour tree the landscape tree was built from.
+    const ContourTree& getContourTree() const {
+        return _tree.getContourTree();
+    }
+
     /// \brief Retrieve the corresponding node in the contour tree.
     typename ContourTree::Node getContourTreeNode(Node node) const
     {
@@ -235,7 +537,7 @@ public:
     }
 
     /// \brief Get the ID of the node.
-    unsigned int getID(Node node) const
+    Identifier getID(Node node) const
     {
         return _tree.getID(node);
     }
@@ -247,7 +549,7 @@ public:
     }
 
     /// \brief Get the node from an ID.
-    Node getNode(unsigned int id) const
+    Node getNode(Identifier id) const
     {
         return _tree.getNode(id);
     }
@@ -260,6 +562,15 @@ public:
 };
 
 
+/// \brief Requests that landscape weights be read from the contour tree.
+/// \ingroup landscape
+/*!
+ *  The contour tree must provide getNodeWeight, getEdgeWeight and
+ *  getSubtreeWeight, as FoldedContourTree does.
+ */
+struct ContourTreeWeights {};
+
+
 /// \brief Represents weights of nodes and arcs in the landscape tree.
 /// \ingroup landscape
 /*!
@@ -284,9 +595,12 @@ class LandscapeWeights
 
     WeightMap* _weight_map;
 
+    // true if the weights are read from the contour tree
+    bool _read_from_contour_tree;
+
 private:
 
-    double lookupWeight(unsigned int node_id)
+    double lookupWeight(Identifier node_id)
     {
         // find the weight in the map
         WeightMap::iterator weight_it = _weight_map->find(node_id);
@@ -327,18 +641,64 @@ private:
         return sumMemberWeights(members);
     }
 
-    void initializeWeights()
+    /// \brief Reads the weights from the contour tree. The total weight of
+    /// a child is the weight on its side of its arc, which the contour tree
+    /// keeps up to date as it is folded, so no pass up the tree is needed.
+    void readWeights()
+    {
+        typedef typename LandscapeTree::ContourTreeType ContourTree;
+        const ContourTree& contour_tree = _tree.getContourTree();
+
+        Node root = _tree.getRoot();
+        double root_weight = contour_tree.getNodeWeight(
+                _tree.getContourTreeNode(root));
+        _node_to_weight[root] = root_weight;
+
+        double root_total_weight = root_weight;
+        for (DirectedBFSIterator<LandscapeTree> it(_tree, root);
+                !it.done(); ++it)
+        {
+            readArcWeights(it.arc());
+
+            if (it.parent() == root) {
+                root_total_weight += _arc_to_weight[it.arc()] +
+                        _node_to_total_weight[it.child()];
+            }
+        }
+
+        _node_to_total_weight[root] = root_total_weight;
+    }
+
+    /// \brief Reads the weights of the arc and of its child from the
+    /// contour tree.
+    void readArcWeights(Arc arc)
+    {
+        typedef typename LandscapeTree::ContourTreeType ContourTree;
+        const ContourTree& contour_tree = _tree.getContourTree();
+
+        typename ContourTree::Edge edge = _tree.getContourTreeEdge(arc);
+        typename ContourTree::Node child =
+                _tree.getContourTreeNode(_tree.target(arc));
+
+        _arc_to_weight[arc] = contour_tree.getEdgeWeight(edge);
+        _node_to_weight[_tree.target(arc)] = contour_tree.getNodeWeight(child);
+        _node_to_total_weight[_tree.target(arc)] =
+                contour_tree.getSubtreeWeight(edge, child);
+    }
+
+    /// \brief Sums the members of the node and of everything below it.
+    void computeSubtreeWeights(Node top)
     {
         // first, build a stack of the nodes in order of BFS visit, while recording
         // their weights
         std::stack<Node> _bfs_nodes;
 
-        // handle the root node
-        _node_to_weight[_tree.getRoot()] = computeNodeWeight(_tree.getRoot());
-        _bfs_nodes.push(_tree.getRoot());
+        // handle the top node
+        _node_to_weight[top] = computeNodeWeight(top);
+        _bfs_nodes.push(top);
 
         // handle the rest of the nodes
-        for (DirectedBFSIterator<LandscapeTree> it(_tree, _tree.getRoot());
+        for (DirectedBFSIterator<LandscapeTree> it(_tree, top);
                 !it.done(); ++it) {
 
             _bfs_nodes.push(it.child());
@@ -366,21 +726,74 @@ private:
         }
     }
 
+    void initializeWeights()
+    {
+        computeSubtreeWeights(_tree.getRoot());
+    }
+
 public:
     LandscapeWeights(const LandscapeTree& tree)
         : _tree(tree), _node_to_weight(_tree), _node_to_total_weight(_tree),
-          _arc_to_weight(_tree), _weight_map(0)
+          _arc_to_weight(_tree), _weight_map(0),
+          _read_from_contour_tree(false)
     {
         initializeWeights();
     }
 
     LandscapeWeights(const LandscapeTree& tree, WeightMap* weight_map)
         : _tree(tree), _node_to_weight(_tree), _node_to_total_weight(_tree),
-          _arc_to_weight(_tree), _weight_map(weight_map)
+          _arc_to_weight(_tree), _weight_map(weight_map),
+          _read_from_contour_tree(false)
     {
         initializeWeights();
     }
 
+    /// \brief Reads the weights from the contour tree instead of summing
+    /// the members of the whole tree.
+    LandscapeWeights(const LandscapeTree& tree, ContourTreeWeights)
+        : _tree(tree), _node_to_weight(_tree), _node_to_total_weight(_tree),
+          _arc_to_weight(_tree), _weight_map(0),
+          _read_from_contour_tree(true)
+    {
+        readWeights();
+    }
+
+    /// \brief Recomputes every weight, after the tree has been rooted
+    /// elsewhere. See LandscapeTree::changeRoot().
+    void recompute()
+    {
+        if (_read_from_contour_tree) {
+            readWeights();
+        } else {
+            initializeWeights();
+        }
+    }
+
+    /// \brief Recomputes the weights of the arc and of everything below it,
+    /// after the subtree has been replaced.
+    /*!
+     *  The subtree holds the same members as before, so the weights above
+     *  it are unchanged.
+     */
+    void updateSubtree(Arc arc)
+    {
+        _node_to_weight.resize();
+        _node_to_total_weight.resize();
+        _arc_to_weight.resize();
+
+        if (_read_from_contour_tree)
+        {
+            readArcWeights(arc);
+            for (DirectedBFSIterator<LandscapeTree> it(_tree, _tree.target(arc));
+                    !it.done(); ++it) {
+                readArcWeights(it.arc());
+            }
+        } else {
+            _arc_to_weight[arc] = computeArcWeight(arc);
+            computeSubtreeWeights(_tree.target(arc));
+        }
+    }
+
     /// \brief Get the total weight of the node.
     double getTotalNodeWeight(Node node) const {
         return _node_to_total_weight[node];
@@ -25,9 +25,12 @@
 #ifndef DENALI_MAPPABLE_LIST_H
 #define DENALI_MAPPABLE_LIST_H
 
+#include <cassert>
 #include <list>
 #include <vector>
 
+#include <denali/identifiers.h>
+
 namespace denali {
 
 /// \brief A list supporting random access.
@@ -38,7 +41,7 @@ class MappableListBase
     struct ElementRep
     {
         bool valid;
-        int prev_element, next_element;
+        Index prev_element, next_element;
         Value value;
 
         ElementRep(const Value& value) : valid(true), value(value) {}
@@ -47,8 +50,8 @@ class MappableListBase
     size_t _size;
     std::vector<ElementRep> _elements;
 
-    int _first_element;
-    int _first_free_element;
+    Index _first_element;
+    Index _first_free_element;
 
 public:
 
@@ -58,11 +61,11 @@ public:
             _size(0), _first_element(-1), _first_free_element(-1)
     {}
 
-    ValueType& operator[](int n) { 
+    ValueType& operator[](Index n) { 
         return _elements[n].value; 
     }
 
-    const ValueType& operator[](int n) const { 
+    const ValueType& operator[](Index n) const { 
         return _elements[n].value; 
     }
 
@@ -71,9 +74,9 @@ public:
     }
 
     /// \brief Insert a value into the structure, returning an element.
-    int insert(const Value& value)
+    Index insert(const Value& value)
     {
-        int n;
+        Index n;
 
         // if there isn't a free element, we push a new one
         if (_first_free_element == -1)
@@ -103,7 +106,7 @@ public:
     }
 
     /// \brief Remove the element.
-    void remove(int n)
+    void remove(Index n)
     {
         if (_elements[n].next_element != -1) {
             _elements[_elements[n].next_element].prev_element = _elements[n].prev_element;
@@ -124,21 +127,76 @@ public:
         _size--;
     }
 
-    bool isValid(int n) const {
-        return n >= 0 && n < _elements.size() && _elements[n].valid;
+    bool isValid(Index n) const {
+        return n >= 0 && (size_t) n < _elements.size() && _elements[n].valid;
     }
 
-    int getFirst() const {
+    Index getFirst() const {
         return _first_element;
     }
 
-    int getNext(int n) const {
+    Index getNext(Index n) const {
         return _elements[n].next_element;
     }
 
-    int getMaxIdentifier() const {
+    Index getMaxIdentifier() const {
         return _elements.size();
     }
+
+    /// \brief The first valid element in index order, or -1.
+    Index getFirstByIndex() const {
+        return getNextByIndex(-1);
+    }
+
+    /// \brief The next valid element in index order, or -1.
+    Index getNextByIndex(Index n) const
+    {
+        for (++n; (size_t) n < _elements.size(); ++n)
+        {
+            if (_elements[n].valid) {
+                return n;
+            }
+        }
+
+        return -1;
+    }
+
+    /// \brief Moves the valid elements to the front and frees the rest.
+    /*!
+     *  Elements keep their relative order, and afterwards the list order is
+     *  the index order. new_indices is filled with the new index of every
+     *  old element, or -1 for an element which had been removed.
+     */
+    void compact(std::vector<Index>& new_indices)
+    {
+        new_indices.assign(_elements.size(), -1);
+
+        // every element moves down or stays put, so this is done in place
+        Index n = 0;
+        for (size_t i=0; i<_elements.size(); ++i)
+        {
+            if (_elements[i].valid)
+            {
+                new_indices[i] = n;
+                if ((size_t) n != i) {
+                    _elements[n] = _elements[i];
+                }
+                n++;
+            }
+        }
+
+        _elements.erase(_elements.begin() + n, _elements.end());
+        std::vector<ElementRep>(_elements).swap(_elements);
+
+        for (Index i=0; i<n; ++i)
+        {
+            _elements[i].prev_element = i-1;
+            _elements[i].next_element = i+1 < n ? i+1 : -1;
+        }
+
+        _first_element = n > 0 ? 0 : -1;
+        _first_free_element = -1;
+    }
 };
 
 
@@ -147,7 +205,7 @@ template <typename MappableList>
 class MappableListIterator
 {
 
-    int _index;
+    Index _index;
     MappableList& _mlist;
 
 public:
@@ -155,7 +213,7 @@ public:
     typedef typename MappableList::ValueType ValueType;
 
     MappableListIterator(MappableList& mlist) :
-            _mlist(mlist), _index(mlist.getFirst()) 
+            _index(mlist.getFirst()), _mlist(mlist)
     { }
 
     bool done() const {
@@ -177,6 +235,50 @@ public:
 };
 
 
+/// \brief An iterator over the items in a mappable list in index order.
+/*!
+ *  Unlike MappableListIterator, which follows the list from the most
+ *  recently inserted element, this visits the elements in the order in
+ *  which they are stored.
+ */
+template <typename MappableList>
+class MappableListIndexIterator
+{
+
+    Index _index;
+    MappableList& _mlist;
+
+public:
+
+    typedef typename MappableList::ValueType ValueType;
+
+    MappableListIndexIterator(MappableList& mlist) :
+            _index(mlist.getFirstByIndex()), _mlist(mlist)
+    { }
+
+    bool done() const {
+        return _index == -1;
+    }
+
+    void operator++() {
+        _index = _mlist.getNextByIndex(_index);
+    }
+
+    Index index() const {
+        return _index;
+    }
+
+    ValueType& operator*() { 
+        return _mlist[_index]; 
+    }
+
+    const ValueType& operator*() const { 
+        return _mlist[_index]; 
+    }
+
+};
+
+
 template <typename Super>
 class ObservableMappableListMixin : public Super
 {
@@ -188,20 +290,60 @@ public:
     {
     public:
         virtual void notify() const = 0;
+
+        /// \brief Called after compaction with the new index of every old
+        /// element, or -1 for removed elements.
+        virtual void remap(const std::vector<Index>& new_indices) const = 0;
+
         ~Observer() {}
     };
 
-    int insert(const ValueType& value) {
-        int n = Super::insert(value);
+    ObservableMappableListMixin() :
+            _held_notifications(0), _notification_pending(false),
+            _notified_size(0)
+    {}
+
+    Index insert(const ValueType& value) {
+        Index n = Super::insert(value);
         notify();
         return n;
     }
 
-    void remove(int id) {
+    void remove(Index id) {
         Super::remove(id);
         notify();
     }
 
+    /// \brief Compacts the list, then tells each observer where the
+    /// elements went.
+    void compact(std::vector<Index>& new_indices)
+    {
+        Super::compact(new_indices);
+
+        for (typename Observers::const_iterator it = _observers.begin();
+                it != _observers.end(); ++it)
+        {
+            (*it)->remap(new_indices);
+        }
+
+        _notified_size = this->getMaxIdentifier();
+        _notification_pending = false;
+    }
+
+    /// \brief Defers notifications that do not grow the identifier space.
+    void holdNotifications() {
+        _held_notifications++;
+    }
+
+    /// \brief Fires the notification deferred since holdNotifications().
+    void releaseNotifications()
+    {
+        assert(_held_notifications > 0);
+        if (--_held_notifications == 0 && _notification_pending) {
+            notify();
+        }
+    }
+
     void attachObserver(Observer& observer) {
         _observers.push_back(&observer);
     }
@@ -214,13 +356,26 @@ private:
     typedef std::list<Observer*> Observers;
     Observers _observers;
 
-    void notify() const
+    int _held_notifications;
+    bool _notification_pending;
+    size_t _notified_size;
+
+    void notify()
     {
+        if (_held_notifications > 0 &&
+                (size_t) this->getMaxIdentifier() <= _notified_size) {
+            _notification_pending = true;
+            return;
+        }
+
         for (typename Observers::const_iterator it = _observers.begin();
                 it != _observers.end(); ++it)
         {
             (*it)->notify();
         }
+
+        _notified_size = this->getMaxIdentifier();
+        _notification_pending = false;
     }
 
 };
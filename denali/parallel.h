@@ -0,0 +1,193 @@
+// Copyright (c) 2014, Justin Eldridge, Mikhail Belkin, and Yusu Wang
+// at The Ohio State University. All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef DENALI_PARALLEL_H
+#define DENALI_PARALLEL_H
+
+#include <algorithm>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/// \file
+/// \brief Low-level primitives shared by the parallel algorithms.
+/*!
+ *  Parallelism in denali is provided by OpenMP. When the library is compiled
+ *  without OpenMP support, every primitive in this file degrades to its
+ *  serial equivalent, and the parallel algorithms built upon them produce
+ *  the same results on a single thread.
+ */
+
+namespace denali {
+namespace parallel {
+
+/// \brief Returns the number of threads available to a parallel region.
+/// \ingroup parallel
+inline int numberOfThreads()
+{
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+
+/// \brief Returns the index of the calling thread within a parallel region.
+/// \ingroup parallel
+inline int threadIndex()
+{
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+
+/// \brief Reads a value that may be concurrently written by another thread.
+/// \ingroup parallel
+template <typename T>
+inline T load(const T& location)
+{
+    return *const_cast<const volatile T*>(&location);
+}
+
+
+/// \brief Atomically replaces the value at the location if it equals expected.
+/// \ingroup parallel
+/*!
+ *  Returns true if the swap took place. The operation acts as a full
+ *  memory barrier.
+ */
+template <typename T>
+inline bool compareAndSwap(T& location, T expected, T desired)
+{
+#if defined(_OPENMP) && defined(__GNUC__)
+    return __sync_bool_compare_and_swap(&location, expected, desired);
+#elif defined(_OPENMP)
+    bool swapped = false;
+    #pragma omp critical (denali_compare_and_swap)
+    {
+        if (location == expected)
+        {
+            location = desired;
+            swapped = true;
+        }
+    }
+    return swapped;
+#else
+    if (location == expected)
+    {
+        location = desired;
+        return true;
+    }
+    return false;
+#endif
+}
+
+
+/// \brief Atomically adds to the value at the location, returning the old value.
+/// \ingroup parallel
+template <typename T>
+inline T fetchAndAdd(T& location, T increment)
+{
+#if defined(_OPENMP) && defined(__GNUC__)
+    return __sync_fetch_and_add(&location, increment);
+#elif defined(_OPENMP)
+    T old;
+    #pragma omp critical (denali_fetch_and_add)
+    {
+        old = location;
+        location += increment;
+    }
+    return old;
+#else
+    T old = location;
+    location += increment;
+    return old;
+#endif
+}
+
+
+/// \brief Replaces each element by the sum of the elements preceding it.
+/// \ingroup parallel
+/*!
+ *  Returns the sum of all of the elements. The scan is performed in two
+ *  passes over contiguous blocks, one block per thread.
+ */
+template <typename T>
+T exclusiveScan(std::vector<T>& values)
+{
+    long n = values.size();
+    int n_blocks = numberOfThreads();
+    if (n_blocks > n)
+    {
+        n_blocks = n > 0 ? n : 1;
+    }
+
+    std::vector<T> block_sums(n_blocks + 1, T());
+    long block_size = (n + n_blocks - 1) / n_blocks;
+
+    // first pass: sum each block independently
+    #pragma omp parallel for
+    for (int b = 0; b < n_blocks; ++b)
+    {
+        long end = std::min(n, (b + 1) * block_size);
+        T sum = T();
+        for (long i = b * block_size; i < end; ++i)
+        {
+            sum += values[i];
+        }
+        block_sums[b + 1] = sum;
+    }
+
+    for (int b = 0; b < n_blocks; ++b)
+    {
+        block_sums[b + 1] += block_sums[b];
+    }
+
+    // second pass: scan each block, starting from the offset of the block
+    #pragma omp parallel for
+    for (int b = 0; b < n_blocks; ++b)
+    {
+        long end = std::min(n, (b + 1) * block_size);
+        T sum = block_sums[b];
+        for (long i = b * block_size; i < end; ++i)
+        {
+            T value = values[i];
+            values[i] = sum;
+            sum += value;
+        }
+    }
+
+    return block_sums[n_blocks];
+}
+
+}
+}
+
+#endif
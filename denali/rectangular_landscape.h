@@ -29,13 +29,17 @@
 #include <denali/graph_maps.h>
 #include <denali/graph_mixins.h>
 #include <denali/landscape.h>
+#include <denali/parallel.h>
 #include <denali/rectangular_landscape.h>
 
 #include <boost/shared_ptr.hpp>
 
+#include <algorithm>
 #include <cmath>
 #include <stack>
 #include <stdexcept>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace denali {
@@ -48,18 +52,32 @@ class RectangleSplit;
 class OrientedRectangleSplit;
 class HorizontalRectangleSplit;
 class VerticalRectangleSplit;
+class SquarifiedRectangleSplit;
 
 template <typename LandscapeTree> class Embedding;
+template <typename LandscapeTree> class EmbeddingLayout;
+struct LevelOfDetail;
+
+/// \brief How the rectangle of each node is split among its children:
+/// into slices, alternating between horizontal and vertical at each level,
+/// or into the rows of a squarified treemap.
+enum Tiling { SLICE_AND_DICE, SQUARIFIED };
+
 template <typename LandscapeTree> class Embedder;
 template <typename LandscapeTree> struct EmbeddingParameters;
 
 template <typename LandscapeTree> class Triangularization;
 template <typename LandscapeTree> class Triangularizer;
 
+class IndexBuffer;
+class IndexedMesh;
+template <typename LandscapeTree> class MeshIndexer;
+
 }
 
 template <typename ContourTree> class RectangularLandscape;
 template <typename ContourTree> class RectangularLandscapeBuilder;
+template <typename ContourTree> class SquarifiedLandscapeBuilder;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -279,6 +297,51 @@ public:
 };
 
 
+/// \brief A split into rows of rectangles, as made by a squarified treemap.
+/*!
+ *  The points are the distinct corners of the rectangles. The first four
+ *  are the corners of the whole rectangle, and each row adds two points
+ *  where it is cut from the rest and two for each rectangle after its
+ *  first, except that the last row is not cut. There are thus 2n+2
+ *  points, as in the other splits.
+ */
+class denali::rectangular::SquarifiedRectangleSplit : public OrientedRectangleSplit
+{
+    std::vector<Rectangle::Point> points;
+    std::vector<size_t> rectangle_corners;
+
+public:
+    /// \brief Adds a point, returning its index.
+    size_t addPoint(double x, double y)
+    {
+        points.push_back(Rectangle::Point(x, y));
+        return points.size() - 1;
+    }
+
+    /// \brief Sets the points at the sw, se, ne and nw corners of the
+    /// rectangles, in order.
+    void setRectangleCorners(const std::vector<size_t>& corners)
+    {
+        rectangle_corners = corners;
+    }
+
+    virtual Rectangle::Point getBoundaryPoint(size_t i) const
+    {
+        return points[i];
+    }
+
+    virtual size_t getIndexOfCorner(size_t i) const
+    {
+        return i;
+    }
+
+    size_t getIndexOfRectangleCorner(size_t rectangle, size_t corner) const
+    {
+        return rectangle_corners[4*rectangle + corner];
+    }
+};
+
+
 class denali::rectangular::RectangleSplit
 {
     boost::shared_ptr<OrientedRectangleSplit> split;
@@ -329,18 +392,29 @@ private:
     std::vector<double> weights;
     double sum_of_weights;
     bool horizontal_;
+    bool squarified_;
 
 public:
     RectangleSplitter(Rectangle rectangle) :
-        rectangle(rectangle), sum_of_weights(0), horizontal_(true)
+        rectangle(rectangle), sum_of_weights(0), horizontal_(true),
+        squarified_(false)
     {}
 
     RectangleSplitter& horizontally() {
         horizontal_ = true;
+        squarified_ = false;
         return *this;
     }
     RectangleSplitter& vertically() {
         horizontal_ = false;
+        squarified_ = false;
+        return *this;
+    }
+
+    /// \brief Splits into rows of rectangles which are as near to square as
+    /// a squarified treemap makes them, rather than into slices.
+    RectangleSplitter& squarified() {
+        squarified_ = true;
         return *this;
     }
 
@@ -356,7 +430,9 @@ public:
     }
 
     RectangleSplit split() const {
-        if (horizontal_) {
+        if (squarified_) {
+            return splitSquarified();
+        } else if (horizontal_) {
             return splitHorizontally();
         } else {
             return splitVertically();
@@ -412,6 +488,163 @@ private:
         return RectangleSplit(vsplit);
     }
 
+    /// \brief The worst aspect ratio in a row of rectangles laid along a side
+    /// of the given length, where the areas of the row sum to the given sum.
+    static double worstAspectRatio(
+        double min_area,
+        double max_area,
+        double sum,
+        double side)
+    {
+        double side_squared = side * side;
+        double sum_squared = sum * sum;
+        return std::max(side_squared * max_area / sum_squared,
+                        sum_squared / (side_squared * min_area));
+    }
+
+    /// \brief Splits the rectangle into rows, as a squarified treemap does.
+    /*!
+     *  The weights are laid out from the heaviest to the lightest. Each row
+     *  runs along the shorter side of what is left of the rectangle, and
+     *  takes the next weight for as long as doing so improves the row's
+     *  worst aspect ratio. The rectangles are nonetheless numbered in the
+     *  order that their weights were added.
+     */
+    RectangleSplit splitSquarified() const
+    {
+        boost::shared_ptr<SquarifiedRectangleSplit> ssplit =
+            boost::shared_ptr<SquarifiedRectangleSplit>(new SquarifiedRectangleSplit());
+
+        // sorting the negated weights puts the heaviest first, breaking
+        // ties by the order the weights were added
+        std::vector<std::pair<double, size_t> > order;
+        for (size_t i=0; i<weights.size(); ++i) {
+            order.push_back(std::make_pair(-weights[i], i));
+        }
+        std::sort(order.begin(), order.end());
+
+        double scale = rectangle.area() / sum_of_weights;
+
+        // what is left of the rectangle, and the indices of its corners
+        double x0 = rectangle.sw().x(), y0 = rectangle.sw().y();
+        double x1 = rectangle.ne().x(), y1 = rectangle.ne().y();
+        size_t sw = ssplit->addPoint(x0, y0);
+        size_t se = ssplit->addPoint(x1, y0);
+        size_t ne = ssplit->addPoint(x1, y1);
+        size_t nw = ssplit->addPoint(x0, y1);
+
+        std::vector<Rectangle> rectangles(weights.size(), rectangle);
+        std::vector<size_t> corners(4*weights.size());
+
+        size_t first = 0;
+        while (first < order.size())
+        {
+            // a row along the left side if the rest is wide, else along
+            // the bottom
+            bool along_left = x1 - x0 >= y1 - y0;
+            double side = along_left ? y1 - y0 : x1 - x0;
+
+            double max_area = -order[first].first * scale;
+            double min_area = max_area;
+            double sum = max_area;
+
+            size_t last = first + 1;
+            for (; last < order.size(); ++last)
+            {
+                double area = -order[last].first * scale;
+                if (worstAspectRatio(area, max_area, sum + area, side) >
+                        worstAspectRatio(min_area, max_area, sum, side)) {
+                    break;
+                }
+                min_area = area;
+                sum += area;
+            }
+
+            // the last row takes exactly what is left
+            bool last_row = last == order.size();
+
+            if (along_left)
+            {
+                double x = last_row ? x1 : x0 + sum / side;
+                size_t cut_s = last_row ? se : ssplit->addPoint(x, y0);
+                size_t cut_n = last_row ? ne : ssplit->addPoint(x, y1);
+
+                // stack the row's rectangles from the bottom up
+                size_t lower_w = sw, lower_e = cut_s;
+                double y = y0;
+                for (size_t k=first; k<last; ++k)
+                {
+                    size_t upper_w = nw, upper_e = cut_n;
+                    double top = y1;
+                    if (k + 1 < last) {
+                        top = y + (-order[k].first * scale) / (x - x0);
+                        upper_w = ssplit->addPoint(x0, top);
+                        upper_e = ssplit->addPoint(x, top);
+                    }
+
+                    size_t i = order[k].second;
+                    rectangles[i] = Rectangle((x0 + x)/2, (y + top)/2, x - x0, top - y);
+                    corners[4*i] = lower_w;
+                    corners[4*i + 1] = lower_e;
+                    corners[4*i + 2] = upper_e;
+                    corners[4*i + 3] = upper_w;
+
+                    lower_w = upper_w;
+                    lower_e = upper_e;
+                    y = top;
+                }
+
+                x0 = x;
+                sw = cut_s;
+                nw = cut_n;
+            }
+            else
+            {
+                double y = last_row ? y1 : y0 + sum / side;
+                size_t cut_w = last_row ? nw : ssplit->addPoint(x0, y);
+                size_t cut_e = last_row ? ne : ssplit->addPoint(x1, y);
+
+                // place the row's rectangles from left to right
+                size_t left_s = sw, left_n = cut_w;
+                double x = x0;
+                for (size_t k=first; k<last; ++k)
+                {
+                    size_t right_s = se, right_n = cut_e;
+                    double right = x1;
+                    if (k + 1 < last) {
+                        right = x + (-order[k].first * scale) / (y - y0);
+                        right_s = ssplit->addPoint(right, y0);
+                        right_n = ssplit->addPoint(right, y);
+                    }
+
+                    size_t i = order[k].second;
+                    rectangles[i] = Rectangle((x + right)/2, (y0 + y)/2, right - x, y - y0);
+                    corners[4*i] = left_s;
+                    corners[4*i + 1] = right_s;
+                    corners[4*i + 2] = right_n;
+                    corners[4*i + 3] = left_n;
+
+                    left_s = right_s;
+                    left_n = right_n;
+                    x = right;
+                }
+
+                y0 = y;
+                sw = cut_w;
+                se = cut_e;
+            }
+
+            first = last;
+        }
+
+        for (size_t i=0; i<rectangles.size(); ++i) {
+            ssplit->addRectangle(rectangles[i]);
+        }
+        ssplit->setRectangleCorners(corners);
+
+        return RectangleSplit(ssplit);
+    }
+
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -428,10 +661,10 @@ public:
     class Point
     {
         double _x, _y, _z;
-        unsigned int _id;
+        Identifier _id;
 
     public:
-        Point(double x, double y, double z, unsigned int id)
+        Point(double x, double y, double z, Identifier id)
             : _x(x), _y(y), _z(z), _id(id) { }
 
         double x() const {
@@ -443,7 +676,7 @@ public:
         double z() const {
             return _z;
         }
-        unsigned int id() const {
+        Identifier id() const {
             return _id;
         }
     };
@@ -451,44 +684,228 @@ public:
 private:
     typedef typename LandscapeTree::Node Node;
     typedef typename LandscapeTree::Arc Arc;
-    typedef std::vector<Point> Points;
+
+    // the points owned by a node are contiguous, so each node records only
+    // where they begin, along with the indices of the corners of its
+    // contour and of its container. This keeps every node's points in one
+    // flat map instead of three lists of its own
+    struct NodePoints
+    {
+        size_t offset;
+        size_t n_points;
+        Identifier corners[4];
+        Identifier containers[4];
+        unsigned char n_corners;
+        unsigned char n_containers;
+
+        NodePoints() : offset(0), n_points(0), n_corners(0), n_containers(0) {}
+    };
 
     const LandscapeTree& _tree;
-    Points _points;
-    StaticNodeMap<LandscapeTree, Points> _contour_points;
-    StaticNodeMap<LandscapeTree, Points> _contour_corners;
-    StaticNodeMap<LandscapeTree, Points> _contour_containers;
+    std::vector<Point> _points;
+    StaticNodeMap<LandscapeTree, NodePoints> _node_points;
 
     Point _max_point;
     Point _min_point;
 
+    void addOwnedPoint(size_t index, Node owner)
+    {
+        NodePoints& node_points = _node_points[owner];
+        if (node_points.n_points == 0) {
+            node_points.offset = index;
+        }
+        ++node_points.n_points;
+    }
+
+    void insertSplitCorners(
+        const RectangleSplit& split,
+        Node owner,
+        size_t first_index)
+    {
+        // keep track of the corners of the contour
+        for (int i=0; i<4; ++i) {
+            insertCornerPoint(_points[first_index + split.getIndexOfCorner(i)], owner);
+        }
+
+        // associate each child of this node with its proper container
+        unsigned int i = 0;
+        for (ChildIterator<LandscapeTree> it(_tree, owner);
+                !it.done(); ++it) {
+            for (int j=0; j<4; ++j) {
+                size_t index = split.getIndexOfRectangleCorner(i, j);
+                insertContainerPoint(_points[first_index + index], it.child());
+            }
+            ++i;
+        }
+    }
+
 public:
 
     Embedding(const LandscapeTree& tree)
-        : _tree(tree), _contour_points(tree), _contour_corners(tree),
-          _contour_containers(tree), _max_point(0,0,0,0), _min_point(0,0,0,0) { }
+        : _tree(tree), _node_points(tree), _max_point(0,0,0,0),
+          _min_point(0,0,0,0) { }
+
+    /// \brief Makes room to insert the points without reallocating.
+    void reserve(size_t n_points)
+    {
+        _points.reserve(n_points);
+    }
 
     void insertCornerPoint(Point point, Node owner)
     {
-        _contour_corners[owner].push_back(point);
+        NodePoints& node_points = _node_points[owner];
+        node_points.corners[node_points.n_corners++] = point.id();
     }
 
     void insertContainerPoint(Point point, Node owner)
     {
-        _contour_containers[owner].push_back(point);
+        NodePoints& node_points = _node_points[owner];
+        node_points.containers[node_points.n_containers++] = point.id();
+    }
+
+    /// \brief Removes every point, so that the tree may be embedded again.
+    void clear()
+    {
+        _points.clear();
+        _node_points.fill(NodePoints());
+        _max_point = Point(0,0,0,0);
+        _min_point = Point(0,0,0,0);
+    }
+
+    /// \brief Makes room for the points, which are then placed by index
+    /// rather than inserted.
+    void resize(size_t n_points)
+    {
+        _points.assign(n_points, Point(0,0,0,0));
+    }
+
+    /// \brief Places a point at an index of a resized embedding.
+    /*!
+     *  Points of different owners may be placed concurrently. The least and
+     *  greatest points are not tracked; see findExtremePoints().
+     */
+    Point placePoint(size_t index, double x, double y, Node owner)
+    {
+        Point point(x, y, _tree.getValue(owner), index);
+        _points[index] = point;
+        addOwnedPoint(index, owner);
+        return point;
+    }
+
+    /// \brief Places the boundary points of the split, starting at an index.
+    void placeSplit(const RectangleSplit& split, Node owner, size_t first_index)
+    {
+        for (size_t i=0; i<split.size(); ++i) {
+            Rectangle::Point boundary_point = split.getBoundaryPoint(i);
+            placePoint(first_index + i, boundary_point.x(), boundary_point.y(), owner);
+        }
+
+        insertSplitCorners(split, owner, first_index);
+    }
+
+    /// \brief Makes room for the points of a subtree which is to be embedded
+    /// again in place of its old points, which lie between first and last.
+    /*!
+     *  The points after the old ones are moved along, and every reference
+     *  to them is renumbered. The nodes below the top node forget their
+     *  points, as does the top node, except for its container, which lies
+     *  in its parent's split. The new points are then placed.
+     */
+    void replacePoints(Node top, size_t first, size_t last, size_t n_points)
+    {
+        _node_points.resize();
+
+        size_t new_last = first + n_points;
+        if (new_last > last) {
+            _points.insert(_points.begin() + last, new_last - last, Point(0,0,0,0));
+        } else {
+            _points.erase(_points.begin() + new_last, _points.begin() + last);
+        }
+
+        for (size_t i=new_last; i<_points.size(); ++i) {
+            const Point& point = _points[i];
+            _points[i] = Point(point.x(), point.y(), point.z(), i);
+        }
+
+        for (NodeIterator<LandscapeTree> it(_tree); !it.done(); ++it)
+        {
+            NodePoints& node_points = _node_points[it.node()];
+            if (node_points.n_points > 0 && node_points.offset >= last) {
+                node_points.offset = node_points.offset - last + new_last;
+            }
+            for (int i=0; i<node_points.n_corners; ++i) {
+                if (node_points.corners[i] >= last) {
+                    node_points.corners[i] = node_points.corners[i] - last + new_last;
+                }
+            }
+            for (int i=0; i<node_points.n_containers; ++i) {
+                if (node_points.containers[i] >= last) {
+                    node_points.containers[i] = node_points.containers[i] - last + new_last;
+                }
+            }
+        }
+
+        NodePoints& top_points = _node_points[top];
+        top_points.offset = 0;
+        top_points.n_points = 0;
+        top_points.n_corners = 0;
+
+        for (DirectedBFSIterator<LandscapeTree> it(_tree, top); !it.done(); ++it) {
+            _node_points[it.child()] = NodePoints();
+        }
+    }
+
+    /// \brief The rectangle in which the node is nested, as given by the
+    /// corners of its container.
+    Rectangle getContainer(Node node) const
+    {
+        const NodePoints& node_points = _node_points[node];
+        const Point& first = _points[node_points.containers[0]];
+        double min_x = first.x(), max_x = first.x();
+        double min_y = first.y(), max_y = first.y();
+
+        for (int i=1; i<node_points.n_containers; ++i) {
+            const Point& point = _points[node_points.containers[i]];
+            min_x = std::min(min_x, point.x());
+            max_x = std::max(max_x, point.x());
+            min_y = std::min(min_y, point.y());
+            max_y = std::max(max_y, point.y());
+        }
+
+        return Rectangle((min_x + max_x) / 2, (min_y + max_y) / 2,
+                         max_x - min_x, max_y - min_y);
+    }
+
+    /// \brief Finds the least and greatest points after points have been
+    /// placed, breaking ties as insertion does.
+    void findExtremePoints()
+    {
+        for (size_t i=0; i<_points.size(); ++i)
+        {
+            if (i == 0) {
+                _min_point = _points[i];
+                _max_point = _points[i];
+            } else if (_points[i].z() < _min_point.z()) {
+                _min_point = _points[i];
+            } else if (_points[i].z() > _max_point.z()) {
+                _max_point = _points[i];
+            }
+        }
     }
 
+    /// \brief Inserts a point. The owner's points must be inserted
+    /// consecutively.
     Point insertPoint(double x, double y, Node owner)
     {
         // make a new point
-        unsigned int index = _points.size();
+        Identifier index = _points.size();
         Point point(x, y, _tree.getValue(owner), index);
 
         // insert the point into the vector of points
         _points.push_back(point);
 
-        // add the point to the owner's list of points
-        _contour_points[owner].push_back(point);
+        // add the point to the owner's points
+        addOwnedPoint(index, owner);
 
         // record the max and min point
         if (index == 0) {
@@ -507,65 +924,48 @@ public:
 
     void insertSplit(const RectangleSplit& split, Node owner)
     {
-        // create a point for every point in the boundary
-        std::vector<Point> inserted_points;
+        size_t first_index = _points.size();
 
+        // create a point for every point in the boundary
         for (size_t i=0; i<split.size(); ++i) {
             // get the boundary point
             Rectangle::Point boundary_point = split.getBoundaryPoint(i);
 
             // insert the new point
-            Point point = insertPoint(boundary_point.x(), boundary_point.y(), owner);
-
-            // keep track of the point
-            inserted_points.push_back(point);
-        }
-
-        // keep track of the corners of the contour
-        for (int i=0; i<4; ++i) {
-            insertCornerPoint(inserted_points[split.getIndexOfCorner(i)], owner);
+            insertPoint(boundary_point.x(), boundary_point.y(), owner);
         }
 
-        // associate each child of this node with its proper container
-        unsigned int i = 0;
-        for (ChildIterator<LandscapeTree> it(_tree, owner);
-                !it.done(); ++it) {
-            for (int j=0; j<4; ++j) {
-                int index = split.getIndexOfRectangleCorner(i, j);
-                insertContainerPoint(inserted_points[index], it.child());
-            }
-            ++i;
-        }
+        insertSplitCorners(split, owner, first_index);
     }
 
     Point getContourPoint(Node node, size_t i) const
     {
-        return _contour_points[node][i];
+        return _points[_node_points[node].offset + i];
     }
 
     Point getCornerPoint(Node node, size_t i) const
     {
-        return _contour_corners[node][i];
+        return _points[_node_points[node].corners[i]];
     }
 
     Point getContainerPoint(Node node, size_t i) const
     {
-        return _contour_containers[node][i];
+        return _points[_node_points[node].containers[i]];
     }
 
     size_t numberOfContourPoints(Node node) const
     {
-        return _contour_points[node].size();
+        return _node_points[node].n_points;
     }
 
     size_t numberOfCornerPoints(Node node) const
     {
-        return _contour_corners[node].size();
+        return _node_points[node].n_corners;
     }
 
     size_t numberOfContainerPoints(Node node) const
     {
-        return _contour_containers[node].size();
+        return _node_points[node].n_containers;
     }
 
     size_t numberOfPoints() const
@@ -591,126 +991,640 @@ public:
 };
 
 
-/// \brief The arguments kept in a stack to unroll recursion.
-template <typename LandscapeTree>
-struct denali::rectangular::EmbeddingParameters
+/// \brief The smallest subtrees that a landscape draws in full.
+/*!
+ *  A subtree whose rectangle has less than the minimum area, as a
+ *  fraction of the whole landscape, or whose arc and nodes weigh less than
+ *  the minimum weight, is drawn as one cell. The defaults draw everything.
+ */
+struct denali::rectangular::LevelOfDetail
 {
-    typedef typename LandscapeTree::Arc Arc;
-    Arc arc;
-    Rectangle parent_rectangle;
-    bool parent_orientation;
+    double min_area;
+    double min_weight;
 
-    EmbeddingParameters(Arc arc, Rectangle parent_rectangle, bool parent_orientation)
-        : arc(arc), parent_rectangle(parent_rectangle), parent_orientation(parent_orientation)
-    {}
+    explicit LevelOfDetail(double min_area = 0, double min_weight = 0)
+        : min_area(min_area), min_weight(min_weight) {}
 };
 
 
+/// \brief Where each node's points and each arc's triangles are placed.
+/*!
+ *  The embedder and triangularizer visit the arcs in the same depth-first
+ *  order, and each node's points, like each arc's triangles, are
+ *  contiguous. The layout records this order and the offsets it implies,
+ *  so that subtrees can be embedded concurrently into the same positions
+ *  as a serial embedding, whatever the schedule.
+ */
 template <typename LandscapeTree>
-class denali::rectangular::Embedder
+class denali::rectangular::EmbeddingLayout
 {
-    const LandscapeTree& _tree;
-    Embedding<LandscapeTree>& _embedding;
-    const LandscapeWeights<LandscapeTree>& _weights;
-
     typedef typename LandscapeTree::Node Node;
     typedef typename LandscapeTree::Arc Arc;
-    typedef EmbeddingParameters<LandscapeTree> Parameters;
 
-public:
-    Embedder(
-        const LandscapeTree& tree,
-        const LandscapeWeights<LandscapeTree>& weights,
-        Embedding<LandscapeTree>& embedding)
-        : _tree(tree), _embedding(embedding), _weights(weights) { }
+    typedef std::pair<Arc, double> Visit;
 
-    void embed()
-    {
-        // first, we make a rectangle for the root
-        Rectangle root_rectangle(0,0,1,1);
+    const LandscapeTree& _tree;
+    const LandscapeWeights<LandscapeTree>* _weights;
+    LevelOfDetail _level_of_detail;
 
-        RectangleSplitter splitter(root_rectangle);
+    std::vector<Arc> _arcs;
+    std::vector<size_t> _triangle_offsets;
+    StaticNodeMap<LandscapeTree, size_t> _point_offsets;
+    StaticArcMap<LandscapeTree, size_t> _subtree_sizes;
+    StaticArcMap<LandscapeTree, size_t> _arc_indices;
+    StaticNodeBitMap<LandscapeTree> _pruned;
+    size_t _n_points;
+    size_t _n_triangles;
+
+    /// \brief The weight of the subtree below the arc, including the arc.
+    static double arcWeight(const LandscapeWeights<LandscapeTree>& weights,
+                            Arc arc, Node child)
+    {
+        return weights.getArcWeight(arc) + weights.getTotalNodeWeight(child);
+    }
 
-        // now split the current rectangle according to the total volumes of the children
-        for (ChildIterator<LandscapeTree> child_it(_tree, _tree.getRoot());
-                !child_it.done(); ++child_it) 
+    /// \brief Pushes the node's child arcs, with the area of the rectangle
+    /// each is given by the split of the node's own rectangle.
+    void visitChildren(std::stack<Visit>& stack, Node node, double area)
+    {
+        double total_weight = 0;
+        if (_weights)
         {
-            double edge_weight = _weights.getArcWeight(child_it.arc()) +
-                                 _weights.getTotalNodeWeight(child_it.child());
-
-            splitter.addWeight(edge_weight);
+            for (ChildIterator<LandscapeTree> it(_tree, node); !it.done(); ++it) {
+                total_weight += arcWeight(*_weights, it.arc(), it.child());
+            }
         }
 
-        RectangleSplit split = splitter.split();
-        _embedding.insertSplit(split, _tree.getRoot());
-
-        // recursively embed the subtree
-        std::stack<Parameters> embedding_stack;
-
-        size_t i = 0;;
-        for (ChildIterator<LandscapeTree> it(_tree, _tree.getRoot());
-                !it.done(); ++it)
+        for (ChildIterator<LandscapeTree> it(_tree, node); !it.done(); ++it)
         {
-            embedding_stack.push(Parameters(it.arc(), split.getRectangle(i), true));
-            ++i;
+            double share = _weights ?
+                    arcWeight(*_weights, it.arc(), it.child()) / total_weight : 1;
+            stack.push(Visit(it.arc(), area * share));
         }
+    }
 
-        while (!embedding_stack.empty())
+    /// \brief Visits the arcs on the stack and everything below them,
+    /// appending them to the arcs in visiting order and counting their
+    /// points and triangles from the given offsets.
+    void visitStack(
+        std::stack<Visit>& stack,
+        std::vector<Arc>& arcs,
+        std::vector<size_t>& triangle_offsets,
+        size_t& n_points,
+        size_t& n_triangles)
+    {
+        while (!stack.empty())
         {
-            Parameters params = embedding_stack.top();
-            embedding_stack.pop();
+            Arc arc = stack.top().first;
+            double area = stack.top().second;
+            stack.pop();
 
-            Node node = _tree.target(params.arc);
+            Node node = _tree.target(arc);
 
-            if (_tree.outDegree(node) == 0) {
-                // the child is a leaf
-                embedLeaf(node, params.parent_rectangle);
-            } else {
-                // the child is a branch
-                embedBranch(embedding_stack, 
-                            params.arc, 
-                            params.parent_rectangle, 
-                            params.parent_orientation);
+            arcs.push_back(arc);
+            triangle_offsets.push_back(n_triangles);
+            _point_offsets[node] = n_points;
+
+            // a branch too small to be seen is drawn as a leaf
+            if (_weights && _tree.outDegree(node) > 0 &&
+                    (area < _level_of_detail.min_area ||
+                     arcWeight(*_weights, arc, node) < _level_of_detail.min_weight))
+            {
+                _pruned[node] = true;
+                n_points += 1;
+                n_triangles += 4;
+                continue;
+            }
+
+            n_points += countOwnedPoints(_tree, node);
+            n_triangles += countArcTriangles(_tree, arc);
+
+            // the branch's points are nested in its rectangle, shrunk by
+            // the embedder in proportion to the weight of the arc
+            if (_weights)
+            {
+                double total_volume = _weights->getTotalNodeWeight(node);
+                double arc_volume = _weights->getArcWeight(arc);
+                area *= total_volume / (total_volume + arc_volume + 1);
             }
+
+            visitChildren(stack, node, area);
         }
     }
 
-private:
-    void embedBranch(
-        std::stack<Parameters>& embedding_stack,
-        Arc arc,
-        Rectangle parent_rectangle,
-        bool split_vertically)
+    /// \brief Counts the subtree of each arc from the first index on.
+    /*!
+     *  Every subtree follows its arc, so in reverse order it is complete
+     *  before it is counted. Below a pruned node, nothing is counted.
+     */
+    void countSubtrees(size_t first, size_t last)
     {
-        Node current = _tree.target(arc);
+        for (size_t i=last; i-- > first;)
+        {
+            size_t size = 1;
+            for (ChildIterator<LandscapeTree> it(_tree, _tree.target(_arcs[i]));
+                    !it.done(); ++it)
+            {
+                size += _subtree_sizes[it.arc()];
+            }
+            _subtree_sizes[_arcs[i]] = size;
+            _arc_indices[_arcs[i]] = i;
+        }
+    }
 
-        // determine how much to shrink the rectangle
-        double total_volume = _weights.getTotalNodeWeight(current);
-        double arc_volume   = _weights.getArcWeight(arc);
-        double shrink_ratio = total_volume / (total_volume + arc_volume + 1);
+    void layOut()
+    {
+        _arcs.reserve(_tree.numberOfArcs());
+        _triangle_offsets.reserve(_tree.numberOfArcs());
 
-        Rectangle current_rectangle = parent_rectangle.shrink(shrink_ratio);
+        std::stack<Visit> stack;
+        _n_points = countOwnedPoints(_tree, _tree.getRoot());
+        visitChildren(stack, _tree.getRoot(), 1);
+        visitStack(stack, _arcs, _triangle_offsets, _n_points, _n_triangles);
 
-        // we'll split the rectangle in alternating directions on every
-        // call to this function
-        RectangleSplitter splitter(current_rectangle);
-        if (split_vertically) {
-            splitter.vertically();
-        } else {
-            splitter.horizontally();
+        countSubtrees(0, _arcs.size());
+    }
+
+public:
+    EmbeddingLayout(const LandscapeTree& tree)
+        : _tree(tree), _weights(0), _point_offsets(tree, 0),
+          _subtree_sizes(tree, 0), _arc_indices(tree, 0),
+          _pruned(tree, false), _n_points(0), _n_triangles(0)
+    {
+        layOut();
+    }
+
+    /// \brief Lays out the tree, drawing each subtree whose rectangle is
+    /// smaller than the level of detail as a single leaf.
+    /*!
+     *  The area of each rectangle is found from the weights, as the
+     *  embedder will split it, with the root's rectangle having area one.
+     *  The arc above a pruned subtree is triangulated as a leaf arc, and so
+     *  stands in for the whole subtree.
+     */
+    EmbeddingLayout(
+        const LandscapeTree& tree,
+        const LandscapeWeights<LandscapeTree>& weights,
+        const LevelOfDetail& level_of_detail)
+        : _tree(tree), _weights(&weights), _level_of_detail(level_of_detail),
+          _point_offsets(tree, 0), _subtree_sizes(tree, 0),
+          _arc_indices(tree, 0), _pruned(tree, false), _n_points(0),
+          _n_triangles(0)
+    {
+        layOut();
+    }
+
+    /// \brief Lays out the whole tree again, after it has been rooted
+    /// elsewhere and its weights recomputed.
+    void layOutAgain()
+    {
+        _arcs.clear();
+        _triangle_offsets.clear();
+        _point_offsets.fill(0);
+        _subtree_sizes.fill(0);
+        _arc_indices.fill(0);
+        _pruned.fill(false);
+        _n_triangles = 0;
+
+        layOut();
+    }
+
+    /// \brief Lays out the subtree below the arc again, after it has been
+    /// replaced in the tree and its weights updated.
+    /*!
+     *  The area is that of the rectangle in which the subtree is nested.
+     *  The subtree keeps its place in the visiting order, but may now own
+     *  a different number of points and triangles, so everything after
+     *  it is moved along. Nothing outside of the subtree is laid out again.
+     */
+    void replaceSubtree(Arc arc, double area)
+    {
+        _point_offsets.resize(0);
+        _subtree_sizes.resize(0);
+        _arc_indices.resize(0);
+        _pruned.resize(false);
+
+        Node child = _tree.target(arc);
+
+        // clear whatever the nodes of the subtree held, since they may
+        // have been reused
+        _pruned[child] = false;
+        for (DirectedBFSIterator<LandscapeTree> it(_tree, child);
+                !it.done(); ++it) {
+            _point_offsets[it.child()] = 0;
+            _subtree_sizes[it.arc()] = 0;
+            _pruned[it.child()] = false;
         }
 
-        // now split the current rectangle according to the total volumes of the children
-        for (ChildIterator<LandscapeTree> child_it(_tree, current);
-                !child_it.done(); ++child_it) {
-            double edge_weight = _weights.getArcWeight(child_it.arc()) +
-                                 _weights.getTotalNodeWeight(child_it.child());
+        // an arc below a pruned subtree is not drawn
+        size_t old_size = _subtree_sizes[arc];
+        if (old_size == 0) {
+            return;
+        }
 
-            splitter.addWeight(edge_weight);
+        size_t first = _arc_indices[arc];
+        size_t first_point = _point_offsets[child];
+        size_t first_triangle = _triangle_offsets[first];
+        size_t old_points = getSubtreePointEnd(arc) - first_point;
+        size_t old_triangles = getSubtreeTriangleEnd(arc) - first_triangle;
+
+        std::vector<Arc> arcs;
+        std::vector<size_t> triangle_offsets;
+        size_t n_points = first_point;
+        size_t n_triangles = first_triangle;
+
+        std::stack<Visit> stack;
+        stack.push(Visit(arc, area));
+        visitStack(stack, arcs, triangle_offsets, n_points, n_triangles);
+
+        size_t new_points = n_points - first_point;
+        size_t new_triangles = n_triangles - first_triangle;
+
+        // splice the subtree's arcs in place of the old ones
+        size_t last = first + old_size;
+        size_t new_last = first + arcs.size();
+
+        _arcs.erase(_arcs.begin() + first, _arcs.begin() + last);
+        _arcs.insert(_arcs.begin() + first, arcs.begin(), arcs.end());
+        _triangle_offsets.erase(_triangle_offsets.begin() + first,
+                                _triangle_offsets.begin() + last);
+        _triangle_offsets.insert(_triangle_offsets.begin() + first,
+                                 triangle_offsets.begin(), triangle_offsets.end());
+
+        // move along everything after the subtree
+        for (size_t i=new_last; i<_arcs.size(); ++i)
+        {
+            _triangle_offsets[i] = _triangle_offsets[i] - old_triangles + new_triangles;
+            size_t& offset = _point_offsets[_tree.target(_arcs[i])];
+            offset = offset - old_points + new_points;
+            _arc_indices[_arcs[i]] = i;
         }
 
-        RectangleSplit split = splitter.split();
-        _embedding.insertSplit(split, current);
+        _n_points = _n_points - old_points + new_points;
+        _n_triangles = _n_triangles - old_triangles + new_triangles;
+
+        countSubtrees(first, new_last);
+
+        // the subtrees of the arcs above have grown or shrunk in turn
+        for (Node node = _tree.source(arc); node != _tree.getRoot();)
+        {
+            ParentIterator<LandscapeTree> it(_tree, node);
+            _subtree_sizes[it.arc()] =
+                    _subtree_sizes[it.arc()] - old_size + arcs.size();
+            node = it.parent();
+        }
+    }
+
+    /// \brief Returns true if the node is drawn as a leaf, although it has
+    /// children.
+    bool isPruned(Node node) const {
+        return _pruned[node];
+    }
+
+    /// \brief Returns true if the node is drawn as a single point.
+    bool isDrawnAsLeaf(Node node) const {
+        return _tree.outDegree(node) == 0 || _pruned[node];
+    }
+
+    /// \brief The number of points owned by the node: the root and every
+    /// branch are split, with two points per child and two more, and a leaf
+    /// is a single point.
+    static size_t countOwnedPoints(const LandscapeTree& tree, Node node)
+    {
+        size_t degree = tree.outDegree(node);
+        if (degree == 0 && node != tree.getRoot()) {
+            return 1;
+        }
+        return 2*degree + 2;
+    }
+
+    /// \brief The number of triangles of the arc: a leaf's point is joined
+    /// to its container by four triangles, and a branch's split by eight.
+    static size_t countArcTriangles(const LandscapeTree& tree, Arc arc)
+    {
+        return tree.outDegree(tree.target(arc)) == 0 ? 4 : 8;
+    }
+
+    /// \brief The number of points in the embedding of the tree.
+    static size_t countPoints(const LandscapeTree& tree)
+    {
+        size_t n_points = 0;
+        for (NodeIterator<LandscapeTree> it(tree); !it.done(); ++it) {
+            n_points += countOwnedPoints(tree, it.node());
+        }
+        return n_points;
+    }
+
+    /// \brief The number of triangles in the triangularization of the tree.
+    static size_t countTriangles(const LandscapeTree& tree)
+    {
+        size_t n_triangles = 0;
+        for (ArcIterator<LandscapeTree> it(tree); !it.done(); ++it) {
+            n_triangles += countArcTriangles(tree, it.arc());
+        }
+        return n_triangles;
+    }
+
+    /// \brief The index of the first point owned by the node.
+    size_t getPointOffset(Node node) const {
+        return _point_offsets[node];
+    }
+
+    /// \brief The number of arcs in the subtree, including the arc itself.
+    size_t getSubtreeSize(Arc arc) const {
+        return _subtree_sizes[arc];
+    }
+
+    /// \brief The position of the drawn arc in visiting order.
+    size_t getArcIndex(Arc arc) const {
+        return _arc_indices[arc];
+    }
+
+    /// \brief One past the index of the last point owned by the subtree
+    /// below the drawn arc.
+    size_t getSubtreePointEnd(Arc arc) const
+    {
+        size_t last = _arc_indices[arc] + _subtree_sizes[arc];
+        return last < _arcs.size() ?
+                _point_offsets[_tree.target(_arcs[last])] : _n_points;
+    }
+
+    /// \brief One past the index of the last triangle of the subtree below
+    /// the drawn arc.
+    size_t getSubtreeTriangleEnd(Arc arc) const
+    {
+        size_t last = _arc_indices[arc] + _subtree_sizes[arc];
+        return last < _arcs.size() ? _triangle_offsets[last] : _n_triangles;
+    }
+
+    /// \brief The ith arc in visiting order.
+    Arc getArc(size_t i) const {
+        return _arcs[i];
+    }
+
+    /// \brief The index of the first triangle of the ith arc.
+    size_t getTriangleOffset(size_t i) const {
+        return _triangle_offsets[i];
+    }
+
+    size_t numberOfArcs() const {
+        return _arcs.size();
+    }
+
+    size_t numberOfPoints() const {
+        return _n_points;
+    }
+
+    size_t numberOfTriangles() const {
+        return _n_triangles;
+    }
+};
+
+
+/// \brief The arguments kept in a stack to unroll recursion.
+template <typename LandscapeTree>
+struct denali::rectangular::EmbeddingParameters
+{
+    typedef typename LandscapeTree::Arc Arc;
+    Arc arc;
+    Rectangle parent_rectangle;
+    bool parent_orientation;
+
+    EmbeddingParameters(Arc arc, Rectangle parent_rectangle, bool parent_orientation)
+        : arc(arc), parent_rectangle(parent_rectangle), parent_orientation(parent_orientation)
+    {}
+};
+
+
+template <typename LandscapeTree>
+class denali::rectangular::Embedder
+{
+    const LandscapeTree& _tree;
+    Embedding<LandscapeTree>& _embedding;
+    const LandscapeWeights<LandscapeTree>& _weights;
+    Tiling _tiling;
+
+    // if set, points are placed where the layout puts them
+    const EmbeddingLayout<LandscapeTree>* _layout;
+
+    typedef typename LandscapeTree::Node Node;
+    typedef typename LandscapeTree::Arc Arc;
+    typedef EmbeddingParameters<LandscapeTree> Parameters;
+
+public:
+    Embedder(
+        const LandscapeTree& tree,
+        const LandscapeWeights<LandscapeTree>& weights,
+        Embedding<LandscapeTree>& embedding,
+        Tiling tiling = SLICE_AND_DICE)
+        : _tree(tree), _embedding(embedding), _weights(weights),
+          _tiling(tiling), _layout(0) { }
+
+    void embed()
+    {
+        _embedding.reserve(EmbeddingLayout<LandscapeTree>::countPoints(_tree));
+
+        std::stack<Parameters> embedding_stack;
+        embedRoot(embedding_stack);
+        embedStack(embedding_stack);
+    }
+
+    /// \brief Embeds independent subtrees concurrently.
+    /*!
+     *  The subtrees near the root are split off one by one until each is
+     *  small enough to balance the load, and the rest are then embedded in
+     *  parallel, each by one thread. Every point is placed where the layout
+     *  puts it, so the embedding is the same as that of embed().
+     */
+    void embedInParallel(const EmbeddingLayout<LandscapeTree>& layout)
+    {
+        _layout = &layout;
+        _embedding.resize(layout.numberOfPoints());
+
+        std::stack<Parameters> embedding_stack;
+        embedRoot(embedding_stack);
+
+        size_t grain = layout.numberOfArcs() / (8*parallel::numberOfThreads());
+
+        std::vector<Parameters> subtrees;
+        while (!embedding_stack.empty())
+        {
+            Parameters params = embedding_stack.top();
+            embedding_stack.pop();
+
+            if (layout.getSubtreeSize(params.arc) > grain &&
+                    !layout.isDrawnAsLeaf(_tree.target(params.arc)))
+            {
+                embedBranch(embedding_stack,
+                            params.arc,
+                            params.parent_rectangle,
+                            params.parent_orientation);
+            } else {
+                subtrees.push_back(params);
+            }
+        }
+
+        std::string error;
+
+        #pragma omp parallel for schedule(dynamic)
+        for (long i=0; i<(long) subtrees.size(); ++i)
+        {
+            try {
+                std::stack<Parameters> subtree_stack;
+                subtree_stack.push(subtrees[i]);
+                embedStack(subtree_stack);
+            }
+            catch (std::exception& e) {
+                #pragma omp critical (denali_embedding_error)
+                if (error.empty()) {
+                    error = e.what();
+                }
+            }
+        }
+
+        _layout = 0;
+
+        if (!error.empty()) {
+            throw std::runtime_error(error);
+        }
+
+        _embedding.findExtremePoints();
+    }
+
+    /// \brief Embeds the subtree below the arc into the rectangle in which
+    /// it is nested, placing its points where the layout puts them.
+    /*!
+     *  The rest of the embedding is left as it is, so that a subtree which
+     *  has been replaced may be embedded again on its own. See
+     *  Embedding::replacePoints().
+     */
+    void embedSubtree(
+        const EmbeddingLayout<LandscapeTree>& layout,
+        Arc arc,
+        Rectangle parent_rectangle)
+    {
+        // the root's children are split vertically, and the directions
+        // alternate below them
+        bool split_vertically = true;
+        for (Node node = _tree.source(arc); node != _tree.getRoot();
+                node = ParentIterator<LandscapeTree>(_tree, node).parent()) {
+            split_vertically = !split_vertically;
+        }
+
+        _layout = &layout;
+
+        std::stack<Parameters> embedding_stack;
+        embedding_stack.push(Parameters(arc, parent_rectangle, split_vertically));
+        embedStack(embedding_stack);
+
+        _layout = 0;
+
+        _embedding.findExtremePoints();
+    }
+
+private:
+    void insertSplit(const RectangleSplit& split, Node owner)
+    {
+        if (_layout) {
+            _embedding.placeSplit(split, owner, _layout->getPointOffset(owner));
+        } else {
+            _embedding.insertSplit(split, owner);
+        }
+    }
+
+    void embedStack(std::stack<Parameters>& embedding_stack)
+    {
+        while (!embedding_stack.empty())
+        {
+            Parameters params = embedding_stack.top();
+            embedding_stack.pop();
+
+            Node node = _tree.target(params.arc);
+
+            if (_tree.outDegree(node) == 0 ||
+                    (_layout && _layout->isPruned(node))) {
+                // the child is a leaf, or is drawn as one
+                embedLeaf(node, params.parent_rectangle);
+            } else {
+                // the child is a branch
+                embedBranch(embedding_stack, 
+                            params.arc, 
+                            params.parent_rectangle, 
+                            params.parent_orientation);
+            }
+        }
+    }
+
+    void embedRoot(std::stack<Parameters>& embedding_stack)
+    {
+        // first, we make a rectangle for the root
+        Rectangle root_rectangle(0,0,1,1);
+
+        RectangleSplitter splitter(root_rectangle);
+        if (_tiling == SQUARIFIED) {
+            splitter.squarified();
+        }
+
+        // now split the current rectangle according to the total volumes of the children
+        for (ChildIterator<LandscapeTree> child_it(_tree, _tree.getRoot());
+                !child_it.done(); ++child_it) 
+        {
+            double edge_weight = _weights.getArcWeight(child_it.arc()) +
+                                 _weights.getTotalNodeWeight(child_it.child());
+
+            splitter.addWeight(edge_weight);
+        }
+
+        RectangleSplit split = splitter.split();
+        insertSplit(split, _tree.getRoot());
+
+        // recursively embed the subtree
+        size_t i = 0;;
+        for (ChildIterator<LandscapeTree> it(_tree, _tree.getRoot());
+                !it.done(); ++it)
+        {
+            embedding_stack.push(Parameters(it.arc(), split.getRectangle(i), true));
+            ++i;
+        }
+    }
+
+    void embedBranch(
+        std::stack<Parameters>& embedding_stack,
+        Arc arc,
+        Rectangle parent_rectangle,
+        bool split_vertically)
+    {
+        Node current = _tree.target(arc);
+
+        // determine how much to shrink the rectangle
+        double total_volume = _weights.getTotalNodeWeight(current);
+        double arc_volume   = _weights.getArcWeight(arc);
+        double shrink_ratio = total_volume / (total_volume + arc_volume + 1);
+
+        Rectangle current_rectangle = parent_rectangle.shrink(shrink_ratio);
+
+        // unless it is squarified, we'll split the rectangle in alternating
+        // directions on every call to this function
+        RectangleSplitter splitter(current_rectangle);
+        if (_tiling == SQUARIFIED) {
+            splitter.squarified();
+        } else if (split_vertically) {
+            splitter.vertically();
+        } else {
+            splitter.horizontally();
+        }
+
+        // now split the current rectangle according to the total volumes of the children
+        for (ChildIterator<LandscapeTree> child_it(_tree, current);
+                !child_it.done(); ++child_it) {
+            double edge_weight = _weights.getArcWeight(child_it.arc()) +
+                                 _weights.getTotalNodeWeight(child_it.child());
+
+            splitter.addWeight(edge_weight);
+        }
+
+        RectangleSplit split = splitter.split();
+        insertSplit(split, current);
 
         // recursively embed the subtree
         size_t i = 0;;
@@ -725,7 +1639,12 @@ private:
     void embedLeaf(Node current, Rectangle parent_rectangle)
     {
         Rectangle::Point center = parent_rectangle.center();
-        _embedding.insertPoint(center.x(), center.y(), current);
+        if (_layout) {
+            _embedding.placePoint(_layout->getPointOffset(current),
+                                  center.x(), center.y(), current);
+        } else {
+            _embedding.insertPoint(center.x(), center.y(), current);
+        }
     }
 };
 
@@ -742,26 +1661,26 @@ public:
     class Triangle
     {
         friend class Triangularization;
-        unsigned int _i, _j, _k;
-        unsigned int _id;
+        Identifier _i, _j, _k;
+        Identifier _id;
 
     public:
-        Triangle(unsigned int i, unsigned int j, unsigned int k, size_t id)
+        Triangle(Identifier i, Identifier j, Identifier k, size_t id)
             : _i(i), _j(j), _k(k), _id(id) { }
 
-        unsigned int i() const {
+        Identifier i() const {
             return _i;
         }
 
-        unsigned int j() const {
+        Identifier j() const {
             return _j;
         }
 
-        unsigned int k() const {
+        Identifier k() const {
             return _k;
         }
         
-        unsigned int id() const {
+        Identifier id() const {
             return _id;
         }
     };
@@ -775,12 +1694,73 @@ private:
 
 public:
 
-    void insertTriangle(unsigned int i, unsigned int j, unsigned int k, Arc arc)
+    void insertTriangle(Identifier i, Identifier j, Identifier k, Arc arc)
     {
         _triangles.push_back(Triangle(i,j,k,_triangles.size()));
         _arcs.push_back(arc);
     }
 
+    /// \brief Makes room to insert the triangles without reallocating.
+    void reserve(size_t n_triangles)
+    {
+        _triangles.reserve(n_triangles);
+        _arcs.reserve(n_triangles);
+    }
+
+    /// \brief Makes room for the triangles, which are then placed by index.
+    void resize(size_t n_triangles)
+    {
+        _triangles.assign(n_triangles, Triangle(0,0,0,0));
+        _arcs.assign(n_triangles, Arc());
+    }
+
+    /// \brief Places a triangle at an index of a resized triangularization.
+    /// Different indices may be placed concurrently.
+    void placeTriangle(size_t index, Identifier i, Identifier j, Identifier k, Arc arc)
+    {
+        _triangles[index] = Triangle(i,j,k,index);
+        _arcs[index] = arc;
+    }
+
+    /// \brief Makes room for the triangles of a subtree which is to be
+    /// triangulated again in place of its old triangles, which lie between
+    /// first and last.
+    /*!
+     *  The triangles after the old ones are moved along. The points were
+     *  replaced likewise, so every point from the last point on is moved
+     *  to follow the new last point.
+     */
+    void replaceTriangles(
+        size_t first,
+        size_t last,
+        size_t n_triangles,
+        Identifier last_point,
+        Identifier new_last_point)
+    {
+        size_t new_last = first + n_triangles;
+        if (new_last > last) {
+            _triangles.insert(_triangles.begin() + last, new_last - last,
+                              Triangle(0,0,0,0));
+            _arcs.insert(_arcs.begin() + last, new_last - last, Arc());
+        } else {
+            _triangles.erase(_triangles.begin() + new_last, _triangles.begin() + last);
+            _arcs.erase(_arcs.begin() + new_last, _arcs.begin() + last);
+        }
+
+        for (size_t i=new_last; i<_triangles.size(); ++i)
+        {
+            Triangle& tri = _triangles[i];
+            tri._id = i;
+
+            Identifier* vertices[3] = { &tri._i, &tri._j, &tri._k };
+            for (int j=0; j<3; ++j) {
+                if (*vertices[j] >= last_point) {
+                    *vertices[j] = *vertices[j] - last_point + new_last_point;
+                }
+            }
+        }
+    }
+
     Arc getArc(Triangle tri) const
     {
         return _arcs[tri._id];
@@ -821,6 +1801,8 @@ public:
 
     void triangularize()
     {
+        _triangularization.reserve(
+                EmbeddingLayout<LandscapeTree>::countTriangles(_tree));
 
         // simulate recursion with a stack
         std::stack<Arc> triangularization_stack;
@@ -850,8 +1832,59 @@ public:
         }
     }
 
+    /// \brief Triangulates every arc concurrently, placing the triangles
+    /// where the layout puts them, so that the result is that of
+    /// triangularize().
+    void triangularizeInParallel(const EmbeddingLayout<LandscapeTree>& layout)
+    {
+        _triangularization.resize(layout.numberOfTriangles());
+        triangulateArcs(layout, 0, layout.numberOfArcs());
+    }
+
+    /// \brief Triangulates the subtree below the arc, placing the triangles
+    /// where the layout puts them. See Triangularization::replaceTriangles().
+    void triangularizeSubtree(const EmbeddingLayout<LandscapeTree>& layout, Arc arc)
+    {
+        size_t first = layout.getArcIndex(arc);
+        triangulateArcs(layout, first, first + layout.getSubtreeSize(arc));
+    }
+
 private:
 
+    /// \brief Triangulates the arcs between the indices of the visiting
+    /// order concurrently.
+    void triangulateArcs(
+        const EmbeddingLayout<LandscapeTree>& layout,
+        size_t first,
+        size_t last)
+    {
+        #pragma omp parallel for schedule(static)
+        for (long i=(long) first; i<(long) last; ++i)
+        {
+            Arc arc = layout.getArc(i);
+            size_t index = layout.getTriangleOffset(i);
+
+            if (layout.isDrawnAsLeaf(_tree.target(arc))) {
+                triangulateNestedPoint(arc, &index);
+            } else {
+                triangulateNestedRectangle(arc, &index);
+            }
+        }
+    }
+
+
+    /// \brief Inserts the triangle, or if given an index, places it there
+    /// and advances the index.
+    void addTriangle(Identifier i, Identifier j, Identifier k, Arc arc,
+                     size_t* index)
+    {
+        if (index) {
+            _triangularization.placeTriangle((*index)++, i, j, k, arc);
+        } else {
+            _triangularization.insertTriangle(i, j, k, arc);
+        }
+    }
+
     void triangularizeBranchArc(
             std::stack<Arc>& triangularization_stack, 
             Arc arc)
@@ -870,42 +1903,301 @@ private:
         triangulateNestedPoint(arc);
     }
 
-    void triangulateNestedRectangle(Arc arc)
+    void triangulateNestedRectangle(Arc arc, size_t* index = 0)
     {
         Node inner = _tree.target(arc);
 
         for (int i=0; i<4; ++i) {
-            _triangularization.insertTriangle(
+            addTriangle(
                 _embedding.getContainerPoint(inner, i).id(),
                 _embedding.getContainerPoint(inner, (i+1)%4).id(),
                 _embedding.getCornerPoint(inner, i).id(),
-                arc);
+                arc, index);
         }
 
         for (int i=0; i<4; ++i) {
-            _triangularization.insertTriangle(
+            addTriangle(
                 _embedding.getCornerPoint(inner, i).id(),
                 _embedding.getCornerPoint(inner, (i+1)%4).id(),
                 _embedding.getContainerPoint(inner, (i+1)%4).id(),
-                arc);
+                arc, index);
         }
     }
 
-    void triangulateNestedPoint(Arc arc)
+    void triangulateNestedPoint(Arc arc, size_t* index = 0)
     {
         Node inner = _tree.target(arc);
 
         for (int i=0; i<4; ++i) {
-            _triangularization.insertTriangle(
+            addTriangle(
                 _embedding.getContainerPoint(inner, i).id(),
                 _embedding.getContainerPoint(inner, (i+1)%4).id(),
                 _embedding.getContourPoint(inner, 0).id(),
-                arc);
+                arc, index);
         }
     }
 
 };
 
+////////////////////////////////////////////////////////////////////////////////
+//
+// IndexedMesh
+//
+////////////////////////////////////////////////////////////////////////////////
+
+/// \brief Primitives of one kind, each given by the same number of 32 bit
+/// indices into the points of the landscape, along with the identifier of
+/// the arc that each draws.
+class denali::rectangular::IndexBuffer
+{
+public:
+    typedef boost::uint32_t Index;
+
+private:
+    size_t _primitive_length;
+    std::vector<Index> _indices;
+    std::vector<Index> _arcs;
+
+public:
+    explicit IndexBuffer(size_t primitive_length)
+        : _primitive_length(primitive_length) {}
+
+    /// \brief Makes room for the primitives, which are then placed by index.
+    void resize(size_t n_primitives)
+    {
+        _indices.assign(n_primitives * _primitive_length, 0);
+        _arcs.assign(n_primitives, 0);
+    }
+
+    /// \brief Places a primitive at an index of a resized buffer. Different
+    /// indices may be placed concurrently.
+    void placePrimitive(size_t index, const Index* indices, Index arc)
+    {
+        std::copy(indices, indices + _primitive_length,
+                  _indices.begin() + index * _primitive_length);
+        _arcs[index] = arc;
+    }
+
+    /// \brief Returns the number of indices making up each primitive.
+    size_t getPrimitiveLength() const {
+        return _primitive_length;
+    }
+
+    size_t numberOfPrimitives() const {
+        return _arcs.size();
+    }
+
+    /// \brief Returns the indices of every primitive, one after another.
+    const std::vector<Index>& getIndices() const {
+        return _indices;
+    }
+
+    /// \brief Returns the identifier of the arc drawn by each primitive.
+    const std::vector<Index>& getArcIdentifiers() const {
+        return _arcs;
+    }
+
+    /// \brief Converts a point index or arc identifier, throwing if it
+    /// does not fit in 32 bits.
+    static Index toIndex(size_t value)
+    {
+        if (value > 0xffffffffUL) {
+            throw std::runtime_error(
+                "The landscape is too large to be indexed by 32 bits.");
+        }
+        return (Index) value;
+    }
+};
+
+
+/// \brief A compact copy of the landscape's triangles, to be handed to a
+/// renderer.
+/*!
+ *  The points of the landscape are shared by the primitives, which refer
+ *  to them by 32 bit indices. The mesh holds either the triangles
+ *  themselves, three indices apiece, or a triangle strip around each
+ *  nested rectangle and a triangle fan over each nested point. A strip
+ *  draws the eight triangles of a nested rectangle with ten indices and a
+ *  fan the four triangles of a nested point with six, so that less than
+ *  half as many indices are needed.
+ *
+ *  The strips pass through the container and corner points in turn,
+ *  container 0, corner 0, container 1, ..., corner 3, container 0,
+ *  corner 0, and the fans start at the contour point and then visit the
+ *  containers in reverse, so that every triangle of the strips and fans is
+ *  wound the same way. Either way, the same triangles are drawn as by the
+ *  Triangularization, and the primitives are in the same order of arcs.
+ */
+class denali::rectangular::IndexedMesh
+{
+public:
+    typedef IndexBuffer::Index Index;
+
+    enum Primitives { TRIANGLES, STRIPS_AND_FANS };
+
+private:
+    Primitives _primitives;
+    IndexBuffer _triangles;
+    IndexBuffer _strips;
+    IndexBuffer _fans;
+
+public:
+    IndexedMesh()
+        : _primitives(TRIANGLES), _triangles(3), _strips(10), _fans(6) {}
+
+    /// \brief Empties the mesh, which is then to hold the given primitives.
+    void clear(Primitives primitives)
+    {
+        _primitives = primitives;
+        _triangles.resize(0);
+        _strips.resize(0);
+        _fans.resize(0);
+    }
+
+    /// \brief Returns the kind of primitives held.
+    Primitives getPrimitives() const {
+        return _primitives;
+    }
+
+    IndexBuffer& getTriangles() {
+        return _triangles;
+    }
+
+    const IndexBuffer& getTriangles() const {
+        return _triangles;
+    }
+
+    /// \brief Returns the strips, one around each nested rectangle.
+    IndexBuffer& getStrips() {
+        return _strips;
+    }
+
+    const IndexBuffer& getStrips() const {
+        return _strips;
+    }
+
+    /// \brief Returns the fans, one over each nested point.
+    IndexBuffer& getFans() {
+        return _fans;
+    }
+
+    const IndexBuffer& getFans() const {
+        return _fans;
+    }
+};
+
+
+template <typename LandscapeTree>
+class denali::rectangular::MeshIndexer
+{
+    typedef typename LandscapeTree::Node Node;
+    typedef typename LandscapeTree::Arc Arc;
+    typedef rectangular::Triangularization<LandscapeTree>
+    Triangularization;
+    typedef IndexedMesh::Index Index;
+
+    const LandscapeTree& _tree;
+    const Embedding<LandscapeTree>& _embedding;
+    const Triangularization& _triangularization;
+
+public:
+    MeshIndexer(
+        const LandscapeTree& tree,
+        const Embedding<LandscapeTree>& embedding,
+        const Triangularization& triangularization)
+        : _tree(tree), _embedding(embedding),
+          _triangularization(triangularization) {}
+
+    /// \brief Copies the triangles into the mesh.
+    void indexTriangles(IndexedMesh& mesh)
+    {
+        checkSize();
+
+        mesh.clear(IndexedMesh::TRIANGLES);
+        IndexBuffer& triangles = mesh.getTriangles();
+        triangles.resize(_triangularization.numberOfTriangles());
+
+        #pragma omp parallel for schedule(static)
+        for (long i=0; i<(long) triangles.numberOfPrimitives(); ++i)
+        {
+            typename Triangularization::Triangle tri =
+                    _triangularization.getTriangle(i);
+
+            Index indices[3] = {
+                (Index) tri.i(), (Index) tri.j(), (Index) tri.k()
+            };
+
+            triangles.placePrimitive(i, indices, (Index)
+                    _tree.getArcIdentifier(_triangularization.getArc(tri)));
+        }
+    }
+
+    /// \brief Draws each arc of the layout with a strip or a fan.
+    /*!
+     *  A nested rectangle has eight triangles and a nested point four, so
+     *  the arcs before the i-th, which begin at its triangle offset t,
+     *  have t/4 - i strips between them. Each arc's primitive is thus
+     *  placed directly, and every arc is indexed concurrently.
+     */
+    void indexStripsAndFans(const EmbeddingLayout<LandscapeTree>& layout,
+                            IndexedMesh& mesh)
+    {
+        checkSize();
+
+        size_t n_arcs = layout.numberOfArcs();
+        size_t n_strips = layout.numberOfTriangles() / 4 - n_arcs;
+
+        mesh.clear(IndexedMesh::STRIPS_AND_FANS);
+        IndexBuffer& strips = mesh.getStrips();
+        IndexBuffer& fans = mesh.getFans();
+        strips.resize(n_strips);
+        fans.resize(n_arcs - n_strips);
+
+        #pragma omp parallel for schedule(static)
+        for (long i=0; i<(long) n_arcs; ++i)
+        {
+            Arc arc = layout.getArc(i);
+            Node inner = _tree.target(arc);
+            Index arc_id = (Index) _tree.getArcIdentifier(arc);
+
+            size_t strip = layout.getTriangleOffset(i) / 4 - i;
+
+            if (layout.isDrawnAsLeaf(inner))
+            {
+                Index indices[6];
+                indices[0] = (Index) _embedding.getContourPoint(inner, 0).id();
+                for (int j=0; j<5; ++j) {
+                    indices[j+1] = (Index)
+                        _embedding.getContainerPoint(inner, (4 - j) % 4).id();
+                }
+
+                fans.placePrimitive(i - strip, indices, arc_id);
+            }
+            else
+            {
+                Index indices[10];
+                for (int j=0; j<5; ++j) {
+                    indices[2*j] = (Index)
+                        _embedding.getContainerPoint(inner, j % 4).id();
+                    indices[2*j + 1] = (Index)
+                        _embedding.getCornerPoint(inner, j % 4).id();
+                }
+
+                strips.placePrimitive(strip, indices, arc_id);
+            }
+        }
+    }
+
+private:
+
+    void checkSize() const
+    {
+        IndexBuffer::toIndex(_embedding.numberOfPoints());
+        IndexBuffer::toIndex(_tree.getMaxArcIdentifier());
+    }
+
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 //
 // RectangularLandscape
@@ -927,11 +2219,14 @@ class denali::RectangularLandscape :
 
     typedef denali::LandscapeTree<ContourTree> LandscapeTree;
     typedef denali::LandscapeWeights<LandscapeTree> LandscapeWeights;
+    typedef denali::rectangular::EmbeddingLayout<LandscapeTree> EmbeddingLayout;
     typedef denali::rectangular::Embedding<LandscapeTree> Embedding;
     typedef denali::rectangular::Triangularization<LandscapeTree> Triangularization;
 
+    rectangular::Tiling _tiling;
     LandscapeTree _tree;
     LandscapeWeights _weights;
+    EmbeddingLayout _layout;
     Embedding _embedding;
     Triangularization _triangularization;
 
@@ -939,16 +2234,26 @@ class denali::RectangularLandscape :
     RectangularLandscape(const RectangularLandscape&);
     RectangularLandscape& operator=(const RectangularLandscape&);
 
+    // the landscape tree is never modified after it is built, so it is
+    // placed in an arena of its own
+    static boost::shared_ptr<MonotonicArena> newArena()
+    {
+        return boost::shared_ptr<MonotonicArena>(new MonotonicArena);
+    }
+
+    // the points and triangles are laid out first, so that subtrees can be
+    // embedded and triangulated concurrently
     void buildLandscape()
     {
         // create an embedder
-        rectangular::Embedder<LandscapeTree> embedder(_tree, _weights, _embedding);
-        embedder.embed();
+        rectangular::Embedder<LandscapeTree>
+        embedder(_tree, _weights, _embedding, _tiling);
+        embedder.embedInParallel(_layout);
 
         // create a triangularizer
         rectangular::Triangularizer<LandscapeTree>
         triangularizer(_tree, _embedding, _triangularization);
-        triangularizer.triangularize();
+        triangularizer.triangularizeInParallel(_layout);
     }
 
 public:
@@ -958,22 +2263,136 @@ public:
 
     typedef typename Embedding::Point Point;
     typedef typename Triangularization::Triangle Triangle;
+    typedef rectangular::IndexedMesh IndexedMesh;
+
+    RectangularLandscape(
+        const ContourTree& tree,
+        typename ContourTree::Node root,
+        const rectangular::LevelOfDetail& level_of_detail =
+                rectangular::LevelOfDetail(),
+        rectangular::Tiling tiling = rectangular::SLICE_AND_DICE)
+        : Mixin(_tree), _tiling(tiling), _tree(tree, root, newArena()),
+          _weights(_tree),
+          _layout(_tree, _weights, level_of_detail), _embedding(_tree)
+    {
+        buildLandscape();
+    }
 
     RectangularLandscape(
         const ContourTree& tree,
-        typename ContourTree::Node root)
-        : Mixin(_tree), _tree(tree, root), _weights(_tree), _embedding(_tree)
+        typename ContourTree::Node root,
+        WeightMap* weight_map,
+        const rectangular::LevelOfDetail& level_of_detail =
+                rectangular::LevelOfDetail(),
+        rectangular::Tiling tiling = rectangular::SLICE_AND_DICE)
+        : Mixin(_tree), _tiling(tiling), _tree(tree, root, newArena()),
+          _weights(_tree, weight_map),
+          _layout(_tree, _weights, level_of_detail), _embedding(_tree)
     {
         buildLandscape();
     }
 
+    /// \brief Builds the landscape with the weights kept by the contour tree.
     RectangularLandscape(
         const ContourTree& tree,
         typename ContourTree::Node root,
-        WeightMap* weight_map)
-        : Mixin(_tree), _tree(tree, root), _weights(_tree, weight_map), _embedding(_tree)
+        ContourTreeWeights contour_tree_weights,
+        const rectangular::LevelOfDetail& level_of_detail =
+                rectangular::LevelOfDetail(),
+        rectangular::Tiling tiling = rectangular::SLICE_AND_DICE)
+        : Mixin(_tree), _tiling(tiling), _tree(tree, root, newArena()),
+          _weights(_tree, contour_tree_weights),
+          _layout(_tree, _weights, level_of_detail), _embedding(_tree)
+    {
+        buildLandscape();
+    }
+
+    /// \brief Embeds the subtree below the arc again, after the contour
+    /// tree has been folded or expanded within it.
+    /*!
+     *  The subtree is nested in the same rectangle as before, which its
+     *  weight still fills, and only its points and triangles are replaced;
+     *  those of the rest of the landscape are moved along, but are
+     *  otherwise unchanged. This is much cheaper than building the
+     *  landscape again when the subtree is small, as when it is refined
+     *  with simplifySubtree().
+     *
+     *  Returns false, leaving the landscape unchanged, if the subtree was
+     *  folded away entirely; see LandscapeTree::replaceSubtree(). The
+     *  landscape must then be built again.
+     */
+    bool reembedSubtree(Arc arc)
+    {
+        bool drawn = _layout.getSubtreeSize(arc) > 0;
+
+        size_t first_point = 0, last_point = 0;
+        size_t first_triangle = 0, last_triangle = 0;
+        rectangular::Rectangle container(0,0,1,1);
+
+        if (drawn)
+        {
+            first_point = _layout.getPointOffset(_tree.target(arc));
+            last_point = _layout.getSubtreePointEnd(arc);
+            first_triangle = _layout.getTriangleOffset(_layout.getArcIndex(arc));
+            last_triangle = _layout.getSubtreeTriangleEnd(arc);
+            container = _embedding.getContainer(_tree.target(arc));
+        }
+
+        if (!_tree.replaceSubtree(arc)) {
+            return false;
+        }
+
+        _weights.updateSubtree(arc);
+        _layout.replaceSubtree(arc, container.area());
+
+        if (!drawn) {
+            return true;
+        }
+
+        size_t new_last_point = _layout.getSubtreePointEnd(arc);
+
+        _embedding.replacePoints(_tree.target(arc), first_point, last_point,
+                                 new_last_point - first_point);
+
+        rectangular::Embedder<LandscapeTree>
+        embedder(_tree, _weights, _embedding, _tiling);
+        embedder.embedSubtree(_layout, arc, container);
+
+        _triangularization.replaceTriangles(
+                first_triangle, last_triangle,
+                _layout.getSubtreeTriangleEnd(arc) - first_triangle,
+                last_point, new_last_point);
+
+        rectangular::Triangularizer<LandscapeTree>
+        triangularizer(_tree, _embedding, _triangularization);
+        triangularizer.triangularizeSubtree(_layout, arc);
+
+        return true;
+    }
+
+    /// \brief Roots the landscape at the node of the contour tree.
+    /*!
+     *  The landscape tree is re-oriented in place rather than built again;
+     *  see LandscapeTree::changeRoot(). The weights, layout, points and
+     *  triangles are then found again, as for a new landscape with the
+     *  same level of detail and tiling.
+     *
+     *  Returns false, leaving the landscape unchanged, if the contour tree
+     *  has been folded or expanded since the landscape was built, other
+     *  than within reembedSubtree(). The landscape must then be built
+     *  again.
+     */
+    bool changeRoot(typename ContourTree::Node root)
     {
+        if (!_tree.changeRoot(root)) {
+            return false;
+        }
+
+        _weights.recompute();
+        _layout.layOutAgain();
+        _embedding.clear();
         buildLandscape();
+        return true;
     }
 
     /// \brief Returns the number of points in the embedding.
@@ -1011,11 +2430,39 @@ public:
         return _triangularization.getArc(tri);
     }
 
+    /// \brief Copies the triangles into a compact mesh for rendering, as
+    /// triangles or as strips and fans. See rectangular::IndexedMesh.
+    void getIndexedMesh(
+            IndexedMesh& mesh,
+            IndexedMesh::Primitives primitives = IndexedMesh::TRIANGLES) const
+    {
+        rectangular::MeshIndexer<LandscapeTree>
+        indexer(_tree, _embedding, _triangularization);
+
+        if (primitives == IndexedMesh::TRIANGLES) {
+            indexer.indexTriangles(mesh);
+        } else {
+            indexer.indexStripsAndFans(_layout, mesh);
+        }
+    }
+
     /// \brief Retrieves the arc (component) from the arc's identifier.
-    Arc getComponentFromIdentifier(unsigned int identifier) const {
+    Arc getComponentFromIdentifier(Identifier identifier) const {
         return this->getArcFromIdentifier(identifier);
     }
 
+    /// \brief Returns true if the arc stands in for its whole subtree,
+    /// which was too small to draw at the level of detail.
+    bool isAggregated(Arc arc) const {
+        return _layout.isPruned(_tree.target(arc));
+    }
+
+    /// \brief Returns true if the arc is drawn, either alone or for a
+    /// pruned subtree. Arcs below a pruned subtree are not drawn.
+    bool isDrawn(Arc arc) const {
+        return _layout.getSubtreeSize(arc) > 0;
+    }
+
     /// \brief Returns the weight of the component.
     double getComponentWeight(Arc arc) const {
         return _weights.getArcWeight(arc);
@@ -1066,28 +2513,103 @@ public:
 
     static LandscapeType* build(
             const ContourTree& contour_tree,
-            typename ContourTree::Node root)
+            typename ContourTree::Node root,
+            const rectangular::LevelOfDetail& level_of_detail =
+                    rectangular::LevelOfDetail(),
+            rectangular::Tiling tiling = rectangular::SLICE_AND_DICE)
+    {
+        if (!contour_tree.isNodeValid(root)) {
+            throw std::runtime_error("Invalid root given for landscape generation.");
+        }
+
+        return new LandscapeType(contour_tree, root, level_of_detail, tiling);
+    }
+
+    static LandscapeType* build(
+            const ContourTree& contour_tree,
+            typename ContourTree::Node root,
+            WeightMap* weight_map,
+            const rectangular::LevelOfDetail& level_of_detail =
+                    rectangular::LevelOfDetail(),
+            rectangular::Tiling tiling = rectangular::SLICE_AND_DICE)
     {
         if (!contour_tree.isNodeValid(root)) {
             throw std::runtime_error("Invalid root given for landscape generation.");
         }
 
-        return new LandscapeType(contour_tree, root);
+        return new LandscapeType(contour_tree, root, weight_map, level_of_detail,
+                                 tiling);
     }
 
+    /// \brief Builds a landscape with the weights kept by the contour tree,
+    /// such as a FoldedContourTree, rather than by summing its members.
     static LandscapeType* build(
             const ContourTree& contour_tree,
             typename ContourTree::Node root,
-            WeightMap* weight_map)
+            ContourTreeWeights contour_tree_weights,
+            const rectangular::LevelOfDetail& level_of_detail =
+                    rectangular::LevelOfDetail(),
+            rectangular::Tiling tiling = rectangular::SLICE_AND_DICE)
     {
         if (!contour_tree.isNodeValid(root)) {
             throw std::runtime_error("Invalid root given for landscape generation.");
         }
 
-        return new LandscapeType(contour_tree, root, weight_map);
+        return new LandscapeType(contour_tree, root, contour_tree_weights,
+                                 level_of_detail, tiling);
     }
 
 
 };
 
+
+/// \brief A builder of rectangular landscapes whose rectangles are split as
+/// squarified treemaps.
+/*!
+ *  Slicing gives the rectangles of deep trees extreme aspect ratios, so
+ *  that they become too thin to see long before they become too small.
+ *  The rows of a squarified treemap are nearer to square. The landscapes
+ *  are otherwise those of RectangularLandscapeBuilder.
+ */
+template <typename ContourTree>
+class denali::SquarifiedLandscapeBuilder
+{
+    typedef RectangularLandscapeBuilder<ContourTree> Builder;
+
+public:
+    typedef RectangularLandscape<ContourTree> LandscapeType;
+
+    static LandscapeType* build(
+            const ContourTree& contour_tree,
+            typename ContourTree::Node root,
+            const rectangular::LevelOfDetail& level_of_detail =
+                    rectangular::LevelOfDetail())
+    {
+        return Builder::build(contour_tree, root, level_of_detail,
+                              rectangular::SQUARIFIED);
+    }
+
+    static LandscapeType* build(
+            const ContourTree& contour_tree,
+            typename ContourTree::Node root,
+            WeightMap* weight_map,
+            const rectangular::LevelOfDetail& level_of_detail =
+                    rectangular::LevelOfDetail())
+    {
+        return Builder::build(contour_tree, root, weight_map, level_of_detail,
+                              rectangular::SQUARIFIED);
+    }
+
+    static LandscapeType* build(
+            const ContourTree& contour_tree,
+            typename ContourTree::Node root,
+            ContourTreeWeights contour_tree_weights,
+            const rectangular::LevelOfDetail& level_of_detail =
+                    rectangular::LevelOfDetail())
+    {
+        return Builder::build(contour_tree, root, contour_tree_weights,
+                              level_of_detail, rectangular::SQUARIFIED);
+    }
+};
+
 #endif
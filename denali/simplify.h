@@ -25,13 +25,18 @@
 #ifndef DENALI_SIMPLIFY_H
 #define DENALI_SIMPLIFY_H
 
+#include <denali/contour_tree.h>
 #include <denali/graph_mixins.h>
 #include <denali/graph_iterators.h>
 #include <denali/folded.h>
+#include <denali/indexed_heap.h>
 
+#include <algorithm>
 #include <cmath>
 #include <boost/shared_ptr.hpp>
-#include <queue>
+#include <limits>
+#include <string>
+#include <utility>
 #include <stdexcept>
 #include <vector>
 
@@ -39,25 +44,235 @@ namespace denali {
 
 ////////////////////////////////////////////////////////////////////////////////
 //
-// Priority
+// Simplification Measures
 //
 ////////////////////////////////////////////////////////////////////////////////
 
-class Priority
+/*!
+ *  A simplification measure assigns a value to the branch which would be
+ *  removed by collapsing a leaf edge; leaves are collapsed in order of this
+ *  value until it exceeds the threshold. A measure provides:
+ *
+ *      void initialize(const Context&);
+ *      double operator()(const Context&, Edge leaf_edge);
+ *      void collapsing(const Context&, Edge);
+ *      void reducing(const Context&, Node);
+ *      void reduced(const Context&, Edge);
+ *
+ *  The simplifier calls initialize() before it begins, and the remaining
+ *  hooks around every fold it makes, so that a measure can keep aggregates
+ *  up to date as the tree is folded rather than recomputing them.
+ */
+
+/// \brief Measures a branch by the difference in value across its edge.
+/// \ingroup simplified_contour_tree
+struct PersistenceMeasure
 {
-    double _priority;
+    template <typename Context>
+    void initialize(const Context&) {}
+
+    template <typename Context>
+    double operator()(const Context& context, typename Context::Edge edge) const
+    {
+        return std::abs(context.getValue(context.u(edge)) - 
+                        context.getValue(context.v(edge)));
+    }
+
+    template <typename Context>
+    void collapsing(const Context&, typename Context::Edge) {}
+
+    template <typename Context>
+    void reducing(const Context&, typename Context::Node) {}
+
+    template <typename Context>
+    void reduced(const Context&, typename Context::Edge) {}
+};
+
+
+/// \brief Maintains the total weight and weighted value of the members of
+/// every visible node and edge.
+/// \ingroup simplified_contour_tree
+/*!
+ *  The sums are computed once by initialize(), and then updated by each
+ *  fold in constant time: a collapse adds the leaf and its edge to the
+ *  base, and a reduction gives the new edge the sums of the node and the
+ *  two edges it replaces. Without a weight map, every member has weight
+ *  one; otherwise members missing from the map have weight one, as in
+ *  LandscapeWeights.
+ *
+ *  The context must provide getNodeMembers and getEdgeMembers, as
+ *  FoldedContourTree does.
+ */
+class MemberSums
+{
+public:
+    struct Sums
+    {
+        double weight;
+        double weighted_value;
+
+        Sums() : weight(0), weighted_value(0) {}
+
+        Sums& operator+=(const Sums& rhs)
+        {
+            weight += rhs.weight;
+            weighted_value += rhs.weighted_value;
+            return *this;
+        }
+    };
+
+private:
+    const WeightMap* _weight_map;
+    std::vector<Sums> _node_sums;
+    std::vector<Sums> _edge_sums;
+    Sums _reduced_sums;
+
+    double lookupWeight(Identifier id) const
+    {
+        if (!_weight_map) return 1;
+
+        WeightMap::const_iterator it = _weight_map->find(id);
+        return it == _weight_map->end() ? 1 : it->second;
+    }
+
+    template <typename Members>
+    Sums sumMembers(const Members& members) const
+    {
+        Sums sums;
+        for (typename Members::const_iterator it = members.begin();
+                it != members.end(); ++it)
+        {
+            double weight = lookupWeight((*it).getID());
+            sums.weight += weight;
+            sums.weighted_value += weight * (*it).getValue();
+        }
+        return sums;
+    }
+
+    template <typename Context>
+    Sums& edgeSums(const Context& context, typename Context::Edge edge)
+    {
+        // edges made by reductions may be beyond the initial size
+        size_t i = context.getEdgeIdentifier(edge);
+        if (i >= _edge_sums.size()) {
+            _edge_sums.resize(context.getMaxEdgeIdentifier());
+        }
+        return _edge_sums[i];
+    }
 
 public:
-    Priority(double priority) : _priority(priority) {}
+    MemberSums(const WeightMap* weight_map = 0) : _weight_map(weight_map) {}
+
+    /// \brief The sums of the members of a visible node.
+    template <typename Context>
+    const Sums& getNodeSums(const Context& context,
+                            typename Context::Node node) const
+    {
+        return _node_sums[context.getNodeIdentifier(node)];
+    }
+
+    /// \brief The sums of the members of a leaf and its edge.
+    template <typename Context>
+    Sums getBranchSums(const Context& context, typename Context::Edge edge)
+    {
+        typename Context::Node u = context.u(edge);
+        typename Context::Node leaf = context.degree(u) == 1 ? u : context.v(edge);
+
+        Sums sums = getNodeSums(context, leaf);
+        sums += edgeSums(context, edge);
+        return sums;
+    }
+
+    template <typename Context>
+    void initialize(const Context& context)
+    {
+        _node_sums.assign(context.getMaxNodeIdentifier(), Sums());
+        _edge_sums.assign(context.getMaxEdgeIdentifier(), Sums());
 
-    double priority() const {
-        return _priority;
+        for (NodeIterator<Context> it(context); !it.done(); ++it) {
+            _node_sums[context.getNodeIdentifier(it.node())] =
+                    sumMembers(context.getNodeMembers(it.node()));
+        }
+
+        for (EdgeIterator<Context> it(context); !it.done(); ++it) {
+            _edge_sums[context.getEdgeIdentifier(it.edge())] =
+                    sumMembers(context.getEdgeMembers(it.edge()));
+        }
+    }
+
+    template <typename Context>
+    void collapsing(const Context& context, typename Context::Edge edge)
+    {
+        typename Context::Node u = context.u(edge);
+        typename Context::Node v = context.v(edge);
+        typename Context::Node base = context.degree(u) == 1 ? v : u;
+
+        _node_sums[context.getNodeIdentifier(base)] += 
+                getBranchSums(context, edge);
+    }
+
+    template <typename Context>
+    void reducing(const Context& context, typename Context::Node node)
+    {
+        _reduced_sums = getNodeSums(context, node);
+        for (UndirectedNeighborIterator<Context> it(context, node);
+                !it.done(); ++it)
+        {
+            _reduced_sums += edgeSums(context, it.edge());
+        }
+    }
+
+    template <typename Context>
+    void reduced(const Context& context, typename Context::Edge edge) {
+        edgeSums(context, edge) = _reduced_sums;
+    }
+};
+
+
+/// \brief Measures a branch by the total weight of its members.
+/// \ingroup simplified_contour_tree
+/*!
+ *  Without a weight map, this is the number of members in the branch.
+ */
+class VolumeMeasure : public MemberSums
+{
+public:
+    VolumeMeasure(const WeightMap* weight_map = 0) : MemberSums(weight_map) {}
+
+    template <typename Context>
+    double operator()(const Context& context, typename Context::Edge edge) {
+        return getBranchSums(context, edge).weight;
+    }
+};
+
+
+/// \brief Measures a branch by the weighted sum of the heights of its
+/// members above (or depths below) the node it hangs from.
+/// \ingroup simplified_contour_tree
+/*!
+ *  This is the integral of the distance to the parent's value over the
+ *  branch, and is computed from the maintained sums as 
+ *  |sum(w * value) - parent value * sum(w)|.
+ */
+class HypervolumeMeasure : public MemberSums
+{
+public:
+    HypervolumeMeasure(const WeightMap* weight_map = 0)
+        : MemberSums(weight_map) {}
+
+    template <typename Context>
+    double operator()(const Context& context, typename Context::Edge edge)
+    {
+        typename Context::Node u = context.u(edge);
+        typename Context::Node v = context.v(edge);
+        typename Context::Node parent = context.degree(u) == 1 ? v : u;
+
+        Sums sums = getBranchSums(context, edge);
+        return std::abs(sums.weighted_value - 
+                        context.getValue(parent) * sums.weight);
     }
 };
 
-inline bool operator<(const Priority& lhs, const Priority& rhs) {
-    return lhs.priority() < rhs.priority();
-}
 
 ////////////////////////////////////////////////////////////////////////////////
 //
@@ -72,42 +287,145 @@ struct NullProtector
 };
 
 
+template <typename Context>
+struct NullRecorder
+{
+    void collapsing(const Context&, typename Context::Edge, double) {}
+    void reducing(const Context&, typename Context::Node) {}
+    void reduced(const Context&, typename Context::Edge) {}
+};
+
+
+/// \brief Counts of the work done by a simplification.
+/// \ingroup simplified_contour_tree
+struct SimplificationStatistics
+{
+    /// \brief The number of leaves inserted into the queue.
+    size_t pushes;
+
+    /// \brief The number of times a queued leaf's value changed.
+    size_t updates;
+
+    /// \brief The number of leaves removed from the queue.
+    size_t pops;
+
+    size_t collapses;
+    size_t reductions;
+
+    /// \brief The largest number of leaves queued at once.
+    size_t max_queue_size;
+
+    SimplificationStatistics()
+        : pushes(0), updates(0), pops(0), collapses(0), reductions(0),
+          max_queue_size(0) {}
+};
+
+
 class PersistenceSimplifier
 {
     double _threshold;
+    SimplificationStatistics _statistics;
 
     template <typename Node>
-    class PersistencePriority : public Priority
+    struct LeafPriority
+    {
+        double value;
+        Identifier id;
+        Node leaf;
+
+        LeafPriority(double value, Identifier id, Node leaf)
+            : value(value), id(id), leaf(leaf) {}
+    };
+
+    // ties are broken by the ID of the leaf rather than by its position in
+    // the graph, so that the order depends only on the tree
+    struct PriorityLess
+    {
+        template <typename Priority>
+        bool operator()(const Priority& lhs, const Priority& rhs) const
+        {
+            if (lhs.value != rhs.value) {
+                return lhs.value < rhs.value;
+            }
+            return lhs.id < rhs.id;
+        }
+    };
+
+    /// \brief Records the folds of a simplification by node ID: true and the
+    /// leaf for a collapse, false and the node for a reduction.
+    class IdentifierRecorder
     {
-        double _persistence;
-        Node _leaf;
+        std::vector<std::pair<bool, Identifier> >& _folds;
 
     public:
-        PersistencePriority(Node leaf, double persistence)
-            : Priority(1/(persistence+1)), _persistence(persistence),
-              _leaf(leaf) {}
+        IdentifierRecorder(std::vector<std::pair<bool, Identifier> >& folds)
+            : _folds(folds) {}
 
-        double persistence() const {
-            return _persistence;
+        template <typename Context>
+        void collapsing(const Context& context,
+                        typename Context::Edge edge, double)
+        {
+            typename Context::Node leaf = getLeaf(context, edge);
+            _folds.push_back(std::make_pair(true, context.getID(leaf)));
         }
 
-        Node leaf() const {
-            return _leaf;
+        template <typename Context>
+        void reducing(const Context& context, typename Context::Node node) {
+            _folds.push_back(std::make_pair(false, context.getID(node)));
         }
+
+        template <typename Context>
+        void reduced(const Context&, typename Context::Edge) {}
     };
 
+    /// \brief Returns true if node u is below node v, breaking ties by ID.
+    static bool valueLess(const std::vector<double>& values,
+                          const std::vector<Identifier>& ids,
+                          size_t u, size_t v)
+    {
+        if (values[u] != values[v]) {
+            return values[u] < values[v];
+        }
+        return ids[u] < ids[v];
+    }
+
+    /// \brief Queues the leaf, or updates its value if it is queued.
+    template <typename Context, typename Queue>
+    void enqueue(const Context& context, Queue& queue,
+                 typename Context::Node leaf, double value)
+    {
+        typedef LeafPriority<typename Context::Node> Priority;
+
+        if (queue.push(context.getNodeIdentifier(leaf),
+                       Priority(value, context.getID(leaf), leaf)))
+        {
+            _statistics.pushes++;
+            _statistics.max_queue_size =
+                    std::max(_statistics.max_queue_size, queue.size());
+        }
+        else
+        {
+            _statistics.updates++;
+        }
+    }
+
     template <typename Tree>
     static typename Tree::Node getLeaf(const Tree& tree, typename Tree::Edge edge) {
         return tree.degree(tree.u(edge)) == 1 ? tree.u(edge) : tree.v(edge);
     }
 
     /// \brief Simplifies the contour tree in the context.
-    template <typename Context, typename ProtectedNodes>
-    void simplifyCore(Context& context, const ProtectedNodes& protected_nodes)
+    template <typename Context, typename ProtectedNodes, typename Measure,
+              typename Recorder>
+    void simplifyCore(Context& context, const ProtectedNodes& protected_nodes,
+                      Measure& measure, Recorder& recorder)
     {
-        typedef PersistencePriority<typename Context::Node> Priority;
         typedef typename Context::Node Node;
         typedef typename Context::Edge Edge;
+        typedef IndexedDaryHeap<LeafPriority<Node>, PriorityLess> Queue;
+
+        _statistics = SimplificationStatistics();
+        measure.initialize(context);
 
         // first, we reduce all degree-2 nodes
         std::vector<Node> reduce_vector;
@@ -122,11 +440,17 @@ class PersistenceSimplifier
         for (typename std::vector<Node>::iterator it = reduce_vector.begin(); 
                 it != reduce_vector.end(); ++it)
         {
-            context.reduce(*it);
+            measure.reducing(context, *it);
+            recorder.reducing(context, *it);
+            Edge edge = context.reduce(*it);
+            measure.reduced(context, edge);
+            recorder.reduced(context, edge);
+            _statistics.reductions++;
         }
 
-        // make a priority queue of PersistencePriorities
-        std::priority_queue<Priority> simplify_queue;
+        // queue each leaf by the measure of its branch. a leaf has at most
+        // one entry, which is updated whenever its edge changes
+        Queue simplify_queue(context.getMaxNodeIdentifier());
 
         // add every leaf edge to the queue
         for (EdgeIterator<Context> it(context); !it.done(); ++it)
@@ -141,25 +465,22 @@ class PersistenceSimplifier
                 // determine which is the leaf
                 Node leaf = getLeaf(context, it.edge());
 
-                // compute the persistence
-                double persistence = computePersistence(context, it.edge());
+                // measure the leaf's branch
+                double value = measure(context, it.edge());
 
                 // enqueue
-                simplify_queue.push(Priority(leaf, persistence));
+                enqueue(context, simplify_queue, leaf, value);
             }
         }
 
-        while (simplify_queue.size() > 0)
+        while (!simplify_queue.empty())
         {
-            // get the leaf off of the queue
-            Node leaf           = simplify_queue.top().leaf();
-            double persistence  = simplify_queue.top().persistence();
+            // get the leaf off of the queue. leaves are only removed from
+            // the tree when they are popped, so the leaf is still valid
+            Node leaf           = simplify_queue.topPriority().leaf;
+            double value  = simplify_queue.topPriority().value;
             simplify_queue.pop();
-
-            // make sure the leaf is valid
-            if (!context.isNodeValid(leaf)) {
-                continue;
-            }
+            _statistics.pops++;
 
             // get the leaf edge and the parent
             UndirectedNeighborIterator<Context> neighbor_it(context, leaf);
@@ -174,17 +495,25 @@ class PersistenceSimplifier
                 continue;
             }
 
-            if (persistence > _threshold) {
+            if (value > _threshold) {
                 break;
             }
 
             // collapse the edge
+            measure.collapsing(context, edge);
+            recorder.collapsing(context, edge, value);
             context.collapse(edge);
+            _statistics.collapses++;
 
             // if the parent is reducible, reduce it now
             if (isRegular(context, parent)) 
             {
+                measure.reducing(context, parent);
+                recorder.reducing(context, parent);
                 Edge edge = context.reduce(parent);
+                measure.reduced(context, edge);
+                recorder.reduced(context, edge);
+                _statistics.reductions++;
 
                 // add the leaf nodes of the parent to the queue, as they
                 // may no longer need to be preserved
@@ -192,8 +521,8 @@ class PersistenceSimplifier
                 Node v = context.v(edge);
 
                 if (context.degree(u) == 1) {
-                    double persistence = computePersistence(context, edge);
-                    simplify_queue.push(Priority(u, persistence));
+                    double value = measure(context, edge);
+                    enqueue(context, simplify_queue, u, value);
                 } else {
                     // add u's leaf neighbors
                     for (UndirectedNeighborIterator<Context> neighbor_it(context, u);
@@ -201,15 +530,15 @@ class PersistenceSimplifier
                     {
                         if (context.degree(neighbor_it.neighbor()) == 1)
                         {
-                            double persistence = computePersistence(context, neighbor_it.edge());
-                            simplify_queue.push(Priority(neighbor_it.neighbor(), persistence));
+                            double value = measure(context, neighbor_it.edge());
+                            enqueue(context, simplify_queue, neighbor_it.neighbor(), value);
                         }
                     }
                 }
 
                 if (context.degree(v) == 1) {
-                    double persistence = computePersistence(context, edge);
-                    simplify_queue.push(Priority(v, persistence));
+                    double value = measure(context, edge);
+                    enqueue(context, simplify_queue, v, value);
                 } else {
                     // add v's leaf neighbors
                     for (UndirectedNeighborIterator<Context> neighbor_it(context, v);
@@ -217,8 +546,8 @@ class PersistenceSimplifier
                     {
                         if (context.degree(neighbor_it.neighbor()) == 1)
                         {
-                            double persistence = computePersistence(context, neighbor_it.edge());
-                            simplify_queue.push(Priority(neighbor_it.neighbor(), persistence));
+                            double value = measure(context, neighbor_it.edge());
+                            enqueue(context, simplify_queue, neighbor_it.neighbor(), value);
                         }
                     }
                 }
@@ -228,11 +557,11 @@ class PersistenceSimplifier
                 // get the neighbor of the parent
                 UndirectedNeighborIterator<Context> neighbor_it(context, parent);
 
-                // compute the persistence
-                double persistence = computePersistence(context, neighbor_it.edge());
+                // measure the leaf's branch
+                double value = measure(context, neighbor_it.edge());
 
                 // add to the queue
-                simplify_queue.push(Priority(parent, persistence));
+                enqueue(context, simplify_queue, parent, value);
             }
 
         }
@@ -248,6 +577,11 @@ public:
         return _threshold;
     }
 
+    /// \brief Counts of the work done by the last simplification.
+    const SimplificationStatistics& getStatistics() const {
+        return _statistics;
+    }
+
     void setThreshold(double threshold) {
         if (threshold < 0) {
             throw std::runtime_error("Threshold must be nonnegative.");
@@ -317,6 +651,22 @@ public:
         return n;
     }
 
+    /// \brief Reads the up-degree maintained by the folded tree.
+    template <typename ContourTree>
+    static unsigned int upDegree(const FoldedContourTree<ContourTree>& tree,
+                                 FoldTree::Node node)
+    {
+        return tree.upDegree(node);
+    }
+
+    /// \brief Reads the down-degree maintained by the folded tree.
+    template <typename ContourTree>
+    static unsigned int downDegree(const FoldedContourTree<ContourTree>& tree,
+                                   FoldTree::Node node)
+    {
+        return tree.downDegree(node);
+    }
+
     template <typename Tree>
     static bool preserveForReduction(
             const Tree& tree, 
@@ -350,7 +700,260 @@ public:
     {
         // no nodes are going to be protected
         NullProtector<Context> null_protected;
-        simplifyCore(context, null_protected);
+        NullRecorder<Context> null_recorder;
+        PersistenceMeasure measure;
+        simplifyCore(context, null_protected, measure, null_recorder);
+    }
+
+    /// \brief Simplifies the tree, reporting each fold to the recorder.
+    /*!
+     *  Before an edge is collapsed, `recorder.collapsing(context, edge,
+     *  value)` is called with the measure the edge was queued with. Before
+     *  a node is reduced, `recorder.reducing(context, node)` is called, and
+     *  after, `recorder.reduced(context, edge)` is called with the edge
+     *  which replaced it.
+     */
+    template <typename Context, typename Recorder>
+    void simplify(Context& context, Recorder& recorder)
+    {
+        NullProtector<Context> null_protected;
+        PersistenceMeasure measure;
+        simplifyCore(context, null_protected, measure, recorder);
+    }
+
+    /// \brief Simplifies the tree, collapsing branches in order of the
+    /// measure until it exceeds the threshold.
+    /*!
+     *  See PersistenceMeasure, VolumeMeasure and HypervolumeMeasure.
+     */
+    template <typename Context, typename Measure>
+    void simplifyByMeasure(Context& context, Measure& measure)
+    {
+        NullProtector<Context> null_protected;
+        NullRecorder<Context> null_recorder;
+        simplifyCore(context, null_protected, measure, null_recorder);
+    }
+
+    /// \brief Simplifies the tree by the measure, reporting each fold to the
+    /// recorder.
+    template <typename Context, typename Measure, typename Recorder>
+    void simplifyByMeasure(Context& context, Measure& measure,
+                           Recorder& recorder)
+    {
+        NullProtector<Context> null_protected;
+        simplifyCore(context, null_protected, measure, recorder);
+    }
+
+    /// \brief Simplifies independent parts of the tree on separate threads.
+    /*!
+     *  Produces the same tree as simplify(). An edge whose persistence
+     *  exceeds the threshold is never collapsed, since reducing a node only
+     *  lengthens its edges. If each end of such an edge also has two such
+     *  edges leading up, or two leading down, neither end can ever become
+     *  regular, so the folds on one side of the edge never affect the other.
+     *
+     *  The tree is cut at these edges. Each part is copied along with the
+     *  far ends of its cut edges, which stand in as leaves, and the copies
+     *  are simplified in parallel. The folds made in each copy are then
+     *  replayed on the context, one part after another.
+     *
+     *  In addition to what simplify() requires, the context must provide
+     *  getNode(Identifier).
+     */
+    template <typename Context>
+    void simplifyInParallel(Context& context)
+    {
+        typedef typename Context::Node Node;
+        typedef std::vector<std::pair<bool, Identifier> > Folds;
+        typedef FoldedContourTree<ContourTree> PartTree;
+
+        // copy the tree into flat arrays
+        std::vector<Index> local(context.getMaxNodeIdentifier(), -1);
+        std::vector<Identifier> ids;
+        std::vector<double> values;
+        for (NodeIterator<Context> it(context); !it.done(); ++it)
+        {
+            local[context.getNodeIdentifier(it.node())] = ids.size();
+            ids.push_back(context.getID(it.node()));
+            values.push_back(context.getValue(it.node()));
+        }
+
+        std::vector<std::pair<size_t, size_t> > edges;
+        for (EdgeIterator<Context> it(context); !it.done(); ++it)
+        {
+            edges.push_back(std::make_pair(
+                    local[context.getNodeIdentifier(context.u(it.edge()))],
+                    local[context.getNodeIdentifier(context.v(it.edge()))]));
+        }
+
+        // count the edges which can never be collapsed
+        std::vector<unsigned int> heavy_up(ids.size(), 0);
+        std::vector<unsigned int> heavy_down(ids.size(), 0);
+        std::vector<bool> heavy(edges.size(), false);
+        for (size_t e=0; e<edges.size(); ++e)
+        {
+            size_t u = edges[e].first, v = edges[e].second;
+            if (std::abs(values[u] - values[v]) <= _threshold) continue;
+
+            heavy[e] = true;
+            size_t lower = valueLess(values, ids, u, v) ? u : v;
+            size_t upper = lower == u ? v : u;
+            heavy_up[lower]++;
+            heavy_down[upper]++;
+        }
+
+        // label the parts left when the cut edges are removed
+        std::vector<std::vector<size_t> > neighbors(ids.size());
+        std::vector<size_t> cut_edges;
+        for (size_t e=0; e<edges.size(); ++e)
+        {
+            size_t u = edges[e].first, v = edges[e].second;
+            bool u_fixed = heavy_up[u] >= 2 || heavy_down[u] >= 2;
+            bool v_fixed = heavy_up[v] >= 2 || heavy_down[v] >= 2;
+
+            if (heavy[e] && u_fixed && v_fixed) {
+                cut_edges.push_back(e);
+            } else {
+                neighbors[u].push_back(v);
+                neighbors[v].push_back(u);
+            }
+        }
+
+        if (cut_edges.empty())
+        {
+            simplify(context);
+            return;
+        }
+
+        std::vector<Index> part_of(ids.size(), -1);
+        std::vector<std::vector<size_t> > parts;
+        for (size_t i=0; i<ids.size(); ++i)
+        {
+            if (part_of[i] != -1) continue;
+
+            parts.push_back(std::vector<size_t>());
+            std::vector<size_t>& part = parts.back();
+            part_of[i] = parts.size() - 1;
+            part.push_back(i);
+
+            for (size_t k=0; k<part.size(); ++k)
+            {
+                for (size_t j=0; j<neighbors[part[k]].size(); ++j)
+                {
+                    size_t neighbor = neighbors[part[k]][j];
+                    if (part_of[neighbor] == -1) {
+                        part_of[neighbor] = part_of[i];
+                        part.push_back(neighbor);
+                    }
+                }
+            }
+
+            std::sort(part.begin(), part.end());
+        }
+
+        std::vector<std::vector<size_t> > part_cut_edges(parts.size());
+        for (size_t k=0; k<cut_edges.size(); ++k)
+        {
+            const std::pair<size_t, size_t>& edge = edges[cut_edges[k]];
+            part_cut_edges[part_of[edge.first]].push_back(cut_edges[k]);
+            part_cut_edges[part_of[edge.second]].push_back(cut_edges[k]);
+        }
+
+        // simplify a copy of each part
+        std::vector<Folds> folds(parts.size());
+        std::vector<SimplificationStatistics> statistics(parts.size());
+        std::string error;
+
+        #pragma omp parallel for schedule(dynamic)
+        for (long p=0; p<(long) parts.size(); ++p)
+        {
+            const std::vector<size_t>& part = parts[p];
+
+            // a part of one node has only cut edges, so nothing can be folded
+            if (part.size() == 1) continue;
+
+            try {
+                boost::shared_ptr<UndirectedScalarMemberIDGraph> graph(
+                        new UndirectedScalarMemberIDGraph);
+
+                std::vector<UndirectedScalarMemberIDGraph::Node> copies;
+                for (size_t k=0; k<part.size(); ++k) {
+                    copies.push_back(graph->addNode(ids[part[k]], values[part[k]]));
+                }
+
+                for (size_t k=0; k<part.size(); ++k)
+                {
+                    for (size_t j=0; j<neighbors[part[k]].size(); ++j)
+                    {
+                        size_t neighbor = neighbors[part[k]][j];
+                        if (part[k] < neighbor) {
+                            size_t n = std::lower_bound(part.begin(), part.end(),
+                                                        neighbor) - part.begin();
+                            graph->addEdge(copies[k], copies[n]);
+                        }
+                    }
+                }
+
+                for (size_t k=0; k<part_cut_edges[p].size(); ++k)
+                {
+                    const std::pair<size_t, size_t>& edge = 
+                            edges[part_cut_edges[p][k]];
+                    size_t inside = part_of[edge.first] == p ? edge.first : edge.second;
+                    size_t outside = edge.first == inside ? edge.second : edge.first;
+
+                    size_t n = std::lower_bound(part.begin(), part.end(),
+                                                inside) - part.begin();
+                    graph->addEdge(copies[n],
+                            graph->addNode(ids[outside], values[outside]));
+                }
+
+                ContourTree part_tree = ContourTree::fromPrecomputed(graph);
+                PartTree folded_part(part_tree);
+
+                PersistenceSimplifier simplifier(_threshold);
+                NullProtector<PartTree> null_protected;
+                PersistenceMeasure measure;
+                IdentifierRecorder recorder(folds[p]);
+                simplifier.simplifyCore(folded_part, null_protected, measure,
+                                        recorder);
+                statistics[p] = simplifier.getStatistics();
+            }
+            catch (std::exception& e) {
+                #pragma omp critical (denali_simplify_error)
+                if (error.empty()) {
+                    error = e.what();
+                }
+            }
+        }
+
+        if (!error.empty()) {
+            throw std::runtime_error(error);
+        }
+
+        // replay the folds on the context
+        _statistics = SimplificationStatistics();
+        for (size_t p=0; p<parts.size(); ++p)
+        {
+            for (size_t k=0; k<folds[p].size(); ++k)
+            {
+                Node node = context.getNode(folds[p][k].second);
+
+                if (folds[p][k].first) {
+                    UndirectedNeighborIterator<Context> it(context, node);
+                    context.collapse(it.edge());
+                } else {
+                    context.reduce(node);
+                }
+            }
+
+            _statistics.pushes += statistics[p].pushes;
+            _statistics.updates += statistics[p].updates;
+            _statistics.pops += statistics[p].pops;
+            _statistics.collapses += statistics[p].collapses;
+            _statistics.reductions += statistics[p].reductions;
+            _statistics.max_queue_size = std::max(
+                    _statistics.max_queue_size, statistics[p].max_queue_size);
+        }
     }
 
     /// \brief Simplifies a subtree.
@@ -364,18 +967,38 @@ public:
                          typename Context::Node parent,
                          typename Context::Node pivot)
     {
-        // we create a new node map that defaults to false
-        StaticNodeMap<Context, bool> protected_nodes(context);
+        PersistenceMeasure measure;
+        simplifySubtree(context, parent, pivot, measure);
+    }
 
-        // we set each node to protected
-        for (NodeIterator<Context> it(context); !it.done(); ++it) {
-            protected_nodes[it.node()] = true;
-        }
+    /// \brief Simplifies a subtree by the measure.
+    template <typename Context, typename Measure>
+    void simplifySubtree(Context& context, 
+                         typename Context::Node parent,
+                         typename Context::Node pivot,
+                         Measure& measure)
+    {
+        NullRecorder<Context> null_recorder;
+        simplifySubtree(context, parent, pivot, measure, null_recorder);
+    }
+
+    /// \brief Simplifies a subtree by the measure, reporting each fold to
+    /// the recorder.
+    template <typename Context, typename Measure, typename Recorder>
+    void simplifySubtree(Context& context, 
+                         typename Context::Node parent,
+                         typename Context::Node pivot,
+                         Measure& measure,
+                         Recorder& recorder)
+    {
+        // every node is protected unless it is in the subtree. only the
+        // subtree's nodes are stored, so the map is small when the subtree
+        // is, although the search and the simplification still visit the
+        // whole tree
+        SparseNodeMap<Context, bool> protected_nodes(context, true);
 
         // now set each of the nodes in the subtree so that they arent
         // protected
-        // protected_nodes[parent] = false;
-        // protected_nodes[child] = false;
         for (UndirectedBFSIterator<Context> it(context, parent, pivot);
                 !it.done(); ++it)
         {
@@ -385,10 +1008,544 @@ public:
         protected_nodes[pivot] = false;
 
         // perform the simplification
-        simplifyCore(context, protected_nodes);
+        simplifyCore(context, protected_nodes, measure, recorder);
+
+    }
+
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Persistence Hierarchy
+//
+////////////////////////////////////////////////////////////////////////////////
+
+/// \brief The order in which persistence simplification folds a tree.
+/// \ingroup simplified_contour_tree
+/*!
+ *  Simplifying with a larger threshold performs the same folds as with a
+ *  smaller one, followed by some more. The hierarchy runs the simplifier
+ *  once with no threshold, and records every collapse and reduction along
+ *  with its level: the largest persistence of any edge collapsed up to
+ *  that point. These levels never decrease, and simplifying with threshold
+ *  t performs exactly the folds whose level is at most t. Each collapse
+ *  removes one branch of the branch decomposition, whose persistence is
+ *  also recorded.
+ *
+ *  setThreshold then moves the tree between thresholds by replaying or
+ *  undoing only the folds in between, which takes time proportional to the
+ *  number of folds that change rather than to the size of the tree.
+ *
+ *  Folds are recorded by their node and edge folds, so they stay valid as
+ *  the tree is folded and unfolded. The tree must not be folded or expanded
+ *  other than through the hierarchy; if it has been, expand it fully with
+ *  expandTree() and call reset().
+ */
+template <typename FoldedTree>
+class PersistenceHierarchy
+{
+    typedef typename FoldedTree::Node Node;
+    typedef typename FoldedTree::Edge Edge;
+    typedef typename FoldedTree::NodeFold NodeFold;
+    typedef typename FoldedTree::EdgeFold EdgeFold;
+
+    enum OperationType { COLLAPSE, REDUCE };
+
+    struct Operation
+    {
+        OperationType type;
+
+        // the leaf of a collapse, or the node removed by a reduction
+        NodeFold node_fold;
+
+        // the node which a collapsed leaf was folded into
+        NodeFold base_fold;
 
+        double persistence;
+        double level;
+    };
+
+    struct LevelLess
+    {
+        bool operator()(double level, const Operation& operation) const {
+            return level < operation.level;
+        }
+    };
+
+    class Recorder
+    {
+        std::vector<Operation>& _operations;
+        double _level;
+
+    public:
+        Recorder(std::vector<Operation>& operations) :
+                _operations(operations), _level(0) {}
+
+        void collapsing(const FoldedTree& tree, Edge edge, double persistence)
+        {
+            Node u = tree.u(edge);
+            Node v = tree.v(edge);
+            Node base = tree.degree(u) == 1 ? v : u;
+            Node leaf = tree.opposite(base, edge);
+
+            _level = std::max(_level, persistence);
+
+            Operation operation;
+            operation.type = COLLAPSE;
+            operation.node_fold = tree.getNodeFold(leaf);
+            operation.base_fold = tree.getNodeFold(base);
+            operation.persistence = persistence;
+            operation.level = _level;
+            _operations.push_back(operation);
+        }
+
+        void reducing(const FoldedTree&, Node) {}
+
+        void reduced(const FoldedTree& tree, Edge edge)
+        {
+            EdgeFold edge_fold = tree.getEdgeFold(edge);
+
+            Operation operation;
+            operation.type = REDUCE;
+            operation.node_fold = tree.reducedFold(edge_fold);
+            operation.persistence = _level;
+            operation.level = _level;
+            _operations.push_back(operation);
+        }
+    };
+
+    FoldedTree& _tree;
+    std::vector<Operation> _operations;
+    size_t _applied;
+    SimplificationStatistics _statistics;
+
+    void replay(const Operation& operation)
+    {
+        if (operation.type == COLLAPSE)
+        {
+            Node leaf = _tree.getNodeFromFold(operation.node_fold);
+            UndirectedNeighborIterator<FoldedTree> it(_tree, leaf);
+            _tree.collapse(it.edge());
+        }
+        else
+        {
+            _tree.reduce(_tree.getNodeFromFold(operation.node_fold));
+        }
     }
 
+    void undo(const Operation& operation)
+    {
+        // the folds are looked up rather than assumed to be the most recent,
+        // as a FoldHistory may have refolded them in another order
+        if (operation.type == COLLAPSE)
+        {
+            _tree.uncollapse(
+                    _tree.getNodeFromFold(operation.base_fold),
+                    findCollapsedIndex(_tree, operation.base_fold,
+                                       operation.node_fold));
+        }
+        else
+        {
+            _tree.unreduce(findReducingEdge(_tree, operation.node_fold));
+        }
+    }
+
+public:
+
+    /// \brief Records the hierarchy of the tree.
+    /*!
+     *  The tree is simplified completely and then restored, so that it is
+     *  left as it was found. That state is the base of the hierarchy, which
+     *  corresponds to a negative threshold.
+     */
+    PersistenceHierarchy(FoldedTree& tree) : _tree(tree), _applied(0)
+    {
+        PersistenceSimplifier simplifier(
+                std::numeric_limits<double>::infinity());
+
+        Recorder recorder(_operations);
+        simplifier.simplify(_tree, recorder);
+        _statistics = simplifier.getStatistics();
+
+        _applied = _operations.size();
+        setNumberOfAppliedOperations(0);
+    }
+
+    /// \brief The number of folds in the complete simplification.
+    size_t numberOfOperations() const {
+        return _operations.size();
+    }
+
+    /// \brief Counts of the work done by the simplification which recorded
+    /// the hierarchy.
+    const SimplificationStatistics& getStatistics() const {
+        return _statistics;
+    }
+
+    /// \brief The number of folds currently applied to the tree.
+    size_t numberOfAppliedOperations() const {
+        return _applied;
+    }
+
+    /// \brief The smallest threshold at which the ith fold is applied.
+    double getLevel(size_t i) const {
+        return _operations[i].level;
+    }
+
+    /// \brief The persistence of the branch removed by the ith fold.
+    /*!
+     *  For a reduction, this is the level at which it happens.
+     */
+    double getPersistence(size_t i) const {
+        return _operations[i].persistence;
+    }
+
+    /// \brief Returns true if the ith fold is a collapse, false if it is a
+    /// reduction.
+    bool isCollapse(size_t i) const {
+        return _operations[i].type == COLLAPSE;
+    }
+
+    /// \brief Folds the tree as the simplifier would with the threshold.
+    /*!
+     *  A negative threshold restores the base of the hierarchy. Returns
+     *  true if the tree changed.
+     */
+    bool setThreshold(double threshold)
+    {
+        size_t n = std::upper_bound(_operations.begin(), _operations.end(),
+                                    threshold, LevelLess())
+                   - _operations.begin();
+
+        return setNumberOfAppliedOperations(n);
+    }
+
+    /// \brief Applies or undoes folds until the first n are applied.
+    /*!
+     *  Returns true if the tree changed.
+     */
+    bool setNumberOfAppliedOperations(size_t n)
+    {
+        if (n == _applied) {
+            return false;
+        }
+
+        while (_applied < n) {
+            replay(_operations[_applied++]);
+        }
+
+        while (_applied > n) {
+            undo(_operations[--_applied]);
+        }
+
+        return true;
+    }
+
+    /// \brief Declares that the tree is back at the base of the hierarchy.
+    /*!
+     *  Call this after the tree has been fully expanded with expandTree().
+     */
+    void reset() {
+        _applied = 0;
+    }
+};
+
+
+namespace {
+
+/// \brief Orders positions in a list of thresholds by their value.
+struct ThresholdPositionLess
+{
+    const std::vector<double>& thresholds;
+
+    ThresholdPositionLess(const std::vector<double>& thresholds) 
+        : thresholds(thresholds) {}
+
+    bool operator()(size_t i, size_t j) const {
+        return thresholds[i] < thresholds[j];
+    }
+};
+
+}
+
+
+/// \brief Simplifies the tree at each of several persistence thresholds.
+/// \ingroup simplified_contour_tree
+/*!
+ *  The simplification hierarchy is computed once, and the tree is moved up
+ *  it through the thresholds in increasing order, so each fold is applied
+ *  once no matter how many thresholds are given. At each threshold,
+ *  `visitor(tree, i, threshold)` is called, where i is the position of the
+ *  threshold in the list. Negative thresholds visit the unsimplified tree.
+ *
+ *  The tree is left as it was found.
+ */
+template <typename FoldedTree, typename Visitor>
+void simplifyAtEachThreshold(
+        FoldedTree& tree,
+        const std::vector<double>& thresholds,
+        Visitor& visitor)
+{
+    std::vector<size_t> order(thresholds.size());
+    for (size_t i=0; i<order.size(); ++i) {
+        order[i] = i;
+    }
+
+    std::stable_sort(order.begin(), order.end(),
+                     ThresholdPositionLess(thresholds));
+
+    PersistenceHierarchy<FoldedTree> hierarchy(tree);
+
+    for (size_t i=0; i<order.size(); ++i)
+    {
+        hierarchy.setThreshold(thresholds[order[i]]);
+        visitor(static_cast<const FoldedTree&>(tree), order[i],
+                thresholds[order[i]]);
+    }
+
+    hierarchy.setNumberOfAppliedOperations(0);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Fold History
+//
+////////////////////////////////////////////////////////////////////////////////
+
+/// \brief A versioned log of the folds and unfolds made to a tree.
+/// \ingroup simplified_contour_tree
+/*!
+ *  The history is a recorder for both the simplifier and expandSubtree().
+ *  Each operation it records creates a new version whose parent is the
+ *  version the tree was at, so the versions form a tree rooted at version 0:
+ *  the state of the tree when the history was created or last cleared.
+ *
+ *  restore() moves the tree to any recorded version by undoing operations up
+ *  to the common ancestor of the two versions, then replaying operations down
+ *  to the target. It takes time proportional to the number of operations in
+ *  which the versions differ, and creates no new versions, so switching back
+ *  and forth between two checkpoints is cheap.
+ *
+ *  Every fold and unfold made to the tree while the history is in use must
+ *  be recorded, otherwise the versions no longer describe the tree.
+ */
+template <typename FoldedTree>
+class FoldHistory
+{
+    typedef typename FoldedTree::Node Node;
+    typedef typename FoldedTree::Edge Edge;
+    typedef typename FoldedTree::NodeFold NodeFold;
+    typedef typename FoldedTree::EdgeFold EdgeFold;
+
+public:
+
+    typedef size_t Version;
+
+private:
+
+    enum OperationType { COLLAPSE, REDUCE, UNCOLLAPSE, UNREDUCE };
+
+    struct Operation
+    {
+        OperationType type;
+
+        // the leaf of a collapse, or the node removed by a reduction
+        NodeFold node_fold;
+
+        // the node which a collapsed leaf is folded into
+        NodeFold base_fold;
+    };
+
+    struct VersionRep
+    {
+        Version parent;
+        size_t depth;
+        Operation operation;
+    };
+
+    FoldedTree& _tree;
+    std::vector<VersionRep> _versions;
+    Version _current;
+
+    void record(const Operation& operation)
+    {
+        VersionRep version;
+        version.parent = _current;
+        version.depth = _versions[_current].depth + 1;
+        version.operation = operation;
+
+        _current = _versions.size();
+        _versions.push_back(version);
+    }
+
+    // folds are identified by their nodes: edge folds are replaced each
+    // time a node is reduced again
+
+    void collapse(const Operation& operation)
+    {
+        _tree.collapse(_tree.findEdge(
+                _tree.getNodeFromFold(operation.base_fold),
+                _tree.getNodeFromFold(operation.node_fold)));
+    }
+
+    void uncollapse(const Operation& operation)
+    {
+        _tree.uncollapse(
+                _tree.getNodeFromFold(operation.base_fold),
+                findCollapsedIndex(_tree, operation.base_fold,
+                                   operation.node_fold));
+    }
+
+    void reduce(const Operation& operation)
+    {
+        _tree.reduce(_tree.getNodeFromFold(operation.node_fold));
+    }
+
+    void unreduce(const Operation& operation)
+    {
+        _tree.unreduce(findReducingEdge(_tree, operation.node_fold));
+    }
+
+    void apply(const Operation& operation)
+    {
+        switch (operation.type)
+        {
+            case COLLAPSE: collapse(operation); break;
+            case REDUCE: reduce(operation); break;
+            case UNCOLLAPSE: uncollapse(operation); break;
+            case UNREDUCE: unreduce(operation); break;
+        }
+    }
+
+    void undo(const Operation& operation)
+    {
+        switch (operation.type)
+        {
+            case COLLAPSE: uncollapse(operation); break;
+            case REDUCE: unreduce(operation); break;
+            case UNCOLLAPSE: collapse(operation); break;
+            case UNREDUCE: reduce(operation); break;
+        }
+    }
+
+public:
+
+    /// \brief Starts a history whose version 0 is the tree's current state.
+    FoldHistory(FoldedTree& tree) : _tree(tree)
+    {
+        clear();
+    }
+
+    /// \brief The version the tree is at.
+    Version getVersion() const {
+        return _current;
+    }
+
+    /// \brief The number of versions recorded, including version 0.
+    size_t numberOfVersions() const {
+        return _versions.size();
+    }
+
+    /// \brief Forgets every version. The tree's current state becomes
+    /// version 0.
+    void clear()
+    {
+        VersionRep root;
+        root.parent = 0;
+        root.depth = 0;
+
+        _versions.clear();
+        _versions.push_back(root);
+        _current = 0;
+    }
+
+    /// \brief Folds and unfolds the tree until it is at the version.
+    /*!
+     *  Returns the number of operations undone or replayed.
+     */
+    size_t restore(Version version)
+    {
+        if (version >= _versions.size()) {
+            throw std::runtime_error("Version has not been recorded.");
+        }
+
+        // the versions to replay, from the target up to the common ancestor
+        std::vector<Version> path;
+        size_t n_operations = 0;
+
+        while (_versions[_current].depth > _versions[version].depth)
+        {
+            undo(_versions[_current].operation);
+            _current = _versions[_current].parent;
+            n_operations++;
+        }
+
+        while (_versions[version].depth > _versions[_current].depth)
+        {
+            path.push_back(version);
+            version = _versions[version].parent;
+        }
+
+        while (_current != version)
+        {
+            undo(_versions[_current].operation);
+            _current = _versions[_current].parent;
+            n_operations++;
+
+            path.push_back(version);
+            version = _versions[version].parent;
+        }
+
+        for (size_t i=path.size(); i>0; --i)
+        {
+            apply(_versions[path[i-1]].operation);
+            _current = path[i-1];
+        }
+
+        return n_operations + path.size();
+    }
+
+    void collapsing(const FoldedTree& tree, Edge edge, double)
+    {
+        Node u = tree.u(edge);
+        Node v = tree.v(edge);
+        Node base = tree.degree(u) == 1 ? v : u;
+
+        Operation operation;
+        operation.type = COLLAPSE;
+        operation.node_fold = tree.getNodeFold(tree.opposite(base, edge));
+        operation.base_fold = tree.getNodeFold(base);
+        record(operation);
+    }
+
+    void reducing(const FoldedTree&, Node) {}
+
+    void reduced(const FoldedTree& tree, Edge edge)
+    {
+        Operation operation;
+        operation.type = REDUCE;
+        operation.node_fold = tree.reducedFold(tree.getEdgeFold(edge));
+        record(operation);
+    }
+
+    void uncollapsed(const FoldedTree& tree, Node base, Edge edge)
+    {
+        Operation operation;
+        operation.type = UNCOLLAPSE;
+        operation.node_fold = tree.getNodeFold(tree.opposite(base, edge));
+        operation.base_fold = tree.getNodeFold(base);
+        record(operation);
+    }
+
+    void unreducing(const FoldedTree& tree, Edge edge)
+    {
+        Operation operation;
+        operation.type = UNREDUCE;
+        operation.node_fold = tree.reducedFold(tree.getEdgeFold(edge));
+        record(operation);
+    }
 };
 
 
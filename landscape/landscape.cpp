@@ -0,0 +1,703 @@
+// Copyright (c) 2014, Justin Eldridge, Mikhail Belkin, and Yusu Wang
+// at The Ohio State University. All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include <denali/contour_tree.h>
+#include <denali/fileio.h>
+#include <denali/folded.h>
+#include <denali/graph_maps.h>
+#include <denali/rectangular_landscape.h>
+#include <denali/simplify.h>
+
+// the following two functions are pasted from a stack overflow post
+// see: http://stackoverflow.com/questions/865668/parse-command-line-arguments
+char* getCmdOption(char ** begin, char ** end, const std::string & option)
+{
+    char ** itr = std::find(begin, end, option);
+    if (itr != end && ++itr != end)
+    {
+        return *itr;
+    }
+    return 0;
+}
+
+
+bool cmdOptionExists(char** begin, char** end, const std::string& option)
+{
+    return std::find(begin, end, option) != end;
+}
+
+typedef denali::FoldedContourTree<denali::ContourTree> FoldedContourTree;
+typedef denali::RectangularLandscape<FoldedContourTree> Landscape;
+
+
+// parses a nonnegative number given for the option
+double parseNonnegative(const std::string& option, const char* str)
+{
+    char* end;
+    double value = strtod(str, &end);
+
+    if (*str == 0 || *end != 0 || value < 0)
+    {
+        throw std::runtime_error(
+            "Could not interpret '" + std::string(str) + "' given for " +
+            option + ". It must be a nonnegative number.");
+    }
+
+    return value;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Colors
+//
+////////////////////////////////////////////////////////////////////////////////
+
+enum Reduction { MEAN_REDUCTION, MIN_REDUCTION, MAX_REDUCTION };
+
+
+Reduction parseReduction(const std::string& name)
+{
+    if (name == "mean") return MEAN_REDUCTION;
+    if (name == "min") return MIN_REDUCTION;
+    if (name == "max") return MAX_REDUCTION;
+
+    throw std::runtime_error("Unknown reduction '" + name + "'. The "
+                             "reduction must be mean, min or max.");
+}
+
+
+// reduces the color values of the members of a component, as the gui does
+// by default: the members of the edge and of both of its nodes are reduced,
+// along with the nodes themselves
+class ComponentReducer
+{
+    const FoldedContourTree& _tree;
+    const denali::ColorMap& _color_map;
+    Reduction _reduction;
+
+    size_t _n;
+    double _value;
+
+    void insert(denali::Identifier id)
+    {
+        denali::ColorMap::const_iterator it = _color_map.find(id);
+        if (it == _color_map.end()) {
+            std::stringstream message;
+            message << "The member '" << id << "' is not in the color map.";
+            throw std::runtime_error(message.str());
+        }
+
+        double value = it->second;
+        if (_n == 0) {
+            _value = value;
+        } else if (_reduction == MEAN_REDUCTION) {
+            _value += value;
+        } else if (_reduction == MIN_REDUCTION) {
+            _value = std::min(_value, value);
+        } else {
+            _value = std::max(_value, value);
+        }
+        ++_n;
+    }
+
+    void insertMembers(const FoldedContourTree::Members& members)
+    {
+        for (FoldedContourTree::Members::const_iterator it = members.begin();
+                it != members.end(); ++it) {
+            insert((*it).getID());
+        }
+    }
+
+    void insertNode(FoldedContourTree::Node node)
+    {
+        insert(_tree.getID(node));
+        insertMembers(_tree.getNodeMembers(node));
+    }
+
+public:
+    ComponentReducer(
+            const FoldedContourTree& tree,
+            const denali::ColorMap& color_map,
+            Reduction reduction)
+        : _tree(tree), _color_map(color_map), _reduction(reduction) {}
+
+    double reduce(FoldedContourTree::Edge edge)
+    {
+        _n = 0;
+        _value = 0;
+
+        insertMembers(_tree.getEdgeMembers(edge));
+        insertNode(_tree.u(edge));
+        insertNode(_tree.v(edge));
+
+        return _reduction == MEAN_REDUCTION ? _value / _n : _value;
+    }
+};
+
+
+// maps the value to a color on the gui's scale, from blue at the least
+// value through to red at the greatest, at full saturation and brightness
+void hueScale(double value, double min_value, double max_value,
+              unsigned char* rgb)
+{
+    double t = max_value > min_value ?
+            (value - min_value) / (max_value - min_value) : 0;
+    double hue = 4 * (1 - t);
+
+    int sector = std::min((int) hue, 3);
+    double f = hue - sector;
+
+    double r, g, b;
+    switch (sector)
+    {
+        case 0: r = 1; g = f; b = 0; break;
+        case 1: r = 1 - f; g = 1; b = 0; break;
+        case 2: r = 0; g = 1; b = f; break;
+        default: r = 0; g = 1 - f; b = 1; break;
+    }
+
+    rgb[0] = (unsigned char) (255 * r + 0.5);
+    rgb[1] = (unsigned char) (255 * g + 0.5);
+    rgb[2] = (unsigned char) (255 * b + 0.5);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Mesh
+//
+////////////////////////////////////////////////////////////////////////////////
+
+typedef denali::rectangular::IndexBuffer IndexBuffer;
+
+
+// the landscape flattened into buffers ready to be written
+struct Mesh
+{
+    std::vector<float> vertices;
+    Landscape::IndexedMesh primitives;
+
+    // one color per primitive, if a color map was given: those of the
+    // triangles, then of the strips, then of the fans
+    std::vector<unsigned char> colors;
+
+    size_t numberOfVertices() const {
+        return vertices.size() / 3;
+    }
+
+    size_t numberOfTriangles() const {
+        return primitives.getTriangles().numberOfPrimitives();
+    }
+
+    const std::vector<boost::uint32_t>& triangleIndices() const {
+        return primitives.getTriangles().getIndices();
+    }
+};
+
+
+// copies the landscape's points and primitives. if the height is
+// normalized, it is scaled to lie between zero and one, as the gui displays it
+void buildMesh(
+        const Landscape& landscape,
+        bool normalize_height,
+        Landscape::IndexedMesh::Primitives primitives,
+        Mesh& mesh)
+{
+    double min_z = landscape.getMinPoint().z();
+    double z_range = landscape.getMaxPoint().z() - min_z;
+
+    mesh.vertices.resize(3 * landscape.numberOfPoints());
+    for (size_t i=0; i<landscape.numberOfPoints(); ++i)
+    {
+        Landscape::Point point = landscape.getPoint(i);
+        double z = point.z();
+        if (normalize_height) {
+            z = z_range > 0 ? (z - min_z) / z_range : 0;
+        }
+
+        mesh.vertices[3*i] = (float) point.x();
+        mesh.vertices[3*i + 1] = (float) point.y();
+        mesh.vertices[3*i + 2] = (float) z;
+    }
+
+    landscape.getIndexedMesh(mesh.primitives, primitives);
+}
+
+
+// colors each primitive by the reduced color value of its component
+void colorMesh(
+        const Landscape& landscape,
+        const FoldedContourTree& tree,
+        const denali::ColorMap& color_map,
+        Reduction reduction,
+        Mesh& mesh)
+{
+    ComponentReducer reducer(tree, color_map, reduction);
+    denali::StaticArcMap<Landscape, double> values(landscape, 0);
+
+    double min_value = 0, max_value = 0;
+    bool first = true;
+    for (denali::ArcIterator<Landscape> it(landscape); !it.done(); ++it)
+    {
+        double value = reducer.reduce(landscape.getContourTreeEdge(it.arc()));
+        values[it.arc()] = value;
+
+        if (first || value < min_value) min_value = value;
+        if (first || value > max_value) max_value = value;
+        first = false;
+    }
+
+    const IndexBuffer* buffers[3] = {
+        &mesh.primitives.getTriangles(),
+        &mesh.primitives.getStrips(),
+        &mesh.primitives.getFans()
+    };
+
+    mesh.colors.clear();
+    for (int i=0; i<3; ++i)
+    {
+        const std::vector<boost::uint32_t>& arcs = buffers[i]->getArcIdentifiers();
+        for (size_t j=0; j<arcs.size(); ++j)
+        {
+            unsigned char rgb[3];
+            Landscape::Arc arc = landscape.getComponentFromIdentifier(arcs[j]);
+            hueScale(values[arc], min_value, max_value, rgb);
+            mesh.colors.insert(mesh.colors.end(), rgb, rgb + 3);
+        }
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Output
+//
+////////////////////////////////////////////////////////////////////////////////
+
+// binary output is little endian, whatever the byte order of the machine
+void writeUInt32(std::ostream& out, boost::uint32_t value)
+{
+    char bytes[4];
+    for (int i=0; i<4; ++i) {
+        bytes[i] = (char) ((value >> (8*i)) & 0xff);
+    }
+    out.write(bytes, 4);
+}
+
+
+void writeFloat32(std::ostream& out, float value)
+{
+    boost::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeUInt32(out, bits);
+}
+
+
+void openOutputFile(const char* filename, std::ofstream& out)
+{
+    out.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error(
+            "Could not open " + std::string(filename) + " for writing.");
+    }
+}
+
+
+void writePly(const char* filename, const Mesh& mesh)
+{
+    std::ofstream out;
+    openOutputFile(filename, out);
+
+    out << "ply\n"
+        << "format binary_little_endian 1.0\n"
+        << "comment written by denali\n"
+        << "element vertex " << mesh.numberOfVertices() << "\n"
+        << "property float x\n"
+        << "property float y\n"
+        << "property float z\n"
+        << "element face " << mesh.numberOfTriangles() << "\n"
+        << "property list uchar uint vertex_indices\n";
+
+    if (!mesh.colors.empty()) {
+        out << "property uchar red\n"
+            << "property uchar green\n"
+            << "property uchar blue\n";
+    }
+
+    out << "end_header\n";
+
+    for (size_t i=0; i<mesh.vertices.size(); ++i) {
+        writeFloat32(out, mesh.vertices[i]);
+    }
+
+    for (size_t i=0; i<mesh.numberOfTriangles(); ++i)
+    {
+        out.put(3);
+        for (int j=0; j<3; ++j) {
+            writeUInt32(out, mesh.triangleIndices()[3*i + j]);
+        }
+
+        if (!mesh.colors.empty()) {
+            out.write((const char*) &mesh.colors[3*i], 3);
+        }
+    }
+
+    if (!out) {
+        throw std::runtime_error("Could not write " + std::string(filename) + ".");
+    }
+}
+
+
+// obj is a text format, and has no standard way of coloring faces
+void writeObj(const char* filename, const Mesh& mesh)
+{
+    std::ofstream out;
+    openOutputFile(filename, out);
+
+    out.precision(9);
+    out << "# written by denali\n";
+
+    for (size_t i=0; i<mesh.numberOfVertices(); ++i)
+    {
+        out << "v " << mesh.vertices[3*i] << " " << mesh.vertices[3*i + 1]
+            << " " << mesh.vertices[3*i + 2] << "\n";
+    }
+
+    // obj indices start at one
+    for (size_t i=0; i<mesh.numberOfTriangles(); ++i)
+    {
+        const boost::uint32_t* indices = &mesh.triangleIndices()[3*i];
+        out << "f " << indices[0] + 1 << " " << indices[1] + 1
+            << " " << indices[2] + 1 << "\n";
+    }
+
+    if (!out) {
+        throw std::runtime_error("Could not write " + std::string(filename) + ".");
+    }
+}
+
+
+void writeRaw(const char* filename, const Mesh& mesh)
+{
+    std::ofstream out;
+    openOutputFile(filename, out);
+
+    const IndexBuffer* buffers[3] = {
+        &mesh.primitives.getTriangles(),
+        &mesh.primitives.getStrips(),
+        &mesh.primitives.getFans()
+    };
+
+    writeUInt32(out, IndexBuffer::toIndex(mesh.numberOfVertices()));
+    for (int i=0; i<3; ++i) {
+        writeUInt32(out, IndexBuffer::toIndex(buffers[i]->numberOfPrimitives()));
+    }
+    writeUInt32(out, mesh.colors.empty() ? 0 : 1);
+
+    for (size_t i=0; i<mesh.vertices.size(); ++i) {
+        writeFloat32(out, mesh.vertices[i]);
+    }
+
+    for (int i=0; i<3; ++i)
+    {
+        const std::vector<boost::uint32_t>& indices = buffers[i]->getIndices();
+        for (size_t j=0; j<indices.size(); ++j) {
+            writeUInt32(out, indices[j]);
+        }
+    }
+
+    for (int i=0; i<3; ++i)
+    {
+        const std::vector<boost::uint32_t>& arcs = buffers[i]->getArcIdentifiers();
+        for (size_t j=0; j<arcs.size(); ++j) {
+            writeUInt32(out, arcs[j]);
+        }
+    }
+
+    if (!mesh.colors.empty()) {
+        out.write((const char*) &mesh.colors[0], mesh.colors.size());
+    }
+
+    if (!out) {
+        throw std::runtime_error("Could not write " + std::string(filename) + ".");
+    }
+}
+
+
+// the format is given, or else is that of the output file's extension
+std::string chooseFormat(const char* format, const std::string& filename)
+{
+    std::string chosen;
+    if (format) {
+        chosen = format;
+    } else {
+        size_t dot = filename.rfind('.');
+        if (dot != std::string::npos) {
+            chosen = filename.substr(dot + 1);
+        }
+    }
+
+    if (chosen != "ply" && chosen != "obj" && chosen != "raw") {
+        throw std::runtime_error(
+            "Could not determine the output format. Give --format as ply, "
+            "obj or raw, or use one of these as the output file's extension.");
+    }
+
+    return chosen;
+}
+
+
+FoldedContourTree::Node chooseRoot(
+        const FoldedContourTree& tree,
+        const char* root)
+{
+    if (!root || std::string(root) == "min") {
+        return denali::findMinNode(tree);
+    }
+
+    if (std::string(root) == "max") {
+        return denali::findMaxNode(tree);
+    }
+
+    denali::Identifier id;
+    if (!denali::parseIdentifier(root, id)) {
+        throw std::runtime_error("Could not interpret '" + std::string(root) +
+                                 "' as a root. Give min, max, or a node ID.");
+    }
+
+    FoldedContourTree::Node node = tree.getNode(id);
+    if (!tree.isNodeValid(node)) {
+        throw std::runtime_error(
+            "The root " + std::string(root) + " is not a node of the tree, "
+            "or was folded away by simplification.");
+    }
+
+    return node;
+}
+
+
+int main(int argc, char ** argv) try
+{
+    std::string usage =
+        "usage: landscape <tree file> <output file>\n"
+        "                 [--format <ply|obj|raw>] [--weights <filename>]\n"
+        "                 [--colors <filename>] [--reduction <mean|min|max>]\n"
+        "                 [--simplify <threshold>] [--root <min|max|id>]\n"
+        "                 [--min-area <area>] [--normalize-height]\n"
+        "                 [--strips] [--squarify]\n"
+        "\n"
+        "Builds the rectangular landscape of a contour tree, as the denali\n"
+        "gui would display it, and writes it as a triangle mesh. No display\n"
+        "is needed.\n"
+        "\n"
+        "Required arguments:\n"
+        "<tree file>\n"
+        "\tThe contour tree, in the format written by ctree.\n"
+        "\n"
+        "<output file>\n"
+        "\tThe file in which to place the mesh. The file will be overwritten\n"
+        "\twithout warning.\n"
+        "\n"
+        "Optional arguments:\n"
+        "--format <ply|obj|raw>\n"
+        "\tThe format of the mesh. By default, this is the output file's\n"
+        "\textension. ply is binary, little endian PLY, with float vertices\n"
+        "\tand uint indices. obj is Wavefront OBJ, which is a text format.\n"
+        "\traw is a little endian buffer. It begins with five uint32: the\n"
+        "\tnumbers of vertices, triangles, strips and fans, and 1 if there\n"
+        "\tare colors or else 0. Then come three float32 coordinates per\n"
+        "\tvertex; the uint32 vertex indices of the triangles, three apiece,\n"
+        "\tof the strips, ten apiece, and of the fans, six apiece; the uint32\n"
+        "\tID of the landscape arc drawn by each triangle, strip and fan; and\n"
+        "\tif there are colors, three uint8 color channels for each.\n"
+        "\n"
+        "--weights <filename>\n"
+        "\tWeight the vertices by the weight map in the file, as the gui\n"
+        "\tdoes. Unlisted vertices have weight one.\n"
+        "\n"
+        "--colors <filename>\n"
+        "\tColor each triangle by its component, as the gui does: the values\n"
+        "\tin the color map of the component's members and nodes are reduced\n"
+        "\tto one, which is then colored from blue, for the least, to red,\n"
+        "\tfor the greatest. Colors are written to ply and raw files only.\n"
+        "\n"
+        "--reduction <mean|min|max>\n"
+        "\tHow the color values of a component are reduced. The default is\n"
+        "\tmean.\n"
+        "\n"
+        "--simplify <threshold>\n"
+        "\tSimplify the tree by persistence at the threshold first.\n"
+        "\n"
+        "--root <min|max|id>\n"
+        "\tRoot the landscape at the node with the least value, the node with\n"
+        "\tthe greatest value, or the node with the ID. The default is min.\n"
+        "\n"
+        "--min-area <area>\n"
+        "\tDraw each subtree whose rectangle has less than this area, as a\n"
+        "\tfraction of the whole landscape, as a single cell.\n"
+        "\n"
+        "--normalize-height\n"
+        "\tScale the heights of the points to lie between zero and one, as\n"
+        "\tthe gui displays them, instead of writing the values of the tree.\n"
+        "\n"
+        "--strips\n"
+        "\tDraw each nested rectangle with a triangle strip and each nested\n"
+        "\tpoint with a triangle fan, instead of with triangles. This needs\n"
+        "\tless than half as many indices. raw files only.\n"
+        "\n"
+        "--squarify\n"
+        "\tSplit each rectangle among its children as a squarified treemap,\n"
+        "\tinto rows of rectangles near to square, instead of into slices.\n";
+
+    if (cmdOptionExists(argv, argv + argc, "-h") ||
+            cmdOptionExists(argv, argv + argc, "--help")) {
+        std::cout << usage << std::endl;
+        return 0;
+    }
+
+    if (argc < 3) {
+        std::cerr << "Insufficient number of arguments provided." << std::endl;
+        std::cerr << usage << std::endl;
+        return 1;
+    }
+
+    char* format_option = getCmdOption(argv, argv + argc, "--format");
+    char* weight_file = getCmdOption(argv, argv + argc, "--weights");
+    char* color_file = getCmdOption(argv, argv + argc, "--colors");
+    char* reduction_option = getCmdOption(argv, argv + argc, "--reduction");
+    char* simplify_option = getCmdOption(argv, argv + argc, "--simplify");
+    char* root_option = getCmdOption(argv, argv + argc, "--root");
+    char* min_area_option = getCmdOption(argv, argv + argc, "--min-area");
+    bool normalize_height = cmdOptionExists(argv, argv + argc, "--normalize-height");
+    bool strips = cmdOptionExists(argv, argv + argc, "--strips");
+    bool squarify = cmdOptionExists(argv, argv + argc, "--squarify");
+
+    try {
+        // check the options before doing any work
+        std::string format = chooseFormat(format_option, argv[2]);
+
+        if (color_file && format == "obj") {
+            throw std::runtime_error(
+                "Colors can only be written to ply or raw files.");
+        }
+
+        if (strips && format != "raw") {
+            throw std::runtime_error(
+                "Strips and fans can only be written to raw files.");
+        }
+
+        Reduction reduction = MEAN_REDUCTION;
+        if (reduction_option) {
+            reduction = parseReduction(reduction_option);
+        }
+
+        double min_area = 0;
+        if (min_area_option) {
+            min_area = parseNonnegative("--min-area", min_area_option);
+        }
+
+        double threshold = 0;
+        if (simplify_option) {
+            threshold = parseNonnegative("--simplify", simplify_option);
+        }
+
+        // read the inputs
+        denali::ContourTree contour_tree =
+                denali::readContourTreeFile(argv[1]);
+
+        denali::WeightMap weight_map;
+        if (weight_file) {
+            denali::readWeightMapFile(weight_file, weight_map);
+        }
+
+        denali::ColorMap color_map;
+        if (color_file) {
+            denali::readColorMapFile(color_file, color_map);
+        }
+
+        // fold the tree, which keeps the weights of its subtrees as the gui's does
+        FoldedContourTree folded_tree(contour_tree);
+        if (weight_file) {
+            folded_tree.setWeightMap(&weight_map);
+        }
+
+        if (simplify_option) {
+            denali::PersistenceSimplifier simplifier(threshold);
+            simplifier.simplify(folded_tree);
+        }
+
+        FoldedContourTree::Node root = chooseRoot(folded_tree, root_option);
+
+        // build the landscape
+        boost::scoped_ptr<Landscape> landscape(
+                denali::RectangularLandscapeBuilder<FoldedContourTree>::build(
+                        folded_tree, root, denali::ContourTreeWeights(),
+                        denali::rectangular::LevelOfDetail(min_area),
+                        squarify ? denali::rectangular::SQUARIFIED :
+                                   denali::rectangular::SLICE_AND_DICE));
+
+        Mesh mesh;
+        buildMesh(*landscape, normalize_height,
+                  strips ? Landscape::IndexedMesh::STRIPS_AND_FANS :
+                           Landscape::IndexedMesh::TRIANGLES,
+                  mesh);
+
+        if (color_file) {
+            colorMesh(*landscape, folded_tree, color_map, reduction, mesh);
+        }
+
+        if (format == "ply") {
+            writePly(argv[2], mesh);
+        } else if (format == "obj") {
+            writeObj(argv[2], mesh);
+        } else {
+            writeRaw(argv[2], mesh);
+        }
+    }
+    catch (std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+catch (std::exception& e) {
+    std::cerr << "Fatal error: an uncaught exception occurred:"
+              << e.what();
+}
@@ -33,6 +33,7 @@
 #include <denali/fileio.h>
 #include <denali/folded.h>
 #include <denali/graph_iterators.h>
+#include <denali/rectangular_landscape.h>
 #include <denali/simplify.h>
 
 class Point
@@ -278,7 +279,7 @@ class LandscapeContext
 {
 
 public:
-    typedef std::pair<unsigned int, double> Member;
+    typedef std::pair<denali::Identifier, double> Member;
     typedef std::set<Member> Members;
 
     struct SubtreeArc
@@ -309,7 +310,7 @@ public:
 
     virtual bool isValid() const = 0;
 
-    virtual bool isNodeValid(unsigned int) const = 0;
+    virtual bool isNodeValid(denali::Identifier) const = 0;
 
     virtual unsigned int getDegree(size_t) const = 0;
 
@@ -320,6 +321,9 @@ public:
     virtual size_t numberOfTriangles() const = 0;
     virtual Triangle getTriangle(size_t i) const = 0;
 
+    /// \brief Copies the triangles into a flat buffer of indices
+    virtual void getIndexedMesh(denali::rectangular::IndexedMesh&) const = 0;
+
     /// \brief Get the component ID of the ith cell
     virtual size_t getComponentIdentifierFromTriangle(size_t i) const = 0;
 
@@ -341,14 +345,18 @@ public:
 
     virtual double getMaxPersistence() const = 0;
 
-    virtual void simplifySubtreeByPersistence(size_t, size_t, double) = 0;
+    /// \brief Simplifies the subtree below a component. Returns true if the
+    /// landscape was refined in place, and false if it must be built again.
+    virtual bool simplifySubtreeByPersistence(size_t, size_t, double) = 0;
+    virtual bool simplifyByPersistence(double) = 0;
+    virtual denali::SimplificationStatistics getSimplificationStatistics() const = 0;
     virtual void expandLandscape() = 0;
 
     virtual void setWeightMap(boost::shared_ptr<denali::WeightMap>) = 0;
 
     virtual void setColorMap(boost::shared_ptr<denali::ColorMap>) = 0;
     virtual void setColorReduction(boost::shared_ptr<Reduction>) = 0;
-    virtual double getComponentReductionValue(unsigned int) = 0;
+    virtual double getComponentReductionValue(denali::Identifier) = 0;
     virtual double getComponentReductionValue(size_t, size_t) = 0;
     virtual double getMaxReductionValue() = 0;
     virtual double getMinReductionValue() = 0;
@@ -379,6 +387,8 @@ class ConcreteLandscapeContext : public LandscapeContext
     typedef denali::ColorMap ColorMap;
     typedef denali::WeightMap WeightMap;
     typedef denali::ObservingEdgeMap<FoldedContourTree, double> ReductionMap;
+    typedef denali::PersistenceHierarchy<FoldedContourTree> Hierarchy;
+    typedef denali::FoldHistory<FoldedContourTree> History;
 
     boost::shared_ptr<ContourTree> _contour_tree;
     boost::shared_ptr<LandscapeBuilder> _landscape_builder;
@@ -388,6 +398,15 @@ class ConcreteLandscapeContext : public LandscapeContext
     boost::shared_ptr<Reduction> _reduction;
 
     FoldedContourTree _folded_tree;
+    boost::shared_ptr<Hierarchy> _hierarchy;
+    denali::SimplificationStatistics _simplification_statistics;
+
+    // records folds made other than by the hierarchy, so that they can be
+    // undone without re-expanding the tree
+    boost::shared_ptr<History> _history;
+
+    // true if the tree has been folded other than by the hierarchy
+    bool _folds_modified;
 
     boost::shared_ptr<ReductionMap> _reduction_map;
     double _max_reduction;
@@ -399,7 +418,7 @@ class ConcreteLandscapeContext : public LandscapeContext
     bool _child_in_reduction;
     bool _members_in_reduction;
 
-    virtual double getColorMapValue(unsigned int id) const
+    virtual double getColorMapValue(denali::Identifier id) const
     {
         ColorMap::const_iterator it = (*_color_map).find(id);
         if (it == (*_color_map).end()) {
@@ -421,6 +440,13 @@ class ConcreteLandscapeContext : public LandscapeContext
         if (!_folded_tree.isEdgeValid(edge))
             throw std::runtime_error("Invalid edge for reduction.");
 
+        // the members of a node are iterated once for each of its arcs, so
+        // store those of the edge and its nodes contiguously
+        typename FoldedContourTree::Node child = _folded_tree.opposite(parent, edge);
+        _folded_tree.flattenMembers(edge);
+        _folded_tree.flattenMembers(parent);
+        _folded_tree.flattenMembers(child);
+
         // get the edge's members
         const Members& edge_members = _folded_tree.getEdgeMembers(edge);
 
@@ -432,7 +458,7 @@ class ConcreteLandscapeContext : public LandscapeContext
             for (typename Members::const_iterator it = edge_members.begin();
                     it != edge_members.end(); ++it)
             {
-                unsigned int member_id = (*it).getID();
+                denali::Identifier member_id = (*it).getID();
 
                 // the reference value is the value of the contour tree node
                 double reference_value = (*it).getValue();
@@ -440,17 +466,15 @@ class ConcreteLandscapeContext : public LandscapeContext
                 // lookup the member in the color map
                 double color_value = getColorMapValue(member_id);
 
-                // insert the unsigned int id of the member
+                // insert the id of the member
                 _reduction->insert(reference_value, color_value);
             }
         }
 
         // do the same for each of the edge's nodes
-        typename FoldedContourTree::Node child = _folded_tree.opposite(parent, edge);
-
         if (_parent_in_reduction)
         {
-            unsigned int parent_id = _folded_tree.getID(parent);
+            denali::Identifier parent_id = _folded_tree.getID(parent);
             double parent_reference_value = _folded_tree.getValue(parent);
             double parent_color_value = getColorMapValue(parent_id);
             _reduction->insert(parent_reference_value, parent_color_value);
@@ -460,7 +484,7 @@ class ConcreteLandscapeContext : public LandscapeContext
             for (typename Members::const_iterator it = node_members.begin();
                     it != node_members.end(); ++it)
             {
-                unsigned int member_id = (*it).getID();
+                denali::Identifier member_id = (*it).getID();
 
                 // the reference value is the value of the contour tree node
                 double reference_value = (*it).getValue();
@@ -468,14 +492,14 @@ class ConcreteLandscapeContext : public LandscapeContext
                 // lookup the member in the color map
                 double color_value = getColorMapValue(member_id);
 
-                // insert the unsigned int id of the member
+                // insert the id of the member
                 _reduction->insert(reference_value, color_value);
             }
         }
 
         if (_child_in_reduction)
         {
-            unsigned int child_id = _folded_tree.getID(child);
+            denali::Identifier child_id = _folded_tree.getID(child);
             double child_reference_value = _folded_tree.getValue(child);
             double child_color_value = getColorMapValue(child_id);
             _reduction->insert(child_reference_value, child_color_value);
@@ -485,7 +509,7 @@ class ConcreteLandscapeContext : public LandscapeContext
             for (typename Members::const_iterator it = node_members.begin();
                     it != node_members.end(); ++it)
             {
-                unsigned int member_id = (*it).getID();
+                denali::Identifier member_id = (*it).getID();
 
                 // the reference value is the value of the contour tree node
                 double reference_value = (*it).getValue();
@@ -493,7 +517,7 @@ class ConcreteLandscapeContext : public LandscapeContext
                 // lookup the member in the color map
                 double color_value = getColorMapValue(member_id);
 
-                // insert the unsigned int id of the member
+                // insert the id of the member
                 _reduction->insert(reference_value, color_value);
             }
         }
@@ -538,22 +562,23 @@ public:
             _landscape_builder(boost::shared_ptr<LandscapeBuilder>(
                     new LandscapeBuilder)),
             _folded_tree(*_contour_tree),
+            _hierarchy(new Hierarchy(_folded_tree)),
+            _history(new History(_folded_tree)),
+            _folds_modified(false),
             _reduction_map(new ReductionMap(_folded_tree)),
             _parent_in_reduction(true),
             _child_in_reduction(true),
             _members_in_reduction(true)
     {
         _max_persistence = computeMaxPersistence(*_contour_tree);
-        
-        denali::PersistenceSimplifier simplifier(15); 
-        // simplifier.simplify(_folded_tree);
+        _simplification_statistics = _hierarchy->getStatistics();
     }
 
     virtual bool isValid() const {
         return _landscape;
     }
 
-    virtual bool isNodeValid(unsigned int id) const 
+    virtual bool isNodeValid(denali::Identifier id) const 
     {
         // make a node with the identifier
         typename FoldedContourTree::Node node = 
@@ -567,14 +592,17 @@ public:
         typename FoldedContourTree::Node root = _folded_tree.getNode(root_id);
         Landscape* lscape;
 
-        if (_weight_map)
+        // if the tree has not been folded since the landscape was built,
+        // the landscape need only be re-oriented
+        if (!_landscape || !_landscape->changeRoot(root))
         {
-            lscape = _landscape_builder->build(_folded_tree, root, &*_weight_map);
-        } else {
-            lscape = _landscape_builder->build(_folded_tree, root);
-        }
+            // the folded tree keeps the subtree weights up to date as it is
+            // folded, so the landscape need not sum the whole tree's members
+            lscape = _landscape_builder->build(
+                    _folded_tree, root, denali::ContourTreeWeights());
 
-        _landscape = boost::shared_ptr<Landscape>(lscape);
+            _landscape = boost::shared_ptr<Landscape>(lscape);
+        }
 
         if (_color_map && _reduction) computeReductions();
     }
@@ -640,6 +668,10 @@ public:
         return Triangle(tri.i(), tri.j(), tri.k(), i);
     }
 
+    virtual void getIndexedMesh(denali::rectangular::IndexedMesh& mesh) const {
+        _landscape->getIndexedMesh(mesh);
+    }
+
     virtual void getComponentParentChild(size_t i, size_t& parent, size_t& child) const
     {
         // get the triangle of this cell
@@ -689,7 +721,7 @@ public:
         return _max_persistence+1;
     }
 
-    virtual void simplifySubtreeByPersistence(
+    virtual bool simplifySubtreeByPersistence(
             size_t parent_id,
             size_t child_id,
             double persistence)
@@ -698,16 +730,71 @@ public:
         parent_node = _folded_tree.getNode(parent_id);
         child_node  = _folded_tree.getNode(child_id);
 
-        expandSubtree(_folded_tree, parent_node, child_node);
+        // the arc of the landscape under which the subtree hangs
+        typename Landscape::Arc arc;
+        if (_landscape) {
+            arc = _landscape->findArc(
+                    _landscape->getLandscapeTreeNode(parent_node),
+                    _landscape->getLandscapeTreeNode(child_node));
+        }
+
+        beginModifyingFolds();
+        expandSubtree(_folded_tree, parent_node, child_node, *_history);
+
         denali::PersistenceSimplifier simplifier(persistence); 
+        denali::PersistenceMeasure measure;
+        simplifier.simplifySubtree(
+                _folded_tree, parent_node, child_node, measure, *_history);
+
+        _simplification_statistics = simplifier.getStatistics();
 
-        simplifier.simplifySubtree(_folded_tree, parent_node, child_node);
+        // only the subtree has changed, so only it is embedded again
+        if (!_landscape || !_landscape->isArcValid(arc) ||
+                !_landscape->reembedSubtree(arc)) {
+            return false;
+        }
+
+        if (_color_map && _reduction) computeReductions();
+        return true;
+    }
+
+    /// \brief Counts of the work done by the last simplification.
+    virtual denali::SimplificationStatistics getSimplificationStatistics() const
+    {
+        return _simplification_statistics;
+    }
+
+    /// \brief Simplifies the whole tree to the persistence threshold.
+    /// A negative threshold leaves the tree unsimplified. Returns true if
+    /// the tree changed, in which case the landscape must be rebuilt.
+    virtual bool simplifyByPersistence(double persistence)
+    {
+        bool changed = false;
+
+        // the hierarchy can only move from the state in which it left the
+        // tree, so undo any subtree refinement first
+        if (_folds_modified)
+        {
+            _history->restore(0);
+            _folds_modified = false;
+            changed = true;
+
+            // unreductions leave holes in the edge fold storage. The
+            // hierarchy holds only node folds, so compaction is safe here
+            if (_folded_tree.getMaxEdgeFoldIdentifier() >
+                    2 * _folded_tree.numberOfEdgeFolds()) {
+                _folded_tree.compactFolds();
+            }
+        }
+
+        return _hierarchy->setThreshold(persistence) || changed;
     }
 
     /// \brief Sets the weight map, assuming ownership of the memory.
     virtual void setWeightMap(boost::shared_ptr<WeightMap> weight_map)
     {
         _weight_map = weight_map;
+        _folded_tree.setWeightMap(_weight_map.get());
     }
 
     /// \brief Get the component ID of the ith triangle.
@@ -737,7 +824,7 @@ public:
         if (_color_map && _reduction) computeReductions();
     }
 
-    virtual double getComponentReductionValue(unsigned int component_id)
+    virtual double getComponentReductionValue(denali::Identifier component_id)
     {
         assert(_color_map && _reduction);
 
@@ -833,7 +920,8 @@ public:
         child_node  = _folded_tree.getNode(child_id);
 
         // expand the tree
-        expandSubtree(_folded_tree, parent_node, child_node);
+        beginModifyingFolds();
+        expandSubtree(_folded_tree, parent_node, child_node, *_history);
 
         typedef denali::UndirectedScalarMemberIDGraph Graph;
         denali::StaticNodeMap<FoldedContourTree, Graph::Node> old_to_new(_folded_tree);
@@ -848,7 +936,7 @@ public:
         for (denali::UndirectedBFSIterator<FoldedContourTree> it(_folded_tree, parent_node, child_node);
                 !it.done(); ++it)
         {
-            unsigned int node_id = _folded_tree.getID(it.child());
+            denali::Identifier node_id = _folded_tree.getID(it.child());
             double node_value = _folded_tree.getValue(it.child());
             Graph::Node new_node = new_tree->addNode(node_id, node_value);
 
@@ -864,7 +952,7 @@ public:
             typename FoldedContourTree::Members::const_iterator m_it = old_members.begin();
             for (; m_it != old_members.end(); ++m_it) 
             {
-                unsigned int member_id = (*m_it).getID();
+                denali::Identifier member_id = (*m_it).getID();
                 double member_value = (*m_it).getValue();
 
                 Graph::Member new_member(member_id, member_value);
@@ -890,16 +978,17 @@ public:
 
         Node node;
         node = _folded_tree.getNode(u);
-        
+
+        _folded_tree.flattenMembers(node);
         const Members& members = _folded_tree.getNodeMembers(node);
 
-        std::set<std::pair<unsigned int, double> > member_set;
+        std::set<std::pair<denali::Identifier, double> > member_set;
         for (typename Members::const_iterator it = members.begin();
                 it != members.end(); ++it)
         {
-            unsigned int id = (*it).getID();
+            denali::Identifier id = (*it).getID();
             double value = (*it).getValue();
-            std::pair<unsigned int, double> member(id, value);
+            std::pair<denali::Identifier, double> member(id, value);
             member_set.insert(member);
         }
 
@@ -917,17 +1006,18 @@ public:
         child_node  = _folded_tree.getNode(v);
 
         Edge edge = _folded_tree.findEdge(parent_node, child_node);
-        
+
+        _folded_tree.flattenMembers(edge);
         const typename FoldedContourTree::Members& members = 
                 _folded_tree.getEdgeMembers(edge);
 
-        std::set<std::pair<unsigned int, double> > member_set;
+        std::set<std::pair<denali::Identifier, double> > member_set;
         for (typename FoldedContourTree::Members::const_iterator it = members.begin();
                 it != members.end(); ++it)
         {
-            unsigned int id = (*it).getID();
+            denali::Identifier id = (*it).getID();
             double value = (*it).getValue();
-            std::pair<unsigned int, double> member(id, value);
+            std::pair<denali::Identifier, double> member(id, value);
             member_set.insert(member);
         }
 
@@ -952,15 +1042,18 @@ public:
 
         for (; !it.done(); ++it)
         {
+            _folded_tree.flattenMembers(it.edge());
+            _folded_tree.flattenMembers(it.child());
+
             const typename FoldedContourTree::Members& edge_members = 
                     _folded_tree.getEdgeMembers(it.edge());
 
             for (MembersIt m_it = edge_members.begin(); m_it != edge_members.end();
                     ++m_it)
             {
-                unsigned int id = (*m_it).getID();
+                denali::Identifier id = (*m_it).getID();
                 double value = (*m_it).getValue();
-                std::pair<unsigned int, double> member(id, value);
+                std::pair<denali::Identifier, double> member(id, value);
                 member_set.insert(member);
             }
 
@@ -970,9 +1063,9 @@ public:
             for (MembersIt m_it = node_members.begin(); m_it != node_members.end();
                     ++m_it)
             {
-                unsigned int id = (*m_it).getID();
+                denali::Identifier id = (*m_it).getID();
                 double value = (*m_it).getValue();
-                std::pair<unsigned int, double> member(id, value);
+                std::pair<denali::Identifier, double> member(id, value);
                 member_set.insert(member);
             }
         }
@@ -1041,26 +1134,22 @@ public:
 
     virtual void expandLandscape()
     {
-        // get the root of the landscape
-        typedef typename FoldedContourTree::Node Node;
-        Node root = _landscape->getContourTreeNode(_landscape->getRoot());
+        // the landscape is connected, so expanding every edge outward from
+        // its root expands the whole tree, which is done in a single batch
+        beginModifyingFolds();
+        denali::expandTree(_folded_tree, *_history);
+    }
 
-        // now we expand every edge outward from the root
-        typedef std::vector<typename FoldedContourTree::Node> Neighbors;
-        Neighbors root_neighbors;
+private:
 
-        // We have to record the neighbors first, as expanding the neighbor
-        // edges as we find them invalidates the iterator
-        for (denali::UndirectedNeighborIterator<FoldedContourTree> 
-                it(_folded_tree, root); !it.done(); ++it)
-        {
-            root_neighbors.push_back(it.neighbor());
-        }
-        
-        for (typename Neighbors::const_iterator it = root_neighbors.begin();
-                it != root_neighbors.end(); ++it)
+    /// \brief Starts recording folds which the hierarchy doesn't know of.
+    void beginModifyingFolds()
+    {
+        // version 0 of the history is the state the hierarchy left
+        if (!_folds_modified)
         {
-            denali::expandSubtree(_folded_tree, root, *it);
+            _history->clear();
+            _folds_modified = true;
         }
     }
 
@@ -36,6 +36,7 @@
 #include <vtkDataObjectToTable.h>
 #include <vtkDataSetMapper.h>
 #include <vtkElevationFilter.h>
+#include <vtkIdTypeArray.h>
 #include <vtkImageActor.h>
 #include <vtkInteractorStyleTerrain.h>
 #include <vtkInteractorStyleTrackballCamera.h>
@@ -56,7 +57,6 @@
 #include <vtkSmartPointer.h>
 #include <vtkTextActor.h>
 #include <vtkTextProperty.h>
-#include <vtkTriangle.h>
 
 #include <denali/fileio.h>
 #include "landscape_context.h"
@@ -256,18 +256,26 @@ void LandscapeMeshBuilder(void* args)
         points->InsertNextPoint(point.x(), point.y(), normalized_z);
     }
 
-    for (size_t i=0; i<context.numberOfTriangles(); ++i)
+    // copy the triangles straight from the landscape's index buffer into
+    // the cell array, rather than making a cell for each triangle. each
+    // cell is stored as its number of points followed by their ids
+    denali::rectangular::IndexedMesh mesh;
+    context.getIndexedMesh(mesh);
+
+    const std::vector<denali::rectangular::IndexedMesh::Index>& indices =
+            mesh.getTriangles().getIndices();
+    vtkIdType n_triangles = mesh.getTriangles().numberOfPrimitives();
+
+    vtkSmartPointer<vtkIdTypeArray> cells = vtkSmartPointer<vtkIdTypeArray>::New();
+    cells->SetNumberOfValues(4 * n_triangles);
+    for (vtkIdType i=0; i<n_triangles; ++i)
     {
-        // get the triangle from the landscape
-        Triangle tri = context.getTriangle(i);
-
-        // and add it to the cell array
-        vtkSmartPointer<vtkTriangle> vtk_tri = vtkSmartPointer<vtkTriangle>::New();
-        vtk_tri->GetPointIds()->SetId(1, tri.i());
-        vtk_tri->GetPointIds()->SetId(2, tri.j());
-        vtk_tri->GetPointIds()->SetId(0, tri.k());
-        triangles->InsertNextCell(vtk_tri);
+        cells->SetValue(4*i, 3);
+        cells->SetValue(4*i + 1, indices[3*i + 2]);
+        cells->SetValue(4*i + 2, indices[3*i]);
+        cells->SetValue(4*i + 3, indices[3*i + 1]);
     }
+    triangles->SetCells(n_triangles, cells);
 
     // set the output
     input->source->GetPolyDataOutput()->SetPoints(points);
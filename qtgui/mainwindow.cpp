@@ -175,6 +175,7 @@ void MainWindow::setContext(LandscapeContext* context)
 
     // update the persistence slider
     this->enablePersistenceSlider();
+    this->appendSimplificationStatistics();
 
     this->updateCallbackAvailability();
 
@@ -383,6 +384,24 @@ void MainWindow::updatePersistence(int value)
     std::stringstream label;
     label << persistence;
     _mainwindow.labelPersistence->setText(label.str().c_str());
+
+    if (!_landscape_context) return;
+
+    // the leftmost position shows the unsimplified tree
+    double threshold = value == 0 ? -1 : persistence;
+
+    if (_landscape_context->simplifyByPersistence(threshold))
+    {
+        // the chosen root may have been simplified away
+        if (!_choose_root_dialog->isMinimumNodeChecked() &&
+            !_choose_root_dialog->isMaximumNodeChecked() &&
+            !_landscape_context->isNodeValid(_choose_root_dialog->getOtherNode()))
+        {
+            _choose_root_dialog->setMinimumNodeChecked(true);
+        }
+
+        changeLandscapeRoot();
+    }
 }
 
 
@@ -407,10 +426,35 @@ void MainWindow::refineSubtree()
     double persistence = ((double) value)/_max_persistence_slider_value * 
             _landscape_context->getMaxPersistence();
 
-    _landscape_context->simplifySubtreeByPersistence(parent, child, persistence);
+    // the subtree is usually embedded again in place, otherwise we need to
+    // rebuild the landscape
+    if (_landscape_context->simplifySubtreeByPersistence(parent, child, persistence)) {
+        emit landscapeChanged();
+    } else {
+        changeLandscapeRoot();
+    }
+    appendSimplificationStatistics();
+}
+
 
-    // we need to rebuild the landscape
-    changeLandscapeRoot();
+void MainWindow::appendSimplificationStatistics()
+{
+    if (!_landscape_context) return;
+
+    denali::SimplificationStatistics statistics = 
+            _landscape_context->getSimplificationStatistics();
+
+    std::stringstream message;
+    message << "<b>Simplification queue: </b>"
+            << statistics.pushes << " pushes, "
+            << statistics.updates << " updates, "
+            << statistics.pops << " pops, "
+            << statistics.max_queue_size << " peak size<br>";
+    message << "<b>Simplification folds: </b>"
+            << statistics.collapses << " collapses, "
+            << statistics.reductions << " reductions";
+
+    appendStatus(message.str());
 }
 
 
@@ -736,7 +780,7 @@ std::string MainWindow::prepareCallback(
     for (LandscapeContext::Members::const_iterator it = members.begin();
             it != members.end(); ++it)
     {
-        unsigned int id = it->first;
+        denali::Identifier id = it->first;
         double value = it->second;
 
         std::stringstream member_line;
@@ -795,7 +839,7 @@ std::string MainWindow::prepareCallback(
             for (LandscapeContext::Members::const_iterator it = members.begin();
                     it != members.end(); ++it)
             {
-                unsigned int id = it->first;
+                denali::Identifier id = it->first;
                 double value = it->second;
 
                 arc_line << "\t" << id << "\t" << value;
@@ -73,6 +73,7 @@ public slots:
 
     void enablePersistenceSlider();
     void updatePersistence(int);
+    void appendSimplificationStatistics();
 
     void enableRefineSubtree();
     void disableRefineSubtree();
@@ -1,6 +1,7 @@
 #include <UnitTest++.h>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include <denali/mappable_list.h>
 
@@ -14,6 +15,71 @@ TEST(MappableList)
 
 }
 
+class RemapObserver : public denali::MappableList<std::string>::Observer
+{
+public:
+    mutable std::vector<denali::Index> new_indices;
+
+    void notify() const {}
+
+    void remap(const std::vector<denali::Index>& indices) const {
+        new_indices = indices;
+    }
+};
+
+TEST(Compaction)
+{
+    typedef denali::MappableList<std::string> MappableList;
+
+    MappableList ml;
+    RemapObserver observer;
+    ml.attachObserver(observer);
+
+    std::string words[] = {"a", "b", "c", "d", "e", "f"};
+    for (size_t i=0; i<6; ++i) {
+        ml.insert(words[i]);
+    }
+
+    ml.remove(1);
+    ml.remove(4);
+    ml.remove(0);
+    CHECK_EQUAL((size_t) 3, ml.size());
+    CHECK_EQUAL((denali::Index) 6, ml.getMaxIdentifier());
+
+    // index order skips the removed elements
+    std::string in_order;
+    for (denali::MappableListIndexIterator<MappableList> it(ml); 
+            !it.done(); ++it) {
+        in_order += *it;
+    }
+    CHECK_EQUAL("cdf", in_order);
+
+    std::vector<denali::Index> new_indices;
+    ml.compact(new_indices);
+
+    CHECK_EQUAL((size_t) 3, ml.size());
+    CHECK_EQUAL((denali::Index) 3, ml.getMaxIdentifier());
+    CHECK(new_indices == observer.new_indices);
+
+    denali::Index expected[] = {-1, -1, 0, 1, -1, 2};
+    for (size_t i=0; i<6; ++i) {
+        CHECK_EQUAL(expected[i], new_indices[i]);
+    }
+
+    // afterwards, the list order is the index order
+    std::string listed;
+    for (denali::MappableListIterator<MappableList> it(ml); !it.done(); ++it) {
+        listed += *it;
+    }
+    CHECK_EQUAL("cdf", listed);
+
+    // and new elements are appended
+    CHECK_EQUAL((denali::Index) 3, ml.insert("g"));
+    CHECK_EQUAL("g", ml[3]);
+
+    ml.detachObserver(observer);
+}
+
 int main()
 {
     return UnitTest::RunAllTests();
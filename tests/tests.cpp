@@ -1,19 +1,27 @@
 #include <UnitTest++.h>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
 
+#include <map>
+#include <queue>
 #include <string>
 #include <set>
 #include <vector>
 
 #include <denali/concepts/check.h>
 #include <denali/concepts/graph_attributes.h>
+#include <denali/concepts/graph_maps.h>
 #include <denali/concepts/contour_tree.h>
 #include <denali/concepts/landscape.h>
 #include <denali/fileio.h>
 #include <denali/graph_mixins.h>
 #include <denali/graph_maps.h>
 #include <denali/graph_iterators.h>
+#include <denali/graph_algorithms.h>
 #include <denali/graph_structures.h>
+#include <denali/indexed_heap.h>
 #include <denali/contour_tree.h>
 #include <denali/landscape.h>
 #include <denali/rectangular_landscape.h>
@@ -57,6 +65,158 @@ void printContourTree(const ContourTree& tree)
 }
 
 
+// a random tree on n nodes with small integer values, so that there are ties
+denali::ContourTree makeRandomContourTree(size_t n, unsigned long seed)
+{
+    typedef denali::UndirectedScalarMemberIDGraph Graph;
+
+    boost::shared_ptr<Graph> graph(new Graph);
+    std::vector<Graph::Node> nodes;
+
+    for (size_t i=0; i<n; ++i)
+    {
+        seed = (seed * 1103515245 + 12345) % 2147483648UL;
+        nodes.push_back(graph->addNode(i, (double) (seed % n)));
+
+        if (i > 0) {
+            seed = (seed * 1103515245 + 12345) % 2147483648UL;
+            graph->addEdge(nodes[i], nodes[seed % i]);
+        }
+    }
+
+    return denali::ContourTree::fromPrecomputed(graph);
+}
+
+
+// the number of members in a set
+struct MemberCount
+{
+    typedef size_t result_type;
+
+    template <typename Members>
+    result_type operator()(const Members& members) const {
+        return members.size();
+    }
+};
+
+
+// the sorted IDs of the members in a set
+struct SortedMemberIDs
+{
+    typedef std::vector<denali::Identifier> result_type;
+
+    template <typename Members>
+    result_type operator()(const Members& members) const
+    {
+        result_type ids;
+        for (typename Members::const_iterator it = members.begin();
+                it != members.end(); ++it) {
+            ids.push_back((*it).getID());
+        }
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+};
+
+
+// maps each visible edge, by the ids of its nodes, and each visible node, by
+// its id twice, to the summary of the members it holds
+template <typename FoldedTree, typename Summary>
+std::map<std::pair<denali::Identifier, denali::Identifier>,
+         typename Summary::result_type>
+summarizeMembers(const FoldedTree& tree, Summary summary)
+{
+    typedef std::pair<denali::Identifier, denali::Identifier> Key;
+    std::map<Key, typename Summary::result_type> summaries;
+
+    for (denali::NodeIterator<FoldedTree> it(tree); !it.done(); ++it) {
+        denali::Identifier id = tree.getID(it.node());
+        summaries[Key(id, id)] = summary(tree.getNodeMembers(it.node()));
+    }
+
+    for (denali::EdgeIterator<FoldedTree> it(tree); !it.done(); ++it) {
+        denali::Identifier u = tree.getID(tree.u(it.edge()));
+        denali::Identifier v = tree.getID(tree.v(it.edge()));
+        Key key(std::min(u,v), std::max(u,v));
+        summaries[key] = summary(tree.getEdgeMembers(it.edge()));
+    }
+
+    return summaries;
+}
+
+
+// the number of members held by each visible node and edge
+template <typename FoldedTree>
+std::map<std::pair<denali::Identifier, denali::Identifier>, size_t>
+foldFingerprint(const FoldedTree& tree)
+{
+    return summarizeMembers(tree, MemberCount());
+}
+
+
+// the sorted IDs of the members of each visible node and edge
+template <typename FoldedTree>
+std::map<std::pair<denali::Identifier, denali::Identifier>,
+         std::vector<denali::Identifier> >
+memberIDs(const FoldedTree& tree)
+{
+    return summarizeMembers(tree, SortedMemberIDs());
+}
+
+
+// checks the folded tree's degree counts against a scan of the neighbors
+template <typename FoldedTree>
+bool degreeCountsAreExact(const FoldedTree& tree)
+{
+    for (denali::NodeIterator<FoldedTree> it(tree); !it.done(); ++it)
+    {
+        unsigned int up = 0, down = 0;
+        for (denali::UndirectedNeighborIterator<FoldedTree> 
+                neighbor_it(tree, it.node()); !neighbor_it.done(); ++neighbor_it)
+        {
+            if (denali::PersistenceSimplifier::nodeLess(
+                    tree, it.node(), neighbor_it.neighbor())) {
+                up++;
+            } else {
+                down++;
+            }
+        }
+
+        if (up != tree.upDegree(it.node()) ||
+            down != tree.downDegree(it.node())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// sets the hierarchy to each threshold in turn, and checks that it folds the
+// tree as simplifying a fresh copy of the contour tree does
+template <typename Hierarchy, typename FoldedTree, size_t N>
+bool hierarchyMatchesSimplification(
+        Hierarchy& hierarchy,
+        const FoldedTree& tree,
+        const denali::ContourTree& contour_tree,
+        const double (&thresholds)[N])
+{
+    for (size_t i=0; i<N; ++i)
+    {
+        hierarchy.setThreshold(thresholds[i]);
+
+        FoldedTree expected(contour_tree);
+        denali::PersistenceSimplifier simplifier(thresholds[i]);
+        simplifier.simplify(expected);
+
+        if (memberIDs(tree) != memberIDs(expected) ||
+                !degreeCountsAreExact(tree)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
 TEST(Mixins)
 {
     denali::concepts::checkConcept
@@ -374,6 +534,188 @@ SUITE(GraphStructures)
         */
 
     }
+
+
+    TEST(CompactMaps)
+    {
+        typedef denali::UndirectedGraph Graph;
+
+        Graph graph;
+        std::vector<Graph::Node> nodes;
+
+        // more nodes than there are bits in a word
+        for (int i=0; i<100; ++i) {
+            nodes.push_back(graph.addNode());
+        }
+
+        denali::concepts::checkConcept<
+        denali::concepts::StaticNodeMap<Graph, bool>,
+               denali::StaticNodeBitMap<Graph>
+               > ();
+
+        denali::concepts::checkConcept<
+        denali::concepts::StaticNodeMap<Graph, int>,
+               denali::SparseNodeMap<Graph, int>
+               > ();
+
+        denali::StaticNodeBitMap<Graph> bits(graph, true);
+        bits[nodes[3]] = false;
+        bits[nodes[70]] = false;
+        bits[nodes[71]] = bits[nodes[70]];
+
+        const denali::StaticNodeBitMap<Graph>& const_bits = bits;
+        for (int i=0; i<100; ++i) {
+            CHECK_EQUAL(i != 3 && i != 70 && i != 71, const_bits[nodes[i]]);
+        }
+
+        bits.fill(false);
+        CHECK(!bits[nodes[99]]);
+
+        denali::StaticNodeByteMap<Graph, unsigned int> bytes(graph, 7);
+        bytes[nodes[50]] = 200;
+        CHECK_EQUAL(200u, (unsigned int) bytes[nodes[50]]);
+        CHECK_EQUAL(7u, (unsigned int) bytes[nodes[51]]);
+
+        denali::SparseNodeMap<Graph, int> sparse(graph, -1);
+        const denali::SparseNodeMap<Graph, int>& const_sparse = sparse;
+        CHECK_EQUAL(-1, const_sparse[nodes[10]]);
+        CHECK_EQUAL((size_t) 0, sparse.size());
+
+        sparse[nodes[10]] = 5;
+        sparse[nodes[20]] += 1;
+        CHECK_EQUAL(5, const_sparse[nodes[10]]);
+        CHECK_EQUAL(0, const_sparse[nodes[20]]);
+        CHECK(sparse.contains(nodes[20]));
+        CHECK(!sparse.contains(nodes[30]));
+        CHECK_EQUAL((size_t) 2, sparse.size());
+
+        // nodes added after the map was built read as the default
+        Graph::Node late = graph.addNode();
+        CHECK_EQUAL(-1, const_sparse[late]);
+    }
+
+
+    TEST(ConnectedComponents)
+    {
+        typedef denali::UndirectedGraph Graph;
+
+        Graph graph;
+        std::vector<Graph::Node> nodes;
+
+        for (int i=0; i<8; ++i) {
+            nodes.push_back(graph.addNode());
+        }
+
+        // components: {0,1,2,3}, {4,5}, {6}, and {7} once it is removed
+        graph.addEdge(nodes[2], nodes[3]);
+        graph.addEdge(nodes[0], nodes[1]);
+        graph.addEdge(nodes[3], nodes[1]);
+        graph.addEdge(nodes[5], nodes[4]);
+        graph.addEdge(nodes[6], nodes[7]);
+        graph.removeNode(nodes[7]);
+
+        denali::ConnectedComponents<Graph> components(graph);
+
+        CHECK_EQUAL((size_t) 3, components.numberOfComponents());
+        CHECK(!components.isConnected());
+
+        CHECK_EQUAL(0u, components.getComponent(nodes[2]));
+        CHECK_EQUAL(1u, components.getComponent(nodes[5]));
+        CHECK_EQUAL(2u, components.getComponent(nodes[6]));
+
+        CHECK_EQUAL((size_t) 4, components.getComponentSize(0));
+        CHECK_EQUAL((size_t) 2, components.getComponentSize(1));
+        CHECK_EQUAL((size_t) 1, components.getComponentSize(2));
+    }
+
+
+    TEST(ParallelBFS)
+    {
+        typedef denali::UndirectedGraph Graph;
+
+        Graph graph;
+        std::vector<Graph::Node> nodes;
+
+        for (int i=0; i<7; ++i) {
+            nodes.push_back(graph.addNode());
+        }
+
+        // a square 0-1-2-3 with a tail 2-4-5, and 6 isolated
+        graph.addEdge(nodes[0], nodes[1]);
+        graph.addEdge(nodes[1], nodes[2]);
+        graph.addEdge(nodes[2], nodes[3]);
+        graph.addEdge(nodes[3], nodes[0]);
+        graph.addEdge(nodes[2], nodes[4]);
+        graph.addEdge(nodes[4], nodes[5]);
+
+        denali::ParallelBFS<Graph> bfs(graph, nodes[0]);
+
+        CHECK_EQUAL((size_t) 6, bfs.numberOfReachedNodes());
+        CHECK_EQUAL((size_t) 5, bfs.numberOfLevels());
+        CHECK_EQUAL(0, bfs.getDepth(nodes[0]));
+        CHECK_EQUAL(1, bfs.getDepth(nodes[3]));
+        CHECK_EQUAL(2, bfs.getDepth(nodes[2]));
+        CHECK_EQUAL(4, bfs.getDepth(nodes[5]));
+        CHECK(bfs.getParent(nodes[5]) == nodes[4]);
+        CHECK(!bfs.isReached(nodes[6]));
+    }
+
+
+    TEST(EulerTourTree)
+    {
+        typedef denali::UndirectedGraph Graph;
+
+        Graph graph;
+        std::vector<Graph::Node> nodes;
+
+        for (int i=0; i<9; ++i) {
+            nodes.push_back(graph.addNode());
+        }
+
+        /*
+        //          0
+        //        / | \
+        //       1  2  3
+        //      / \    \
+        //     4   5    6
+        //              |
+        //              7       8
+        */
+        graph.addEdge(nodes[0], nodes[1]);
+        graph.addEdge(nodes[2], nodes[0]);
+        graph.addEdge(nodes[0], nodes[3]);
+        graph.addEdge(nodes[4], nodes[1]);
+        graph.addEdge(nodes[1], nodes[5]);
+        graph.addEdge(nodes[3], nodes[6]);
+        graph.addEdge(nodes[7], nodes[6]);
+
+        denali::EulerTourTree<Graph> tree(graph, nodes[0]);
+
+        size_t sizes[] = {8, 3, 1, 3, 1, 1, 2, 1};
+        int parents[] = {0, 0, 0, 0, 1, 1, 3, 6};
+
+        for (int i=0; i<8; ++i) {
+            CHECK(tree.isReached(nodes[i]));
+            CHECK_EQUAL(sizes[i], tree.getSubtreeSize(nodes[i]));
+            CHECK(tree.getParent(nodes[i]) == nodes[parents[i]]);
+        }
+
+        CHECK(!tree.isReached(nodes[8]));
+
+        // every subtree occupies a contiguous range of the preorder
+        CHECK_EQUAL((size_t) 0, tree.getPreorderIndex(nodes[0]));
+        std::set<size_t> positions;
+        for (int i=0; i<8; ++i) {
+            size_t position = tree.getPreorderIndex(nodes[i]);
+            positions.insert(position);
+
+            size_t parent_position = tree.getPreorderIndex(nodes[parents[i]]);
+            CHECK(parent_position <= position);
+            CHECK(position < parent_position +
+                    tree.getSubtreeSize(nodes[parents[i]]));
+        }
+        CHECK_EQUAL((size_t) 8, positions.size());
+    }
 }
 
 
@@ -479,6 +821,55 @@ SUITE(ContourTree)
 
     }
 
+    TEST(ContourTreeInArena)
+    {
+        denali::ScalarSimplicialComplex plex;
+
+        for (size_t i=0; i<n_wenger_vertices; ++i) {
+            plex.addNode(wenger_vertex_values[i]);
+        }
+
+        for (size_t i=0; i<n_wenger_edges; ++i) {
+            plex.addEdge(
+                plex.getNode(wenger_edges[i][0]),
+                plex.getNode(wenger_edges[i][1]));
+        }
+
+        denali::CarrsAlgorithm alg;
+        denali::ContourTree tree =
+            denali::ContourTree::compute(plex, alg);
+
+        boost::shared_ptr<denali::MonotonicArena> arena(
+                new denali::MonotonicArena(1024));
+
+        denali::ContourTree arena_tree =
+            denali::ContourTree::compute(plex, alg, arena);
+
+        CHECK(arena->bytesAllocated() > 0);
+        CHECK_EQUAL(tree.numberOfNodes(), arena_tree.numberOfNodes());
+        CHECK_EQUAL(tree.numberNodesPlusMembers(),
+                    arena_tree.numberNodesPlusMembers());
+
+        typedef denali::ContourTree::Members Members;
+        for (denali::EdgeIterator<denali::ContourTree> it(tree); !it.done(); ++it) {
+            unsigned int u = tree.getID(tree.u(it.edge()));
+            unsigned int v = tree.getID(tree.v(it.edge()));
+
+            denali::ContourTree::Edge edge = arena_tree.findEdge(
+                    arena_tree.getNode(u), arena_tree.getNode(v));
+            CHECK(arena_tree.isEdgeValid(edge));
+
+            const Members& members = tree.getEdgeMembers(it.edge());
+            const Members& arena_members = arena_tree.getEdgeMembers(edge);
+            CHECK(members == arena_members);
+            CHECK(arena_members.get_allocator().getArena() == arena.get());
+        }
+
+        // the tree keeps the arena alive after the last outside reference
+        arena.reset();
+        CHECK(arena_tree.isNodeValid(arena_tree.getNode(4)));
+    }
+
 }
 
 
@@ -537,6 +928,355 @@ SUITE(RectangularLandscape)
 
     }
 
+
+    TEST(EmbedInParallel)
+    {
+        typedef denali::LandscapeTree<denali::ContourTree> LandscapeTree;
+        typedef denali::LandscapeWeights<LandscapeTree> LandscapeWeights;
+        typedef denali::rectangular::Embedding<LandscapeTree> Embedding;
+        typedef denali::rectangular::Triangularization<LandscapeTree> Triangularization;
+
+        denali::ContourTree tree = makeRandomContourTree(2000, 5);
+        LandscapeTree lscape(tree, tree.getFirstNode());
+        LandscapeWeights weights(lscape);
+
+        Embedding serial(lscape);
+        denali::rectangular::Embedder<LandscapeTree>(lscape, weights, serial).embed();
+        Triangularization serial_triangles;
+        denali::rectangular::Triangularizer<LandscapeTree>(
+                lscape, serial, serial_triangles).triangularize();
+
+        denali::rectangular::EmbeddingLayout<LandscapeTree> layout(lscape);
+        Embedding parallel(lscape);
+        denali::rectangular::Embedder<LandscapeTree>(
+                lscape, weights, parallel).embedInParallel(layout);
+        Triangularization parallel_triangles;
+        denali::rectangular::Triangularizer<LandscapeTree>(
+                lscape, parallel, parallel_triangles).triangularizeInParallel(layout);
+
+        // the layout predicts the sizes exactly, and the results do not
+        // depend on the schedule
+        CHECK_EQUAL(serial.numberOfPoints(), layout.numberOfPoints());
+        CHECK_EQUAL(serial_triangles.numberOfTriangles(), layout.numberOfTriangles());
+        CHECK_EQUAL(serial.numberOfPoints(), parallel.numberOfPoints());
+        CHECK_EQUAL(serial_triangles.numberOfTriangles(),
+                    parallel_triangles.numberOfTriangles());
+
+        bool same_points = true;
+        for (size_t i=0; i<serial.numberOfPoints(); ++i)
+        {
+            Embedding::Point p = serial.getPoint(i), q = parallel.getPoint(i);
+            same_points = same_points && p.x() == q.x() && p.y() == q.y() &&
+                          p.z() == q.z() && p.id() == q.id();
+        }
+        CHECK(same_points);
+
+        // each node's points are contiguous, as are its corners and
+        // containers
+        bool same_nodes = true;
+        for (denali::NodeIterator<LandscapeTree> it(lscape); !it.done(); ++it)
+        {
+            LandscapeTree::Node node = it.node();
+            bool is_leaf = lscape.outDegree(node) == 0 && node != lscape.getRoot();
+            same_nodes = same_nodes &&
+                serial.numberOfContourPoints(node) ==
+                    (is_leaf ? 1 : 2*lscape.outDegree(node) + 2) &&
+                serial.numberOfCornerPoints(node) == (is_leaf ? 0 : 4) &&
+                serial.numberOfContainerPoints(node) ==
+                    (node == lscape.getRoot() ? 0 : 4) &&
+                serial.getContourPoint(node, 0).id() ==
+                    layout.getPointOffset(node) &&
+                parallel.numberOfContourPoints(node) ==
+                    serial.numberOfContourPoints(node);
+
+            for (size_t i=0; i<serial.numberOfCornerPoints(node); ++i) {
+                same_nodes = same_nodes && serial.getCornerPoint(node, i).id() ==
+                             parallel.getCornerPoint(node, i).id();
+            }
+
+            for (size_t i=0; i<serial.numberOfContainerPoints(node); ++i) {
+                same_nodes = same_nodes && serial.getContainerPoint(node, i).id() ==
+                             parallel.getContainerPoint(node, i).id();
+            }
+        }
+        CHECK(same_nodes);
+        CHECK_EQUAL(serial.getMinPoint().id(), parallel.getMinPoint().id());
+        CHECK_EQUAL(serial.getMaxPoint().id(), parallel.getMaxPoint().id());
+
+        bool same_triangles = true;
+        for (size_t i=0; i<serial_triangles.numberOfTriangles(); ++i)
+        {
+            Triangularization::Triangle s = serial_triangles.getTriangle(i);
+            Triangularization::Triangle t = parallel_triangles.getTriangle(i);
+            same_triangles = same_triangles && s.i() == t.i() && s.j() == t.j() &&
+                             s.k() == t.k() && s.id() == t.id() &&
+                             serial_triangles.getArc(s) == parallel_triangles.getArc(t);
+        }
+        CHECK(same_triangles);
+    }
+
+
+    TEST(LevelOfDetail)
+    {
+        typedef denali::RectangularLandscape<denali::ContourTree> RectangularLandscape;
+        typedef RectangularLandscape::Arc Arc;
+
+        denali::ContourTree tree = makeRandomContourTree(2000, 17);
+        RectangularLandscape full(tree, tree.getFirstNode());
+        RectangularLandscape coarse(tree, tree.getFirstNode(),
+                                    denali::rectangular::LevelOfDetail(1e-2));
+
+        CHECK(coarse.numberOfTriangles() < full.numberOfTriangles());
+        CHECK(coarse.numberOfPoints() < full.numberOfPoints());
+
+        // every triangle belongs to a drawn arc, and each aggregated arc is
+        // drawn as a leaf
+        std::map<Arc, size_t> triangles_of;
+        bool drawn = true;
+        for (size_t i=0; i<coarse.numberOfTriangles(); ++i)
+        {
+            Arc arc = coarse.getComponentFromTriangle(coarse.getTriangle(i));
+            drawn = drawn && coarse.isDrawn(arc);
+            triangles_of[arc]++;
+        }
+        CHECK(drawn);
+
+        size_t n_aggregated = 0, n_drawn = 0;
+        bool aggregated_as_leaves = true;
+        for (denali::ArcIterator<RectangularLandscape> it(coarse); !it.done(); ++it)
+        {
+            if (coarse.isDrawn(it.arc())) n_drawn++;
+            if (!coarse.isAggregated(it.arc())) continue;
+
+            n_aggregated++;
+            aggregated_as_leaves = aggregated_as_leaves &&
+                    triangles_of[it.arc()] == 4 && coarse.outDegree(
+                            coarse.target(it.arc())) > 0;
+        }
+        CHECK(n_aggregated > 0);
+        CHECK(aggregated_as_leaves);
+        CHECK_EQUAL(n_drawn, triangles_of.size());
+
+        // pruning by weight alone
+        RectangularLandscape light(tree, tree.getFirstNode(),
+                                   denali::rectangular::LevelOfDetail(0, 50));
+        CHECK(light.numberOfTriangles() < full.numberOfTriangles());
+    }
+
+
+    TEST(IndexedMesh)
+    {
+        typedef denali::RectangularLandscape<denali::ContourTree> RectangularLandscape;
+        typedef RectangularLandscape::IndexedMesh IndexedMesh;
+        typedef IndexedMesh::Index Index;
+        typedef std::pair<Index, std::vector<Index> > ArcTriangle;
+
+        denali::ContourTree tree = makeRandomContourTree(2000, 23);
+
+        for (int detail=0; detail<2; ++detail)
+        {
+            RectangularLandscape lscape(tree, tree.getFirstNode(),
+                    denali::rectangular::LevelOfDetail(detail ? 1e-2 : 0));
+
+            // the triangles are copied as they are
+            IndexedMesh mesh;
+            lscape.getIndexedMesh(mesh);
+            const denali::rectangular::IndexBuffer& triangles = mesh.getTriangles();
+            CHECK_EQUAL(lscape.numberOfTriangles(), triangles.numberOfPrimitives());
+
+            std::multiset<ArcTriangle> expected;
+            bool same_triangles = true;
+            for (size_t i=0; i<lscape.numberOfTriangles(); ++i)
+            {
+                RectangularLandscape::Triangle tri = lscape.getTriangle(i);
+                Index arc = lscape.getArcIdentifier(
+                        lscape.getComponentFromTriangle(tri));
+                const Index* indices = &triangles.getIndices()[3*i];
+
+                same_triangles = same_triangles && indices[0] == tri.i() &&
+                        indices[1] == tri.j() && indices[2] == tri.k() &&
+                        triangles.getArcIdentifiers()[i] == arc;
+
+                std::vector<Index> vertices(indices, indices + 3);
+                std::sort(vertices.begin(), vertices.end());
+                expected.insert(ArcTriangle(arc, vertices));
+            }
+            CHECK(same_triangles);
+
+            // the strips and fans draw the same triangles, wound alike
+            lscape.getIndexedMesh(mesh, IndexedMesh::STRIPS_AND_FANS);
+            CHECK_EQUAL(IndexedMesh::STRIPS_AND_FANS, mesh.getPrimitives());
+            CHECK_EQUAL(0u, mesh.getTriangles().numberOfPrimitives());
+
+            std::multiset<ArcTriangle> drawn;
+            size_t n_indices = 0, n_clockwise = 0, n_counterclockwise = 0;
+            for (int kind=0; kind<2; ++kind)
+            {
+                const denali::rectangular::IndexBuffer& buffer =
+                        kind ? mesh.getFans() : mesh.getStrips();
+                size_t length = buffer.getPrimitiveLength();
+                n_indices += buffer.getIndices().size();
+
+                for (size_t i=0; i<buffer.numberOfPrimitives(); ++i)
+                {
+                    const Index* indices = &buffer.getIndices()[length*i];
+                    for (size_t j=0; j+2<length; ++j)
+                    {
+                        // strips alternate their winding, fans pivot on the
+                        // first index
+                        Index a = kind ? indices[0] : indices[j];
+                        Index b = indices[j+1];
+                        Index c = indices[j+2];
+                        if (!kind && j % 2 == 1) std::swap(a, b);
+
+                        RectangularLandscape::Point p = lscape.getPoint(a);
+                        RectangularLandscape::Point q = lscape.getPoint(b);
+                        RectangularLandscape::Point r = lscape.getPoint(c);
+                        double area = (q.x() - p.x()) * (r.y() - p.y()) -
+                                      (q.y() - p.y()) * (r.x() - p.x());
+                        if (area > 1e-12) n_counterclockwise++;
+                        if (area < -1e-12) n_clockwise++;
+
+                        std::vector<Index> vertices;
+                        vertices.push_back(a);
+                        vertices.push_back(b);
+                        vertices.push_back(c);
+                        std::sort(vertices.begin(), vertices.end());
+                        drawn.insert(ArcTriangle(buffer.getArcIdentifiers()[i],
+                                                 vertices));
+                    }
+                }
+            }
+
+            CHECK(drawn == expected);
+            CHECK(n_clockwise + n_counterclockwise > 0);
+            CHECK(n_clockwise == 0 || n_counterclockwise == 0);
+            CHECK(2 * n_indices < 3 * lscape.numberOfTriangles());
+        }
+    }
+
+
+    // the bounding rectangle of four points of the embedding
+    template <typename Embedding, typename Node>
+    denali::rectangular::Rectangle boundingRectangle(
+            const Embedding& embedding, Node node, bool corners)
+    {
+        double x[4], y[4];
+        for (int i=0; i<4; ++i)
+        {
+            typename Embedding::Point p = corners ?
+                    embedding.getCornerPoint(node, i) :
+                    embedding.getContainerPoint(node, i);
+            x[i] = p.x();
+            y[i] = p.y();
+        }
+
+        double min_x = *std::min_element(x, x + 4), max_x = *std::max_element(x, x + 4);
+        double min_y = *std::min_element(y, y + 4), max_y = *std::max_element(y, y + 4);
+        return denali::rectangular::Rectangle((min_x + max_x)/2, (min_y + max_y)/2,
+                                              max_x - min_x, max_y - min_y);
+    }
+
+
+    TEST(SquarifiedLandscape)
+    {
+        typedef denali::LandscapeTree<denali::ContourTree> LandscapeTree;
+        typedef denali::LandscapeWeights<LandscapeTree> LandscapeWeights;
+        typedef denali::rectangular::Embedding<LandscapeTree> Embedding;
+        typedef denali::rectangular::Rectangle Rectangle;
+        typedef denali::rectangular::Embedder<LandscapeTree> Embedder;
+
+        denali::ContourTree tree = makeRandomContourTree(2000, 31);
+        LandscapeTree lscape(tree, tree.getFirstNode());
+        LandscapeWeights weights(lscape);
+
+        Embedding sliced(lscape);
+        Embedder(lscape, weights, sliced).embed();
+
+        Embedding squarified(lscape);
+        Embedder(lscape, weights, squarified, denali::rectangular::SQUARIFIED).embed();
+
+        // the splits own as many points as slices do
+        CHECK_EQUAL(sliced.numberOfPoints(), squarified.numberOfPoints());
+
+        // each node's children tile its rectangle without overlapping, and
+        // are nearer to square than slices are
+        bool tiled = true;
+        double sliced_ratio = 0, squarified_ratio = 0;
+        size_t n_children = 0;
+        for (denali::NodeIterator<LandscapeTree> it(lscape); !it.done(); ++it)
+        {
+            if (lscape.outDegree(it.node()) == 0) continue;
+
+            Rectangle outer = boundingRectangle(squarified, it.node(), true);
+            std::vector<Rectangle> inner;
+            double area = 0;
+            for (denali::ChildIterator<LandscapeTree> child_it(lscape, it.node());
+                    !child_it.done(); ++child_it)
+            {
+                Rectangle s = boundingRectangle(sliced, child_it.child(), false);
+                Rectangle q = boundingRectangle(squarified, child_it.child(), false);
+
+                // the children are given the same areas either way
+                tiled = tiled && std::fabs(s.area() - q.area()) < 1e-12 &&
+                        q.sw().x() >= outer.sw().x() - 1e-12 &&
+                        q.sw().y() >= outer.sw().y() - 1e-12 &&
+                        q.ne().x() <= outer.ne().x() + 1e-12 &&
+                        q.ne().y() <= outer.ne().y() + 1e-12;
+
+                for (size_t i=0; i<inner.size(); ++i)
+                {
+                    double overlap_x = std::min(q.ne().x(), inner[i].ne().x()) -
+                                       std::max(q.sw().x(), inner[i].sw().x());
+                    double overlap_y = std::min(q.ne().y(), inner[i].ne().y()) -
+                                       std::max(q.sw().y(), inner[i].sw().y());
+                    tiled = tiled && (overlap_x < 1e-12 || overlap_y < 1e-12);
+                }
+
+                inner.push_back(q);
+                area += q.area();
+
+                sliced_ratio += std::max(s.width() / s.height(), s.height() / s.width());
+                squarified_ratio += std::max(q.width() / q.height(), q.height() / q.width());
+                n_children++;
+            }
+
+            tiled = tiled && std::fabs(area - outer.area()) < 1e-12;
+        }
+        CHECK(tiled);
+        CHECK(n_children > 0);
+        CHECK(squarified_ratio < sliced_ratio);
+
+        // embedding in parallel places the same points
+        denali::rectangular::EmbeddingLayout<LandscapeTree> layout(lscape);
+        Embedding parallel(lscape);
+        Embedder(lscape, weights, parallel, denali::rectangular::SQUARIFIED)
+                .embedInParallel(layout);
+
+        bool same_points = parallel.numberOfPoints() == squarified.numberOfPoints();
+        for (size_t i=0; same_points && i<parallel.numberOfPoints(); ++i)
+        {
+            Embedding::Point p = parallel.getPoint(i), q = squarified.getPoint(i);
+            same_points = p.x() == q.x() && p.y() == q.y() && p.z() == q.z();
+        }
+        CHECK(same_points);
+
+        // the builder makes squarified landscapes
+        typedef denali::RectangularLandscape<denali::ContourTree> RectangularLandscape;
+        boost::shared_ptr<RectangularLandscape> built(
+                denali::SquarifiedLandscapeBuilder<denali::ContourTree>::build(
+                        tree, tree.getFirstNode()));
+
+        bool built_squarified = built->numberOfPoints() == squarified.numberOfPoints();
+        for (size_t i=0; built_squarified && i<built->numberOfPoints(); ++i)
+        {
+            RectangularLandscape::Point p = built->getPoint(i);
+            Embedding::Point q = squarified.getPoint(i);
+            built_squarified = p.x() == q.x() && p.y() == q.y();
+        }
+        CHECK(built_squarified);
+    }
+
 }
 
 
@@ -550,6 +1290,29 @@ SUITE(fileio)
         CHECK_EQUAL((size_t) 9, ct.numberOfNodes());
         CHECK_EQUAL((size_t) 8, ct.numberOfEdges());
     }
+
+    TEST(parseIdentifier)
+    {
+        denali::Identifier id = 7;
+
+        CHECK(denali::parseIdentifier("0", id));
+        CHECK_EQUAL((denali::Identifier) 0, id);
+
+        CHECK(denali::parseIdentifier("3000000000", id));
+        CHECK_EQUAL((denali::Identifier) 3000000000u, id);
+
+        // the largest identifier is accepted, anything larger is not
+        std::stringstream max;
+        max << std::numeric_limits<denali::Identifier>::max();
+        CHECK(denali::parseIdentifier(max.str().c_str(), id));
+        CHECK_EQUAL(std::numeric_limits<denali::Identifier>::max(), id);
+        CHECK(!denali::parseIdentifier((max.str() + "0").c_str(), id));
+
+        CHECK(!denali::parseIdentifier("", id));
+        CHECK(!denali::parseIdentifier("-1", id));
+        CHECK(!denali::parseIdentifier("12a", id));
+        CHECK(!denali::parseIdentifier("1.5", id));
+    }
 }
 
 
@@ -633,6 +1396,307 @@ SUITE(Simplify)
     }
 
 
+    TEST(IndexedDaryHeap)
+    {
+        denali::IndexedDaryHeap<double> heap(10);
+
+        CHECK(heap.push(3, 5.));
+        CHECK(heap.push(7, 2.));
+        CHECK(heap.push(1, 8.));
+        CHECK(heap.push(4, 2.));
+        CHECK_EQUAL((size_t) 4, heap.size());
+
+        // ties are broken by key
+        CHECK_EQUAL((denali::Identifier) 4, heap.top());
+
+        // pushing a queued key updates it, in either direction
+        CHECK(!heap.push(1, 1.));
+        CHECK(!heap.push(4, 9.));
+        CHECK_EQUAL((size_t) 4, heap.size());
+        CHECK_EQUAL((denali::Identifier) 1, heap.top());
+        CHECK_EQUAL(9., heap.getPriority(4));
+
+        heap.erase(7);
+        CHECK(!heap.contains(7));
+
+        denali::Identifier expected[] = {1, 3, 4};
+        for (size_t i=0; i<3; ++i) {
+            CHECK_EQUAL(expected[i], heap.top());
+            heap.pop();
+        }
+        CHECK(heap.empty());
+        heap.setCapacity(50);
+
+        // compare against a sorted set under random pushes and erases
+        std::set<std::pair<double, denali::Identifier> > reference;
+        std::vector<double> priorities(50, -1);
+        unsigned long seed = 3;
+
+        for (size_t i=0; i<2000; ++i)
+        {
+            seed = (seed * 1103515245 + 12345) % 2147483648UL;
+            denali::Identifier key = seed % 50;
+            double priority = (double) ((seed / 50) % 20);
+
+            if (priorities[key] >= 0) {
+                reference.erase(std::make_pair(priorities[key], key));
+            }
+
+            if (seed % 7 == 0) {
+                heap.erase(key);
+                priorities[key] = -1;
+            } else {
+                heap.push(key, priority);
+                priorities[key] = priority;
+                reference.insert(std::make_pair(priority, key));
+            }
+
+            CHECK_EQUAL(reference.size(), heap.size());
+            if (!heap.empty()) {
+                CHECK_EQUAL(reference.begin()->second, heap.top());
+            }
+        }
+    }
+
+
+    TEST(SimplifierQueueHoldsEachLeafOnce)
+    {
+        typedef denali::FoldedContourTree<denali::ContourTree> FoldedContourTree;
+
+        denali::ContourTree contour_tree = makeRandomContourTree(300, 11);
+        FoldedContourTree folded_tree(contour_tree);
+
+        size_t n_leaves = 0;
+        for (denali::NodeIterator<FoldedContourTree> it(folded_tree);
+                !it.done(); ++it)
+        {
+            if (folded_tree.degree(it.node()) == 1) n_leaves++;
+        }
+
+        denali::PersistenceSimplifier simplifier(
+                std::numeric_limits<double>::infinity());
+        simplifier.simplify(folded_tree);
+
+        const denali::SimplificationStatistics& statistics =
+                simplifier.getStatistics();
+
+        CHECK(statistics.max_queue_size <= n_leaves);
+        CHECK(statistics.pops <= statistics.pushes);
+        CHECK(statistics.collapses <= statistics.pops);
+        CHECK_EQUAL((size_t) 2, folded_tree.numberOfNodes());
+    }
+
+
+    // checks that the measure's maintained sums match a fresh computation,
+    // and that every leaf left with a small measure had to be preserved
+    template <typename FoldedTree, typename Measure>
+    bool measureIsConsistent(const FoldedTree& tree, Measure& measure,
+                             const denali::WeightMap* weight_map,
+                             double threshold)
+    {
+        denali::MemberSums fresh(weight_map);
+        fresh.initialize(tree);
+
+        for (denali::NodeIterator<FoldedTree> it(tree); !it.done(); ++it)
+        {
+            const denali::MemberSums::Sums& expected = fresh.getNodeSums(tree, it.node());
+            const denali::MemberSums::Sums& actual = measure.getNodeSums(tree, it.node());
+
+            if (std::abs(expected.weight - actual.weight) > 1e-9 ||
+                std::abs(expected.weighted_value - actual.weighted_value) > 1e-6) {
+                return false;
+            }
+        }
+
+        for (denali::EdgeIterator<FoldedTree> it(tree); !it.done(); ++it)
+        {
+            if (tree.degree(tree.u(it.edge())) != 1 && 
+                tree.degree(tree.v(it.edge())) != 1) continue;
+
+            if (tree.numberOfNodes() == 2) continue;
+
+            if (measure(tree, it.edge()) <= threshold &&
+                !denali::PersistenceSimplifier::preserveForReduction(tree, it.edge())) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+
+    TEST(SimplificationMeasures)
+    {
+        typedef denali::FoldedContourTree<denali::ContourTree> FoldedContourTree;
+
+        denali::ContourTree contour_tree = makeRandomContourTree(300, 9);
+
+        denali::WeightMap weight_map;
+        for (denali::Identifier id=0; id<300; id += 2) {
+            weight_map[id] = 2.5;
+        }
+
+        double thresholds[] = {5, 20, 80};
+        for (size_t i=0; i<sizeof(thresholds)/sizeof(double); ++i)
+        {
+            denali::PersistenceSimplifier simplifier(thresholds[i]);
+
+            FoldedContourTree counted(contour_tree);
+            denali::VolumeMeasure count;
+            simplifier.simplifyByMeasure(counted, count);
+            CHECK(measureIsConsistent(counted, count, 0, thresholds[i]));
+            CHECK(counted.numberOfNodes() < contour_tree.numberOfNodes());
+
+            // without a weight map, the volume is the number of members
+            for (denali::NodeIterator<FoldedContourTree> it(counted); !it.done(); ++it) {
+                CHECK_EQUAL((double) counted.getNodeMembers(it.node()).size(),
+                            count.getNodeSums(counted, it.node()).weight);
+            }
+
+            FoldedContourTree weighted(contour_tree);
+            denali::VolumeMeasure weight(&weight_map);
+            simplifier.simplifyByMeasure(weighted, weight);
+            CHECK(measureIsConsistent(weighted, weight, &weight_map, thresholds[i]));
+
+            FoldedContourTree hyper(contour_tree);
+            denali::HypervolumeMeasure hypervolume(&weight_map);
+            simplifier.simplifyByMeasure(hyper, hypervolume);
+            CHECK(measureIsConsistent(hyper, hypervolume, &weight_map, thresholds[i]));
+
+            // the persistence measure is what simplify() uses
+            FoldedContourTree by_measure(contour_tree);
+            FoldedContourTree by_persistence(contour_tree);
+            denali::PersistenceMeasure persistence;
+            simplifier.simplifyByMeasure(by_measure, persistence);
+            simplifier.simplify(by_persistence);
+            CHECK(foldFingerprint(by_measure) == foldFingerprint(by_persistence));
+        }
+    }
+
+
+    TEST(SimplifyInParallel)
+    {
+        typedef denali::FoldedContourTree<denali::ContourTree> FoldedContourTree;
+
+        double thresholds[] = {0, 10, 50, 150, 400};
+
+        for (unsigned long seed=1; seed<=8; ++seed)
+        {
+            denali::ContourTree contour_tree = makeRandomContourTree(400, seed);
+
+            for (size_t i=0; i<sizeof(thresholds)/sizeof(double); ++i)
+            {
+                FoldedContourTree serial_tree(contour_tree);
+                FoldedContourTree parallel_tree(contour_tree);
+
+                denali::PersistenceSimplifier simplifier(thresholds[i]);
+                simplifier.simplify(serial_tree);
+                simplifier.simplifyInParallel(parallel_tree);
+
+                CHECK(foldFingerprint(serial_tree) == foldFingerprint(parallel_tree));
+            }
+        }
+    }
+
+
+    struct ThresholdVisitor
+    {
+        typedef denali::FoldedContourTree<denali::ContourTree> FoldedContourTree;
+        typedef std::map<std::pair<denali::Identifier, denali::Identifier>, size_t>
+                Fingerprint;
+
+        const denali::ContourTree& contour_tree;
+        std::vector<size_t> visited;
+        bool matches;
+
+        ThresholdVisitor(const denali::ContourTree& contour_tree) 
+            : contour_tree(contour_tree), matches(true) {}
+
+        void operator()(const FoldedContourTree& tree, size_t i, double threshold)
+        {
+            visited.push_back(i);
+
+            FoldedContourTree expected(contour_tree);
+            if (threshold >= 0)
+            {
+                denali::PersistenceSimplifier simplifier(threshold);
+                simplifier.simplify(expected);
+            }
+
+            matches = matches && foldFingerprint(tree) == foldFingerprint(expected);
+        }
+    };
+
+
+    TEST(SimplifyAtEachThreshold)
+    {
+        typedef denali::FoldedContourTree<denali::ContourTree> FoldedContourTree;
+
+        denali::ContourTree contour_tree = makeRandomContourTree(250, 31);
+        FoldedContourTree folded_tree(contour_tree);
+        FoldedContourTree unfolded_tree(contour_tree);
+
+        double values[] = {60, 0, 20, 60, -1, 500};
+        std::vector<double> thresholds(values, values + 6);
+
+        ThresholdVisitor visitor(contour_tree);
+        denali::simplifyAtEachThreshold(folded_tree, thresholds, visitor);
+
+        CHECK(visitor.matches);
+
+        // visited in increasing order of threshold, ties in list order
+        size_t expected_order[] = {4, 1, 2, 0, 3, 5};
+        CHECK_EQUAL((size_t) 6, visitor.visited.size());
+        for (size_t i=0; i<visitor.visited.size(); ++i) {
+            CHECK_EQUAL(expected_order[i], visitor.visited[i]);
+        }
+
+        CHECK(foldFingerprint(folded_tree) == foldFingerprint(unfolded_tree));
+    }
+
+
+    TEST(PersistenceHierarchy)
+    {
+        typedef denali::FoldedContourTree<denali::ContourTree> FoldedContourTree;
+
+        denali::ContourTree contour_tree = makeRandomContourTree(300, 7);
+        FoldedContourTree folded_tree(contour_tree);
+        FoldedContourTree unfolded_tree(contour_tree);
+
+        denali::PersistenceHierarchy<FoldedContourTree> hierarchy(folded_tree);
+
+        // building the hierarchy leaves the tree as it was
+        CHECK(hierarchy.numberOfOperations() > 0);
+        CHECK_EQUAL((size_t) 0, hierarchy.numberOfAppliedOperations());
+        CHECK(foldFingerprint(folded_tree) == foldFingerprint(unfolded_tree));
+
+        // the levels never decrease
+        for (size_t i=1; i<hierarchy.numberOfOperations(); ++i) {
+            CHECK(hierarchy.getLevel(i-1) <= hierarchy.getLevel(i));
+        }
+
+        // moving up and down gives the same tree as simplifying from scratch
+        double thresholds[] = {0, 5, 20, 60, 150, 1000, 40, 3, 0, 80};
+        CHECK(hierarchyMatchesSimplification(
+                hierarchy, folded_tree, contour_tree, thresholds));
+
+        CHECK(!hierarchy.setThreshold(80));
+
+        hierarchy.setThreshold(-1);
+        CHECK(foldFingerprint(folded_tree) == foldFingerprint(unfolded_tree));
+
+        // after the tree is folded elsewhere, it can be expanded and reused
+        hierarchy.setThreshold(60);
+        denali::expandTree(folded_tree);
+        CHECK(foldFingerprint(folded_tree) == foldFingerprint(unfolded_tree));
+        hierarchy.reset();
+
+        hierarchy.setThreshold(20);
+        FoldedContourTree expected(contour_tree);
+        denali::PersistenceSimplifier simplifier(20);
+        simplifier.simplify(expected);
+        CHECK(foldFingerprint(folded_tree) == foldFingerprint(expected));
+    }
 
 }
 
@@ -851,6 +1915,663 @@ SUITE(Folded)
 
     }
 
+
+    TEST(FlattenMembers)
+    {
+        typedef denali::FoldedContourTree<denali::ContourTree> FoldedContourTree;
+
+        denali::ContourTree contour_tree = makeRandomContourTree(300, 13);
+        FoldedContourTree folded_tree(contour_tree);
+        FoldedContourTree unfolded_tree(contour_tree);
+        denali::PersistenceHierarchy<FoldedContourTree> hierarchy(folded_tree);
+
+        hierarchy.setThreshold(40);
+        std::map<std::pair<denali::Identifier, denali::Identifier>,
+                 std::vector<denali::Identifier> > before = memberIDs(folded_tree);
+
+        folded_tree.flattenMembers();
+        CHECK(memberIDs(folded_tree) == before);
+
+        size_t n_flat = 0;
+        for (denali::NodeIterator<FoldedContourTree> it(folded_tree); !it.done(); ++it) {
+            if (folded_tree.getNodeMembers(it.node()).isFlat()) n_flat++;
+        }
+        CHECK(n_flat > 0);
+
+        // folding and unfolding discards the copies where needed
+        hierarchy.setThreshold(120);
+        FoldedContourTree expected(contour_tree);
+        denali::PersistenceSimplifier simplifier(120);
+        simplifier.simplify(expected);
+        CHECK(memberIDs(folded_tree) == memberIDs(expected));
+
+        folded_tree.flattenMembers();
+        hierarchy.setThreshold(-1);
+        CHECK(memberIDs(folded_tree) == memberIDs(unfolded_tree));
+    }
+
+
+    TEST(FoldingDiscardsNestedFlatMembers)
+    {
+        typedef denali::FoldedContourTree<denali::ContourTree> FoldedContourTree;
+        typedef FoldedContourTree::Node Node;
+        typedef FoldedContourTree::Edge Edge;
+        typedef FoldedContourTree::Members Members;
+
+        denali::ContourTree contour_tree = makeRandomContourTree(300, 13);
+        FoldedContourTree folded_tree(contour_tree);
+        denali::PersistenceHierarchy<FoldedContourTree> hierarchy(folded_tree);
+        hierarchy.setThreshold(40);
+        folded_tree.flattenMembers();
+
+        // find a flattened leaf whose base has degree three, so that the
+        // base can be reduced once the leaf is collapsed into it
+        Edge leaf_edge;
+        Node leaf, base;
+        bool found = false;
+        for (denali::EdgeIterator<FoldedContourTree> it(folded_tree);
+                !it.done() && !found; ++it)
+        {
+            Node u = folded_tree.u(it.edge());
+            Node v = folded_tree.v(it.edge());
+            leaf = folded_tree.degree(u) == 1 ? u : v;
+            base = folded_tree.opposite(leaf, it.edge());
+            if (folded_tree.degree(leaf) == 1 && folded_tree.degree(base) == 3 &&
+                    folded_tree.getNodeMembers(leaf).isFlat()) {
+                leaf_edge = it.edge();
+                found = true;
+            }
+        }
+        CHECK(found);
+        if (!found) return;
+
+        const Members& leaf_members = folded_tree.getNodeMembers(leaf);
+        const Members& edge_members = folded_tree.getEdgeMembers(leaf_edge);
+
+        // the collapsed members live on inside the base's, without copies
+        folded_tree.collapse(leaf_edge);
+        CHECK(!leaf_members.isFlat());
+        CHECK(!edge_members.isFlat());
+
+        // likewise for the members of a reduced node and its edges
+        denali::UndirectedNeighborIterator<FoldedContourTree> it(folded_tree, base);
+        Edge uv = it.edge(); ++it;
+        Edge vw = it.edge();
+        folded_tree.flattenMembers(base);
+        folded_tree.flattenMembers(uv);
+        folded_tree.flattenMembers(vw);
+
+        const Members& v_members = folded_tree.getNodeMembers(base);
+        const Members& uv_members = folded_tree.getEdgeMembers(uv);
+        const Members& vw_members = folded_tree.getEdgeMembers(vw);
+        CHECK(v_members.isFlat());
+
+        folded_tree.reduce(base);
+        CHECK(!v_members.isFlat());
+        CHECK(!uv_members.isFlat());
+        CHECK(!vw_members.isFlat());
+    }
+
+
+    TEST(MemberIntervals)
+    {
+        std::vector<denali::UndirectedScalarMemberIDGraph::Member> members;
+        denali::Identifier ids[] = {8, 1, 3, 2, 10, 7, 3};
+        for (size_t i=0; i<7; ++i) {
+            members.push_back(denali::UndirectedScalarMemberIDGraph::Member(ids[i], 0));
+        }
+
+        denali::MemberIntervals intervals(members);
+        CHECK_EQUAL((size_t) 6, intervals.size());
+        CHECK_EQUAL((size_t) 3, intervals.numberOfIntervals());
+        CHECK_EQUAL((denali::Identifier) 1, intervals.getFirst(0));
+        CHECK_EQUAL((denali::Identifier) 3, intervals.getLast(0));
+        CHECK_EQUAL((denali::Identifier) 7, intervals.getFirst(1));
+        CHECK_EQUAL((denali::Identifier) 8, intervals.getLast(1));
+        CHECK(intervals.contains(2));
+        CHECK(intervals.contains(10));
+        CHECK(!intervals.contains(0));
+        CHECK(!intervals.contains(5));
+        CHECK(!intervals.contains(11));
+
+        // after renumbering, the members of any subtree form one range
+        denali::ContourTree contour_tree = makeRandomContourTree(200, 17);
+        denali::ContourTree::Node root = contour_tree.getNode(0);
+        denali::MemberRenumbering<denali::ContourTree> renumbering(
+                contour_tree, root);
+        CHECK_EQUAL((size_t) 200, renumbering.size());
+
+        CHECK_EQUAL((denali::Identifier) 0, renumbering.getID(0));
+
+        // the subtree hanging from each of the root's edges
+        for (denali::UndirectedNeighborIterator<denali::ContourTree> 
+                it(contour_tree, root); !it.done(); ++it)
+        {
+            const denali::ContourTree::Members& edge_members = 
+                    contour_tree.getEdgeMembers(it.edge());
+            const denali::ContourTree::Members& pivot_members = 
+                    contour_tree.getNodeMembers(it.neighbor());
+
+            std::vector<denali::UndirectedScalarMemberIDGraph::Member> subtree(
+                    edge_members.begin(), edge_members.end());
+            subtree.insert(subtree.end(), pivot_members.begin(), pivot_members.end());
+
+            for (denali::UndirectedBFSIterator<denali::ContourTree> 
+                    bfs_it(contour_tree, root, it.neighbor()); !bfs_it.done(); ++bfs_it)
+            {
+                const denali::ContourTree::Members& node_members = 
+                        contour_tree.getNodeMembers(bfs_it.child());
+                const denali::ContourTree::Members& edge_members = 
+                        contour_tree.getEdgeMembers(bfs_it.edge());
+
+                subtree.insert(subtree.end(), node_members.begin(), node_members.end());
+                subtree.insert(subtree.end(), edge_members.begin(), edge_members.end());
+            }
+
+            CHECK_EQUAL((size_t) 1, 
+                        denali::MemberIntervals(subtree, renumbering).numberOfIntervals());
+        }
+    }
+
+
+    TEST(DegreeCounts)
+    {
+        typedef denali::FoldedContourTree<denali::ContourTree> FoldedContourTree;
+
+        denali::ContourTree contour_tree = makeRandomContourTree(300, 5);
+        FoldedContourTree folded_tree(contour_tree);
+        CHECK(degreeCountsAreExact(folded_tree));
+
+        // the hierarchy collapses, reduces, uncollapses and unreduces
+        denali::PersistenceHierarchy<FoldedContourTree> hierarchy(folded_tree);
+
+        double thresholds[] = {10, 100, 1000, 30, 0, -1};
+        for (size_t i=0; i<sizeof(thresholds)/sizeof(double); ++i)
+        {
+            hierarchy.setThreshold(thresholds[i]);
+            CHECK(degreeCountsAreExact(folded_tree));
+        }
+    }
+
+
+    TEST(BatchedExpansion)
+    {
+        typedef denali::FoldedContourTree<denali::ContourTree> FoldedContourTree;
+        typedef FoldedContourTree::Node Node;
+        typedef FoldedContourTree::Edge Edge;
+
+        denali::ContourTree contour_tree = makeRandomContourTree(400, 21);
+        FoldedContourTree folded_tree(contour_tree);
+        FoldedContourTree reference(contour_tree);
+        FoldedContourTree unfolded_tree(contour_tree);
+
+        denali::PersistenceSimplifier simplifier(80);
+        simplifier.simplify(folded_tree);
+        simplifier.simplify(reference);
+
+        // a map attached beforehand must be resized by the batch
+        denali::ObservingNodeMap<FoldedContourTree, int> node_map(folded_tree, 0);
+
+        Node root = folded_tree.getFirstNode();
+        Node child = denali::UndirectedNeighborIterator<FoldedContourTree>(
+                folded_tree, root).neighbor();
+
+        denali::FoldedElementCounter<FoldedContourTree> counter(folded_tree);
+        counter.countEdge(folded_tree.findEdge(root, child));
+        counter.countNode(root);
+        counter.countNode(child);
+        for (denali::UndirectedBFSIterator<FoldedContourTree> 
+                it(folded_tree, root, child); !it.done(); ++it) 
+        {
+            counter.countEdge(it.edge());
+            counter.countNode(it.child());
+        }
+
+        size_t n_nodes = folded_tree.numberOfNodes();
+        size_t n_edges = folded_tree.numberOfEdges();
+        CHECK(counter.numberOfNodes() > 0);
+
+        denali::expandSubtree(folded_tree, root, child);
+
+        CHECK_EQUAL(n_nodes + counter.numberOfNodes(), 
+                    (size_t) folded_tree.numberOfNodes());
+        CHECK_EQUAL(n_edges + counter.numberOfEdges(), 
+                    (size_t) folded_tree.numberOfEdges());
+
+        for (denali::NodeIterator<FoldedContourTree> it(folded_tree); 
+                !it.done(); ++it) {
+            node_map[it.node()] = 1;
+        }
+
+        // the same expansion, one unfold at a time
+        Node ref_root = reference.getNode(folded_tree.getID(root));
+        Node ref_child = reference.getNode(folded_tree.getID(child));
+
+        std::queue<Edge> expand_queue;
+        expand_queue.push(reference.findEdge(ref_root, ref_child));
+        for (denali::UndirectedBFSIterator<FoldedContourTree> 
+                it(reference, ref_root, ref_child); !it.done(); ++it) {
+            expand_queue.push(it.edge());
+        }
+        denali::expandQueuedEdges(reference, expand_queue);
+
+        CHECK(memberIDs(folded_tree) == memberIDs(reference));
+        CHECK(degreeCountsAreExact(folded_tree));
+
+        denali::expandTree(folded_tree);
+        CHECK(memberIDs(folded_tree) == memberIDs(unfolded_tree));
+        CHECK(degreeCountsAreExact(folded_tree));
+    }
+
+
+    TEST(CompactFolds)
+    {
+        typedef denali::FoldedContourTree<denali::ContourTree> FoldedContourTree;
+
+        denali::ContourTree contour_tree = makeRandomContourTree(300, 27);
+        FoldedContourTree folded_tree(contour_tree);
+        denali::PersistenceHierarchy<FoldedContourTree> hierarchy(folded_tree);
+
+        // unreductions leave holes in the edge fold storage
+        hierarchy.setThreshold(1000);
+        hierarchy.setThreshold(10);
+        CHECK(folded_tree.getMaxEdgeFoldIdentifier() > 
+              folded_tree.numberOfEdgeFolds());
+
+        std::map<std::pair<denali::Identifier, denali::Identifier>,
+                 std::vector<denali::Identifier> > before = memberIDs(folded_tree);
+
+        folded_tree.compactFolds();
+        CHECK_EQUAL(folded_tree.numberOfEdgeFolds(), 
+                    folded_tree.getMaxEdgeFoldIdentifier());
+        CHECK(memberIDs(folded_tree) == before);
+        CHECK(degreeCountsAreExact(folded_tree));
+
+        // the hierarchy holds only node folds, so it carries on
+        double thresholds[] = {200, 0, 60};
+        CHECK(hierarchyMatchesSimplification(
+                hierarchy, folded_tree, contour_tree, thresholds));
+    }
+
+
+    TEST(FoldHistory)
+    {
+        typedef denali::FoldedContourTree<denali::ContourTree> FoldedContourTree;
+        typedef FoldedContourTree::Node Node;
+        typedef denali::FoldHistory<FoldedContourTree> History;
+
+        denali::ContourTree contour_tree = makeRandomContourTree(300, 9);
+        FoldedContourTree folded_tree(contour_tree);
+        FoldedContourTree unfolded_tree(contour_tree);
+        denali::PersistenceHierarchy<FoldedContourTree> hierarchy(folded_tree);
+
+        hierarchy.setThreshold(40);
+        History history(folded_tree);
+        History::Version base = history.getVersion();
+        CHECK_EQUAL((size_t) 0, base);
+
+        std::map<std::pair<denali::Identifier, denali::Identifier>,
+                 std::vector<denali::Identifier> > at_base = memberIDs(folded_tree);
+
+        // refine a subtree
+        Node root = folded_tree.getFirstNode();
+        Node child = denali::UndirectedNeighborIterator<FoldedContourTree>(
+                folded_tree, root).neighbor();
+
+        denali::expandSubtree(folded_tree, root, child, history);
+        denali::PersistenceSimplifier simplifier(200);
+        denali::PersistenceMeasure measure;
+        simplifier.simplifySubtree(folded_tree, root, child, measure, history);
+
+        History::Version refined = history.getVersion();
+        CHECK(refined > base);
+        std::map<std::pair<denali::Identifier, denali::Identifier>,
+                 std::vector<denali::Identifier> > at_refined = memberIDs(folded_tree);
+
+        // toggling between the two versions undoes and replays the refinement
+        CHECK_EQUAL(refined, history.restore(base));
+        CHECK(memberIDs(folded_tree) == at_base);
+        CHECK(degreeCountsAreExact(folded_tree));
+
+        CHECK_EQUAL(refined, history.restore(refined));
+        CHECK(memberIDs(folded_tree) == at_refined);
+        CHECK(degreeCountsAreExact(folded_tree));
+        CHECK_EQUAL((size_t) 0, history.restore(refined));
+        CHECK_EQUAL(refined + 1, history.numberOfVersions());
+
+        // a second branch from the base
+        history.restore(base);
+        denali::expandTree(folded_tree, history);
+        History::Version expanded = history.getVersion();
+        CHECK(memberIDs(folded_tree) == memberIDs(unfolded_tree));
+
+        history.restore(refined);
+        CHECK(memberIDs(folded_tree) == at_refined);
+
+        history.restore(expanded);
+        CHECK(memberIDs(folded_tree) == memberIDs(unfolded_tree));
+        CHECK(degreeCountsAreExact(folded_tree));
+
+        // back at the base, the hierarchy carries on from where it left off
+        history.restore(base);
+        double thresholds[] = {120, 10, 40, 0};
+        CHECK(hierarchyMatchesSimplification(
+                hierarchy, folded_tree, contour_tree, thresholds));
+    }
+
+
+    // checks the weights read from the folded tree against those summed
+    // from the members of the whole landscape
+    template <typename FoldedTree>
+    bool treeWeightsAreExact(const FoldedTree& tree, denali::WeightMap* weight_map)
+    {
+        typedef denali::LandscapeTree<FoldedTree> LandscapeTree;
+        typedef denali::LandscapeWeights<LandscapeTree> LandscapeWeights;
+
+        LandscapeTree lscape(tree, tree.getFirstNode());
+        LandscapeWeights summed(lscape, weight_map);
+        LandscapeWeights read(lscape, denali::ContourTreeWeights());
+
+        for (denali::NodeIterator<LandscapeTree> it(lscape); !it.done(); ++it)
+        {
+            if (std::abs(summed.getNodeWeight(it.node()) -
+                         read.getNodeWeight(it.node())) > 1e-9 ||
+                std::abs(summed.getTotalNodeWeight(it.node()) -
+                         read.getTotalNodeWeight(it.node())) > 1e-9) {
+                return false;
+            }
+        }
+
+        for (denali::ArcIterator<LandscapeTree> it(lscape); !it.done(); ++it)
+        {
+            if (summed.getArcWeight(it.arc()) != read.getArcWeight(it.arc())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+
+    TEST(SubtreeWeights)
+    {
+        typedef denali::FoldedContourTree<denali::ContourTree> FoldedContourTree;
+
+        denali::ContourTree contour_tree = makeRandomContourTree(300, 13);
+        FoldedContourTree folded_tree(contour_tree);
+        denali::PersistenceHierarchy<FoldedContourTree> hierarchy(folded_tree);
+
+        denali::WeightMap weight_map;
+        for (size_t i=0; i<300; i += 3) {
+            weight_map[i] = 0.25 * (i % 7);
+        }
+
+        CHECK(treeWeightsAreExact(folded_tree, 0));
+
+        // unreductions free edge folds which later reductions reuse
+        double thresholds[] = {1000, 10, 120, 0, 60};
+        for (size_t i=0; i<sizeof(thresholds)/sizeof(double); ++i)
+        {
+            hierarchy.setThreshold(thresholds[i]);
+            CHECK(treeWeightsAreExact(folded_tree, 0));
+        }
+
+        // changing the map recomputes the weights of edges folded away
+        folded_tree.setWeightMap(&weight_map);
+        CHECK(treeWeightsAreExact(folded_tree, &weight_map));
+
+        for (size_t i=0; i<sizeof(thresholds)/sizeof(double); ++i)
+        {
+            hierarchy.setThreshold(thresholds[i]);
+            CHECK(treeWeightsAreExact(folded_tree, &weight_map));
+        }
+
+        folded_tree.compactFolds();
+        hierarchy.setThreshold(5);
+        CHECK(treeWeightsAreExact(folded_tree, &weight_map));
+    }
+
+
+    TEST(CachedMemberWeights)
+    {
+        typedef denali::FoldedContourTree<denali::ContourTree> FoldedContourTree;
+        typedef FoldedContourTree::Node Node;
+        typedef FoldedContourTree::Edge Edge;
+
+        denali::ContourTree contour_tree = makeRandomContourTree(200, 21);
+        FoldedContourTree folded_tree(contour_tree);
+        denali::PersistenceHierarchy<FoldedContourTree> hierarchy(folded_tree);
+
+        denali::WeightMap weight_map;
+        folded_tree.setWeightMap(&weight_map);
+        hierarchy.setThreshold(1000);
+
+        double members = 0;
+        for (denali::NodeIterator<denali::ContourTree> it(contour_tree);
+                !it.done(); ++it) {
+            members += contour_tree.getNodeMembers(it.node()).size();
+        }
+
+        for (denali::EdgeIterator<denali::ContourTree> it(contour_tree);
+                !it.done(); ++it) {
+            members += contour_tree.getEdgeMembers(it.edge()).size();
+        }
+
+        // everything is folded into the remaining edge and its nodes
+        CHECK_EQUAL((size_t) 1, folded_tree.numberOfEdges());
+        Edge edge = folded_tree.getFirstEdge();
+        Node u = folded_tree.u(edge);
+        Node v = folded_tree.v(edge);
+        CHECK_EQUAL(members, folded_tree.getNodeWeight(u) +
+                    folded_tree.getEdgeWeight(edge) + folded_tree.getNodeWeight(v));
+
+        // the cached weight is kept until the map is set again
+        double u_weight = folded_tree.getNodeWeight(u);
+        weight_map[folded_tree.getID(u)] = 11;
+        CHECK_EQUAL(u_weight, folded_tree.getNodeWeight(u));
+
+        folded_tree.setWeightMap(&weight_map);
+        CHECK_EQUAL(u_weight + 10, folded_tree.getNodeWeight(u));
+
+        // folds carry the cached weights along
+        hierarchy.setThreshold(0);
+        hierarchy.setThreshold(1000);
+        CHECK_EQUAL(u_weight + 10, folded_tree.getNodeWeight(u));
+        CHECK(treeWeightsAreExact(folded_tree, &weight_map));
+    }
+
+
+    // checks that two landscapes have the same points, up to rounding, and
+    // the same triangles, drawn for the same contour tree edges
+    template <typename Landscape>
+    bool landscapesAreEqual(const Landscape& a, const Landscape& b)
+    {
+        if (a.numberOfPoints() != b.numberOfPoints() ||
+                a.numberOfTriangles() != b.numberOfTriangles()) {
+            return false;
+        }
+
+        for (size_t i=0; i<a.numberOfPoints(); ++i)
+        {
+            typename Landscape::Point p = a.getPoint(i), q = b.getPoint(i);
+            if (std::fabs(p.x() - q.x()) > 1e-9 || std::fabs(p.y() - q.y()) > 1e-9 ||
+                    p.z() != q.z() || p.id() != q.id()) {
+                return false;
+            }
+        }
+
+        for (size_t i=0; i<a.numberOfTriangles(); ++i)
+        {
+            typename Landscape::Triangle s = a.getTriangle(i), t = b.getTriangle(i);
+            if (s.i() != t.i() || s.j() != t.j() || s.k() != t.k() ||
+                    s.id() != t.id() ||
+                    a.getContourTreeEdge(a.getComponentFromTriangle(s)) !=
+                    b.getContourTreeEdge(b.getComponentFromTriangle(t))) {
+                return false;
+            }
+        }
+
+        return a.getMinPoint().id() == b.getMinPoint().id() &&
+               a.getMaxPoint().id() == b.getMaxPoint().id();
+    }
+
+
+    TEST(ReembedSubtree)
+    {
+        typedef denali::FoldedContourTree<denali::ContourTree> FoldedContourTree;
+        typedef denali::RectangularLandscape<FoldedContourTree> Landscape;
+        typedef Landscape::Arc Arc;
+        typedef Landscape::Node Node;
+
+        denali::ContourTree contour_tree = makeRandomContourTree(2000, 29);
+        FoldedContourTree folded_tree(contour_tree);
+        denali::PersistenceHierarchy<FoldedContourTree> hierarchy(folded_tree);
+        hierarchy.setThreshold(100);
+
+        FoldedContourTree::Node root = folded_tree.getFirstNode();
+        denali::rectangular::LevelOfDetail level_of_detail(1e-3);
+
+        Landscape summed(folded_tree, root);
+        Landscape read(folded_tree, root, denali::ContourTreeWeights());
+        Landscape coarse(folded_tree, root, denali::ContourTreeWeights(),
+                         level_of_detail);
+        Landscape squarified(folded_tree, root, denali::ContourTreeWeights(),
+                             denali::rectangular::LevelOfDetail(),
+                             denali::rectangular::SQUARIFIED);
+
+        // refine the heaviest branch which is not a child of the root, so
+        // that the arcs above it are moved along too
+        Arc arc;
+        double heaviest = -1;
+        for (denali::ArcIterator<Landscape> it(read); !it.done(); ++it)
+        {
+            Node child = read.target(it.arc());
+            if (read.source(it.arc()) != read.getRoot() &&
+                    read.outDegree(child) > 0 &&
+                    read.getTotalNodeWeight(child) > heaviest) {
+                arc = it.arc();
+                heaviest = read.getTotalNodeWeight(child);
+            }
+        }
+        CHECK(heaviest > 0);
+
+        // the landscapes share a layout, so the arc is the same in each
+        CHECK(summed.getContourTreeEdge(arc) == read.getContourTreeEdge(arc));
+
+        // expanding the subtree grows it past the nodes and arcs it had
+        double thresholds[] = {0, 30, 5, 1000, 1e9};
+        for (size_t i=0; i<sizeof(thresholds)/sizeof(double); ++i)
+        {
+            FoldedContourTree::Node parent =
+                    read.getContourTreeNode(read.source(arc));
+            FoldedContourTree::Node child =
+                    read.getContourTreeNode(read.target(arc));
+
+            denali::expandSubtree(folded_tree, parent, child);
+            denali::PersistenceSimplifier(thresholds[i]).simplifySubtree(
+                    folded_tree, parent, child);
+
+            bool reembedded = read.reembedSubtree(arc);
+            CHECK(reembedded);
+            CHECK(summed.reembedSubtree(arc));
+            CHECK(coarse.reembedSubtree(arc));
+            CHECK(squarified.reembedSubtree(arc));
+
+            CHECK_EQUAL(folded_tree.numberOfNodes(), read.numberOfNodes());
+
+            Landscape fresh_summed(folded_tree, root);
+            Landscape fresh_read(folded_tree, root, denali::ContourTreeWeights());
+            Landscape fresh_coarse(folded_tree, root, denali::ContourTreeWeights(),
+                                   level_of_detail);
+            Landscape fresh_squarified(folded_tree, root,
+                                       denali::ContourTreeWeights(),
+                                       denali::rectangular::LevelOfDetail(),
+                                       denali::rectangular::SQUARIFIED);
+
+            CHECK(landscapesAreEqual(summed, fresh_summed));
+            CHECK(landscapesAreEqual(read, fresh_read));
+            CHECK(landscapesAreEqual(coarse, fresh_coarse));
+            CHECK(landscapesAreEqual(squarified, fresh_squarified));
+        }
+
+        // once the subtree is folded into its parent, the landscape must be
+        // built again
+        CHECK_EQUAL((denali::Identifier) 0, read.outDegree(read.target(arc)));
+        folded_tree.collapse(read.getContourTreeEdge(arc));
+
+        size_t n_points = read.numberOfPoints();
+        CHECK(!read.reembedSubtree(arc));
+        CHECK_EQUAL(n_points, read.numberOfPoints());
+    }
+
+
+    TEST(ChangeRoot)
+    {
+        typedef denali::FoldedContourTree<denali::ContourTree> FoldedContourTree;
+        typedef denali::RectangularLandscape<FoldedContourTree> Landscape;
+
+        denali::ContourTree contour_tree = makeRandomContourTree(2000, 31);
+        FoldedContourTree folded_tree(contour_tree);
+        denali::PersistenceHierarchy<FoldedContourTree> hierarchy(folded_tree);
+        hierarchy.setThreshold(30);
+
+        FoldedContourTree::Node root = folded_tree.getFirstNode();
+        denali::rectangular::LevelOfDetail level_of_detail(1e-3);
+
+        Landscape summed(folded_tree, root);
+        Landscape read(folded_tree, root, denali::ContourTreeWeights());
+        Landscape coarse(folded_tree, root, denali::ContourTreeWeights(),
+                         level_of_detail);
+        Landscape squarified(folded_tree, root, denali::ContourTreeWeights(),
+                             denali::rectangular::LevelOfDetail(),
+                             denali::rectangular::SQUARIFIED);
+
+        // re-rooted landscapes are those built at the new root, and the
+        // old root may be returned to
+        FoldedContourTree::Node roots[] = {
+            denali::findMinLeaf(folded_tree),
+            denali::findMaxNode(folded_tree),
+            denali::findMaxLeaf(folded_tree),
+            root
+        };
+
+        for (size_t i=0; i<sizeof(roots)/sizeof(roots[0]); ++i)
+        {
+            size_t n_nodes = read.getMaxNodeIdentifier();
+
+            CHECK(summed.changeRoot(roots[i]));
+            CHECK(read.changeRoot(roots[i]));
+            CHECK(coarse.changeRoot(roots[i]));
+            CHECK(squarified.changeRoot(roots[i]));
+
+            CHECK(read.getContourTreeNode(read.getRoot()) == roots[i]);
+            CHECK_EQUAL(n_nodes, read.getMaxNodeIdentifier());
+
+            Landscape fresh_summed(folded_tree, roots[i]);
+            Landscape fresh_read(folded_tree, roots[i],
+                                 denali::ContourTreeWeights());
+            Landscape fresh_coarse(folded_tree, roots[i],
+                                   denali::ContourTreeWeights(),
+                                   level_of_detail);
+            Landscape fresh_squarified(folded_tree, roots[i],
+                                       denali::ContourTreeWeights(),
+                                       denali::rectangular::LevelOfDetail(),
+                                       denali::rectangular::SQUARIFIED);
+
+            CHECK(landscapesAreEqual(summed, fresh_summed));
+            CHECK(landscapesAreEqual(read, fresh_read));
+            CHECK(landscapesAreEqual(coarse, fresh_coarse));
+            CHECK(landscapesAreEqual(squarified, fresh_squarified));
+        }
+
+        // once the contour tree is folded, the landscape must be built again
+        hierarchy.setThreshold(100);
+
+        size_t n_points = read.numberOfPoints();
+        CHECK(!read.changeRoot(folded_tree.getFirstNode()));
+        CHECK_EQUAL(n_points, read.numberOfPoints());
+        CHECK(read.getContourTreeNode(read.getRoot()) == root);
+    }
+
 }
 
 